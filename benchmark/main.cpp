@@ -0,0 +1,527 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Microbenchmarks of the core graph shapes
+/* Every benchmark builds a graph, makes its output persistent and ticks its clock(s) a fixed number
+   of frames. The median of a few runs is reported as CSV, one line per benchmark:
+   
+   benchmark,mode,nodes,bytes_per_node,frames,seconds,frames_per_second,ns_per_node_frame
+   
+   The node count includes every signal in the graph (see GraphFootprint), so ns_per_node_frame is the
+   average cost of updating one signal for one frame. Chains of values pull their end directly instead
+   of updating every value, so value_chain only counts the nodes that are actually updated.
+   
+   Pass a substring as argument to only run the benchmarks whose name contains it. The parallel benchmarks
+   run with 1, 2, 4, ... threads up to the number of cores, unless the thread counts are given as a
+   comma-separated list (e.g. --threads=8,16,32). */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../octopus.hpp"
+
+using namespace octo;
+
+namespace
+{
+    //! The sine oscillator of the README
+    class Sine : public Signal<float>
+    {
+    public:
+        Sine(Clock* clock, float frequency = 0.0f) :
+            Signal<float>(clock),
+            frequency(frequency)
+        {
+        
+        }
+        
+        Value<float> frequency;
+        
+        GENERATE_MOVE(Sine)
+    
+    private:
+        void generateSample(float& out) final override
+        {
+            out = std::sin(phase * 6.28318530717959);
+            
+            phase += this->getClock()->delta() * frequency();
+            while (phase >= 1.0)
+                phase -= 1.0;
+        }
+        
+        double phase = 0;
+    };
+    
+    //! A sawtooth that costs next to nothing, so the engine dominates the measurement
+    class Ramp : public Signal<float>
+    {
+    public:
+        Ramp(Clock* clock, float increment) :
+            Signal<float>(clock),
+            increment(increment)
+        {
+        
+        }
+        
+        GENERATE_MOVE(Ramp)
+    
+    private:
+        void generateSample(float& out) final override
+        {
+            out = phase;
+            phase += increment;
+            if (phase >= 1.0f)
+                phase -= 2.0f;
+        }
+        
+        void generateBlock(float* out, std::size_t size) final override
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                generateSample(out[i]);
+        }
+        
+        float increment = 0;
+        float phase = 0;
+    };
+    
+    //! A costly pure function, like computing filter coefficients from a parameter
+    struct Coefficient
+    {
+        float operator()(float x) const { return std::tanh(std::exp(x * 0.01f)); }
+    };
+    
+    //! A control signal that only changes every so many frames
+    class Steps : public Signal<float>
+    {
+    public:
+        Steps(Clock* clock, unsigned int period) :
+            Signal<float>(clock),
+            period(period)
+        {
+        
+        }
+        
+        GENERATE_MOVE(Steps)
+    
+    private:
+        void generateSample(float& out) final override
+        {
+            out = static_cast<float>((frame++ / period) % 7);
+        }
+        
+        unsigned int period = 1;
+        uint64_t frame = 0;
+    };
+    
+    //! The number of frames every run of a benchmark should roughly update the nodes of its graph for
+    constexpr uint64_t nodeFramesPerRun = 4'000'000;
+    
+    //! The size of the blocks ticked by benchmarks in block mode
+    constexpr std::size_t blockSize = 64;
+    
+    //! The substring benchmark names should contain to be run
+    const char* filter = "";
+    
+    //! The numbers of threads to run the parallel benchmarks with
+    std::vector<std::size_t> threadCounts;
+    
+    //! Return the number of frames to tick a graph per run, rounded to whole blocks
+    uint64_t getFrameCount(std::size_t nodes)
+    {
+        const auto frames = std::max<uint64_t>(nodeFramesPerRun / std::max<std::size_t>(nodes, 1), 4 * blockSize);
+        return frames / blockSize * blockSize;
+    }
+    
+    //! Time a function, returning the median duration of a few runs (in seconds)
+    template <class Function>
+    double time(Function&& function)
+    {
+        // Warm up, so lazily allocated blocks and plans aren't measured
+        function();
+        
+        std::array<double, 5> durations;
+        for (auto& duration : durations)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        
+        std::nth_element(durations.begin(), durations.begin() + durations.size() / 2, durations.end());
+        return durations[durations.size() / 2];
+    }
+    
+    //! Print the result of a benchmark as a line of CSV
+    /*! @param updated The number of nodes updated per frame, or 0 if every signal in the graph is */
+    void report(const std::string& name, const char* mode, const GraphFootprint& footprint, uint64_t frames, double seconds, std::size_t updated = 0)
+    {
+        const auto nodes = std::max<std::size_t>(updated ? updated : footprint.signalCount, 1);
+        std::printf("%s,%s,%zu,%.0f,%llu,%.6f,%.0f,%.3f\n", name.c_str(), mode, footprint.signalCount, footprint.getBytesPerSignal(),
+                    static_cast<unsigned long long>(frames), seconds, frames / seconds, seconds * 1e9 / (static_cast<double>(frames) * nodes));
+        std::fflush(stdout);
+    }
+    
+    //! Should a benchmark be run?
+    bool isSelected(const std::string& name)
+    {
+        return name.find(filter) != std::string::npos;
+    }
+    
+    //! Tick a clock whose graph has been built, once per frame and in blocks
+    /*! @param updated The number of nodes updated per frame, or 0 if every signal in the graph is */
+    void benchmarkClock(const std::string& name, Clock& clock, std::size_t updated = 0)
+    {
+        if (!isSelected(name))
+            return;
+        
+        const auto footprint = GraphFootprint::measure(clock);
+        const auto frames = getFrameCount(updated ? updated : footprint.signalCount);
+        
+        report(name, "sample", footprint, frames, time([&]
+        {
+            for (uint64_t i = 0; i < frames; ++i)
+                clock.tick();
+        }), updated);
+        
+        report(name, "block", footprint, frames, time([&]
+        {
+            for (uint64_t i = 0; i < frames; i += blockSize)
+                clock.tick(blockSize);
+        }), updated);
+    }
+    
+    //! A chain of Values, each referring to the one before it
+    void benchmarkValueChain(std::size_t depth)
+    {
+        InvariableClock clock(44100);
+        Ramp ramp(&clock, 0.001f);
+        
+        std::vector<std::unique_ptr<Value<float>>> chain;
+        chain.emplace_back(std::make_unique<Value<float>>(ramp));
+        for (std::size_t i = 1; i < depth; ++i)
+            chain.emplace_back(std::make_unique<Value<float>>(*chain.back()));
+        
+        // The last value pulls the ramp directly, so only those two are updated
+        chain.back()->setPersistency(true);
+        benchmarkClock("value_chain/" + std::to_string(depth), clock, 2);
+    }
+    
+    //! A single fold with many inputs
+    template <class FoldType>
+    void benchmarkFold(const std::string& name, std::size_t width)
+    {
+        InvariableClock clock(44100);
+        std::vector<std::unique_ptr<Ramp>> ramps;
+        FoldType fold(&clock);
+        for (std::size_t i = 0; i < width; ++i)
+        {
+            ramps.emplace_back(std::make_unique<Ramp>(&clock, 0.001f * (i + 1)));
+            fold.emplace(*ramps.back());
+        }
+        
+        fold.setPersistency(true);
+        benchmarkClock(name + "/" + std::to_string(width), clock);
+    }
+    
+    //! Many signals joined into one multi-channel signal, split and summed again
+    void benchmarkJoinSplit(std::size_t channels)
+    {
+        InvariableClock clock(44100);
+        std::vector<std::unique_ptr<Ramp>> ramps;
+        Join<float> join(&clock);
+        for (std::size_t i = 0; i < channels; ++i)
+        {
+            ramps.emplace_back(std::make_unique<Ramp>(&clock, 0.001f * (i + 1)));
+            join.emplace(*ramps.back());
+        }
+        
+        Split<float> split(&clock, join, channels);
+        Sum<float> sum(&clock);
+        for (std::size_t i = 0; i < channels; ++i)
+            sum.emplace(split[i]);
+        
+        sum.setPersistency(true);
+        benchmarkClock("join_split/" + std::to_string(channels), clock);
+    }
+    
+    //! Voices of the README graph: a sine with its frequency modulated by another sine
+    void benchmarkFrequencyModulation(std::size_t voices)
+    {
+        InvariableClock clock(44100);
+        std::vector<std::unique_ptr<Sine>> oscillators;
+        Sum<float> mix(&clock);
+        for (std::size_t i = 0; i < voices; ++i)
+        {
+            oscillators.emplace_back(std::make_unique<Sine>(&clock));
+            oscillators.back()->frequency = 440.0f * (i + 1) + 100.0f * Sine(&clock, 0.5f);
+            mix.emplace(*oscillators.back());
+        }
+        
+        mix.setPersistency(true);
+        benchmarkClock("sine_fm/" + std::to_string(voices), clock);
+    }
+    
+    //! Oscillators at an audio clock, modulated by oscillators at a control clock 100 times slower
+    void benchmarkMultipleClocks(std::size_t voices)
+    {
+        const std::string name = "multi_clock/" + std::to_string(voices);
+        if (!isSelected(name))
+            return;
+        
+        InvariableClock audio(44100);
+        InvariableClock control(441);
+        std::vector<std::unique_ptr<Sine>> oscillators;
+        std::vector<std::unique_ptr<LatestBridge<float>>> bridges;
+        Sum<float> mix(&audio);
+        for (std::size_t i = 0; i < voices; ++i)
+        {
+            bridges.emplace_back(std::make_unique<LatestBridge<float>>(&control, &audio));
+            bridges.back()->input = 440.0f * (i + 1) + 100.0f * Sine(&control, 0.5f);
+            
+            oscillators.emplace_back(std::make_unique<Sine>(&audio));
+            oscillators.back()->frequency = *bridges.back();
+            mix.emplace(*oscillators.back());
+        }
+        
+        mix.setPersistency(true);
+        
+        auto footprint = GraphFootprint::measure(audio);
+        const auto controlFootprint = GraphFootprint::measure(control);
+        footprint.signalCount += controlFootprint.signalCount;
+        footprint.byteCount += controlFootprint.byteCount;
+        
+        const auto frames = getFrameCount(footprint.signalCount) / 100 * 100;
+        report(name, "sample", footprint, frames, time([&]
+        {
+            for (uint64_t i = 0; i < frames; ++i)
+            {
+                if (i % 100 == 0)
+                    control.tick();
+                
+                audio.tick();
+            }
+        }));
+    }
+    
+    //! The voices of a synthesizer, ticked in parallel by a number of threads
+    void benchmarkParallel(std::size_t voices, std::size_t threads)
+    {
+        const std::string name = "parallel/" + std::to_string(voices) + "/" + std::to_string(threads);
+        if (!isSelected(name))
+            return;
+        
+        ParallelExecutor executor(threads);
+        InvariableClock clock(44100);
+        std::vector<std::unique_ptr<Sine>> oscillators;
+        Sum<float> mix(&clock);
+        for (std::size_t i = 0; i < voices; ++i)
+        {
+            oscillators.emplace_back(std::make_unique<Sine>(&clock));
+            oscillators.back()->frequency = 100.0f * (i + 1) + 10.0f * Sine(&clock, 3.0f);
+            mix.emplace(*oscillators.back() * 0.5f);
+        }
+        
+        mix.setPersistency(true);
+        clock.setExecutor(&executor);
+        
+        // Ticking blocks has every task render its voices a block at a time, on the worker that runs it
+        benchmarkClock(name, clock);
+        clock.setExecutor(nullptr);
+    }
+    
+    //! A graph of which 90% holds still, with and without incremental mode
+    void benchmarkStaticGraph(std::size_t nodes, bool incremental)
+    {
+        const std::string name = std::string("static_graph/") + std::to_string(nodes) + (incremental ? "/incremental" : "/full");
+        if (!isSelected(name))
+            return;
+        
+        InvariableClock clock(44100);
+        clock.setIncremental(incremental);
+        
+        // The static part: a chain of costly pure functions driven by a parameter that rarely changes
+        Steps parameter(&clock, 4096);
+        std::vector<std::unique_ptr<Signal<float>>> chain;
+        Signal<float>* previous = &parameter;
+        for (std::size_t i = 0; i < nodes * 9 / 10; ++i)
+        {
+            auto coefficient = std::make_unique<Map<Coefficient, float>>(&clock, *previous, Coefficient());
+            coefficient->pure = true;
+            previous = coefficient.get();
+            chain.emplace_back(std::move(coefficient));
+        }
+        
+        // The varying part: oscillators scaled by the end of the chain
+        std::vector<std::unique_ptr<Ramp>> ramps;
+        Sum<float> mix(&clock);
+        for (std::size_t i = 0; i < nodes / 10; ++i)
+        {
+            ramps.emplace_back(std::make_unique<Ramp>(&clock, 0.001f * (i + 1)));
+            mix.emplace(*ramps.back() * *previous);
+        }
+        
+        mix.setPersistency(true);
+        
+        const auto footprint = GraphFootprint::measure(clock);
+        const auto frames = getFrameCount(footprint.signalCount);
+        report(name, "sample", footprint, frames, time([&]
+        {
+            for (uint64_t i = 0; i < frames; ++i)
+                clock.tick();
+        }));
+    }
+    
+    //! Building and tearing down a graph of sums and products
+    void benchmarkConstruction(std::size_t voices)
+    {
+        const std::string name = "construction/" + std::to_string(voices);
+        if (!isSelected(name))
+            return;
+        
+        InvariableClock clock(44100);
+        auto build = [&](GraphFootprint* footprint)
+        {
+            std::vector<std::unique_ptr<Ramp>> ramps;
+            Sum<float> mix(&clock);
+            for (std::size_t i = 0; i < voices; ++i)
+            {
+                ramps.emplace_back(std::make_unique<Ramp>(&clock, 0.001f * (i + 1)));
+                mix.emplace(*ramps.back() * 0.5f + 0.25f);
+            }
+            
+            mix.setPersistency(true);
+            if (footprint)
+                *footprint = GraphFootprint::measure(clock);
+        };
+        
+        GraphFootprint footprint;
+        build(&footprint);
+        
+        // Report graphs per second as frames, so ns_per_node_frame is the cost of a single node
+        const uint64_t graphs = std::max<uint64_t>(nodeFramesPerRun / 100 / voices, 1);
+        report(name, "build", footprint, graphs, time([&]
+        {
+            for (uint64_t i = 0; i < graphs; ++i)
+                build(nullptr);
+        }));
+    }
+    
+    //! Parse a comma-separated list of thread counts, returning an empty list if it's malformed
+    std::vector<std::size_t> parseThreadCounts(const char* list)
+    {
+        std::vector<std::size_t> counts;
+        while (true)
+        {
+            char* end = nullptr;
+            const auto count = std::strtoul(list, &end, 10);
+            if (end == list || count == 0)
+                return {};
+            
+            counts.emplace_back(count);
+            if (*end == '\0')
+                return counts;
+            
+            if (*end != ',')
+                return {};
+            
+            list = end + 1;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--threads=", 10) == 0)
+        {
+            threadCounts = parseThreadCounts(argv[i] + 10);
+            if (threadCounts.empty())
+            {
+                std::fprintf(stderr, "usage: %s [filter] [--threads=1,2,4,...]\n", argv[0]);
+                return 1;
+            }
+        } else {
+            filter = argv[i];
+        }
+    }
+    
+    // Scale up to the number of cores by default
+    if (threadCounts.empty())
+    {
+        const std::size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+        for (std::size_t threads = 1; threads < cores; threads *= 2)
+            threadCounts.emplace_back(threads);
+        
+        threadCounts.emplace_back(cores);
+    }
+
+#ifndef __OPTIMIZE__
+    std::fprintf(stderr, "warning: benchmarking an unoptimized build, configure with -DCMAKE_BUILD_TYPE=Release\n");
+#endif
+    
+    std::printf("benchmark,mode,nodes,bytes_per_node,frames,seconds,frames_per_second,ns_per_node_frame\n");
+    
+    for (auto depth : {16, 256, 4096})
+        benchmarkValueChain(depth);
+    
+    for (auto width : {16, 256, 4096})
+    {
+        benchmarkFold<Sum<float>>("sum", width);
+        benchmarkFold<Product<float>>("product", width);
+    }
+    
+    for (auto channels : {16, 256})
+        benchmarkJoinSplit(channels);
+    
+    for (auto voices : {1, 16})
+        benchmarkFrequencyModulation(voices);
+    
+    benchmarkMultipleClocks(16);
+    
+    for (auto threads : threadCounts)
+        benchmarkParallel(256, threads);
+    
+    for (auto incremental : {false, true})
+        benchmarkStaticGraph(1000, incremental);
+    
+    for (auto voices : {16, 256})
+        benchmarkConstruction(voices);
+    
+    return 0;
+}
@@ -29,7 +29,10 @@
 #ifndef OCTOPUS_BINARY_OPERATION_HPP
 #define OCTOPUS_BINARY_OPERATION_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <stdexcept>
+#include <vector>
 
 #include "signal.hpp"
 #include "value.hpp"
@@ -57,6 +60,9 @@ namespace octo
             
         }
         
+        // Inherited from SignalBase
+        std::vector<SignalBase*> getDependencies() final override { return {&left, &right}; }
+    
     public:
         //! The left-hand side of the operation
         Value<T> left;
@@ -71,8 +77,55 @@ namespace octo
             combineSamples(left(), right(), out);
         }
         
+        //! Generate a new block of samples
+        void generateBlock(T* out, std::size_t size) final override
+        {
+            if (size == 0)
+                return;
+            
+            // Constants are combined as a whole, instead of being broadcast into blocks first
+            const auto leftConstant = left.pullConstant();
+            const auto rightConstant = right.pullConstant();
+            
+            if (leftConstant && rightConstant)
+            {
+                combineSamples(*leftConstant, *rightConstant, out[0]);
+                std::fill_n(out + 1, size - 1, out[0]);
+            } else if (rightConstant) {
+                combineBlockAndScalar(left.pullBlock(size), *rightConstant, out, size);
+            } else if (leftConstant) {
+                combineScalarAndBlock(*leftConstant, right.pullBlock(size), out, size);
+            } else {
+                combineBlocks(left.pullBlock(size), right.pullBlock(size), out, size);
+            }
+        }
+        
         //! Combine two samples into a new one
         virtual void combineSamples(const T& left, const T& right, T& out) = 0;
+        
+        //! Combine two blocks of samples into a new one
+        /*! The default implementation calls combineSamples() for each frame. Override it for a faster path. */
+        virtual void combineBlocks(const T* left, const T* right, T* out, std::size_t size)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                combineSamples(left[i], right[i], out[i]);
+        }
+        
+        //! Combine a block of samples with a constant
+        /*! The default implementation calls combineSamples() for each frame. Override it for a faster path. */
+        virtual void combineBlockAndScalar(const T* left, const T& right, T* out, std::size_t size)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                combineSamples(left[i], right, out[i]);
+        }
+        
+        //! Combine a constant with a block of samples
+        /*! The default implementation calls combineSamples() for each frame. Override it for a faster path. */
+        virtual void combineScalarAndBlock(const T& left, const T* right, T* out, std::size_t size)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                combineSamples(left, right[i], out[i]);
+        }
     };
 }
 
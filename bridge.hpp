@@ -0,0 +1,158 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_BRIDGE_HPP
+#define OCTOPUS_BRIDGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
+
+#include "signal.hpp"
+#include "spsc_ring.hpp"
+#include "value.hpp"
+
+namespace octo
+{
+    //! Base class for signals that carry samples from one clock domain to another
+    /*! A bridge pulls its input with every tick of the producer clock, and pushes the sample into a
+        wait-free ring buffer (see SpscRing). The bridge itself runs at the consumer clock, and pops the
+        samples from the ring when it updates. This lets both clocks tick on their own threads (see
+        ClockThread) without ever waiting on each other: a 60 Hz video clock can't stall a 48 kHz
+        audio callback.
+        
+        Derived classes decide what gets stored in the ring (see makeEntry()) and how the consumer side
+        turns entries into samples (see LatestBridge, FifoBridge and InterpolatingBridge).
+        
+        The producer side of the bridge is a persistent sink of the producer clock, so bridges should be
+        created, moved and destroyed while the producer clock isn't ticking. */
+    template <class T, class Entry = T>
+    class Bridge : public Signal<T>
+    {
+    public:
+        //! Construct the bridge
+        /*! @param producer The clock at which the input is pulled
+            @param consumer The clock at which the bridge runs
+            @param capacity The number of samples the ring buffer can hold */
+        Bridge(Clock* producer, Clock* consumer, std::size_t capacity, const T& initialCache = T{}) :
+            Signal<T>(consumer, initialCache)
+        {
+            if (!producer)
+                throw std::invalid_argument("bridges need a producer clock");
+            
+            writer = std::make_unique<Writer>(*this, producer, capacity);
+        }
+        
+        //! Move a bridge
+        Bridge(Bridge&& rhs) :
+            Signal<T>(std::move(rhs)),
+            input(std::move(rhs.input)),
+            writer(std::move(rhs.writer))
+        {
+            writer->bridge = this;
+        }
+        
+        //! Return the clock at which the input is pulled
+        Clock* getProducer() const { return writer->getClock(); }
+        
+        //! Return the number of samples dropped because the ring buffer was full
+        std::size_t getDropCount() const { return writer->drops.load(std::memory_order_relaxed); }
+    
+    public:
+        //! The input, pulled at the producer clock
+        Value<T> input;
+    
+    protected:
+        //! Return the ring buffer (only pop from it in generateSample())
+        SpscRing<Entry>& getRing() { return writer->ring; }
+    
+    private:
+        class Writer;
+    
+    private:
+        //! Turn a sample pulled from the input into an entry of the ring (called at the producer clock)
+        virtual Entry makeEntry(const T& sample) = 0;
+    
+    private:
+        //! The producer side of the bridge
+        std::unique_ptr<Writer> writer;
+    };
+    
+    //! The producer side of a bridge, pulling the input and pushing it into the ring buffer
+    template <class T, class Entry>
+    class Bridge<T, Entry>::Writer : public SignalBase
+    {
+    public:
+        Writer(Bridge& bridge, Clock* producer, std::size_t capacity) :
+            SignalBase(producer),
+            bridge(&bridge),
+            ring(capacity)
+        {
+            this->setPersistency(true);
+        }
+        
+        // Inherited from SignalBase
+        const std::type_info& getTypeInfo() const final override { return typeid(T); }
+        const void* pullGeneric() final override { return &bridge->input(); }
+        std::vector<SignalBase*> getDependencies() final override { return {&bridge->input}; }
+    
+    public:
+        //! The bridge this is the producer side of
+        Bridge* bridge = nullptr;
+        
+        //! The ring buffer through which entries are passed to the consumer
+        SpscRing<Entry> ring;
+        
+        //! The number of samples dropped because the ring was full
+        std::atomic<std::size_t> drops{0};
+    
+        //! Push a block of samples of the input
+        void updateBlock(std::size_t size) final override
+        {
+            const auto samples = bridge->input.pullBlock(size);
+            for (std::size_t i = 0; i < size; ++i)
+                push(samples[i]);
+        }
+    
+    private:
+        //! Push the next sample of the input
+        void onUpdate() final override { push(bridge->input()); }
+        
+        //! Push a sample into the ring
+        void push(const T& sample)
+        {
+            if (!ring.push(bridge->makeEntry(sample)))
+                drops.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,454 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <algorithm>
+#include <mutex>
+
+#include "clock.hpp"
+#include "execution_plan.hpp"
+#include "graph_optimizer.hpp"
+#include "parallel_executor.hpp"
+#include "realtime_checker.hpp"
+#include "signal_base.hpp"
+#include "tracer.hpp"
+
+namespace octo
+{
+    struct Clock::TickMonitor
+    {
+        //! The durations of the ticks
+        LatencyHistogram latency;
+        
+        //! The number of ticks that took longer than the deadline
+        std::atomic<uint64_t> deadlineMisses{0};
+    };
+    
+    //! The clocks that exist, so sinks can tell whether the clocks that planned them still do
+    struct Clocks
+    {
+        //! Guards the list, and serializes the rebuilding of plans
+        /*! Recursive, because deleting a plan may destroy signals it kept alive, reassigning values
+            that rebuild plans in turn. */
+        std::recursive_mutex mutex;
+        
+        //! The clocks
+        std::vector<Clock*> clocks;
+    };
+    
+    //! Return the clocks that exist (constructed on first use, so global clocks can register)
+    static Clocks& getClocks()
+    {
+        static Clocks clocks;
+        return clocks;
+    }
+    
+    //! Marks sinks included by the plans of several clocks (see Sink::plannedBy)
+    static const char sharedPlan = 0;
+    
+    //! The number of scopes deferring the deletion of retired plans on this thread (see Clock::DeferralScope)
+    static thread_local std::size_t deferrals = 0;
+    
+    //! The innermost render offset scope of this thread, if any (see Clock::RenderOffsetScope)
+    static thread_local Clock::RenderOffsetScope* renderOffsetScope = nullptr;
+    
+    Clock::Clock()
+    {
+        auto& clocks = getClocks();
+        std::lock_guard<std::recursive_mutex> lock(clocks.mutex);
+        clocks.clocks.emplace_back(this);
+    }
+    
+    Clock::~Clock()
+    {
+        {
+            auto& clocks = getClocks();
+            std::lock_guard<std::recursive_mutex> lock(clocks.mutex);
+            clocks.clocks.erase(std::find(clocks.clocks.begin(), clocks.clocks.end(), this));
+        }
+        
+        plan = nullptr;
+        delete pendingPlan.exchange(nullptr, std::memory_order_acquire);
+        reclaimPlans();
+        
+        delete monitor.load(std::memory_order_relaxed);
+    }
+    
+    uint64_t Clock::tick()
+    {
+        const auto measured = isMonitored();
+        const auto start = measured ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    #ifdef OCTOPUS_TRACING
+        Tracer::Scope trace("tick", this);
+    #endif
+    #ifdef OCTOPUS_REALTIME_CHECKS
+        RealTimeChecker::TickScope check;
+    #endif
+        
+        onTick();
+        prepare();
+        
+        if (isCompiled())
+        {
+            if (executor)
+                executor->run(*plan);
+            else
+                plan->run();
+        } else {
+            for (auto& sink : persistentSinks)
+                sink->update();
+        }
+        
+        if (measured)
+            recordTick(start, 1);
+        
+        return now();
+    }
+    
+    uint64_t Clock::tick(std::size_t count)
+    {
+        if (count == 0)
+            return now();
+        
+        const auto measured = isMonitored();
+        const auto start = measured ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    #ifdef OCTOPUS_TRACING
+        Tracer::Scope trace("tick block", this);
+    #endif
+    #ifdef OCTOPUS_REALTIME_CHECKS
+        RealTimeChecker::TickScope check;
+    #endif
+        
+        prepare();
+        
+        // Render the frames of the coming ticks, a block at a time
+        const auto offset = getRenderOffset();
+        setRenderOffset(offset + 1);
+        
+        try
+        {
+            if (isCompiled())
+            {
+                if (executor)
+                    executor->runBlock(*plan, count);
+                else
+                    plan->runBlock(count);
+            } else {
+                // Signals render their blocks first, so that sinks updated frame by frame read from them,
+                // instead of having the signals render frames they have already rendered
+                for (auto& sink : persistentSignals)
+                    sink->updateBlock(count);
+                
+                for (auto& sink : otherPersistentSinks)
+                    sink->updateBlock(count);
+            }
+        } catch (...) {
+            // Sinks walking through their blocks leave the offset wherever they threw
+            setRenderOffset(offset);
+            throw;
+        }
+        
+        setRenderOffset(offset);
+        
+        // Move past the rendered frames
+        onTick(count);
+        
+        if (measured)
+            recordTick(start, count);
+        
+        return now();
+    }
+    
+    void Clock::addPersistentSink(Sink& sink)
+    {
+        if (isSinkPersistent(sink))
+            return;
+        
+        sink.persistent.store(true, std::memory_order_relaxed);
+        persistentSinks.emplace_back(&sink);
+        (dynamic_cast<SignalBase*>(&sink) ? persistentSignals : otherPersistentSinks).emplace_back(&sink);
+        graphChanged();
+    }
+    
+    void Clock::removePersistentSink(Sink& sink)
+    {
+        if (!isSinkPersistent(sink))
+            return;
+        
+        auto it = std::find(persistentSinks.begin(), persistentSinks.end(), &sink);
+        if (it == persistentSinks.end())
+            return;
+        
+        sink.persistent.store(false, std::memory_order_relaxed);
+        persistentSinks.erase(it);
+        for (auto sinks : {&persistentSignals, &otherPersistentSinks})
+            sinks->erase(std::remove(sinks->begin(), sinks->end(), &sink), sinks->end());
+        
+        graphChanged();
+    }
+    
+    bool Clock::isSinkPersistent(const Sink& sink) const
+    {
+        return sink.persistent.load(std::memory_order_relaxed) && sink.getClock() == this;
+    }
+    
+    void Clock::prepare()
+    {
+        // Adopting a plan is a single atomic load, unless one was rebuilt since the last tick
+        if (!pendingPlan.load(std::memory_order_relaxed))
+            return;
+        
+        auto next = pendingPlan.exchange(nullptr, std::memory_order_acquire);
+        if (!next)
+            return;
+        
+        // Optimizing the graph isn't steady-state rendering, and may allocate
+    #ifdef OCTOPUS_REALTIME_CHECKS
+        RealTimeChecker::Exemption exemption;
+    #endif
+        
+        retire(plan.release());
+        plan.reset(next);
+        
+        // The optimizer pulls the signals it folds, so it runs here rather than where the plan was built
+        if (isOptimized())
+            GraphOptimizer::optimize(*plan);
+    }
+    
+    void Clock::graphChanged()
+    {
+        std::lock_guard<std::recursive_mutex> lock(getClocks().mutex);
+        graphEpoch.fetch_add(1, std::memory_order_acq_rel);
+        rebuild();
+    }
+    
+    void Clock::rebuild()
+    {
+        if (deferrals == 0)
+            reclaimPlans();
+        if (!isCompiled() && !isOptimized())
+            return;
+        
+        // A plan that wasn't adopted yet has never been run, so it can be deleted right away
+        delete pendingPlan.exchange(build().release(), std::memory_order_acq_rel);
+    }
+    
+    std::unique_ptr<ExecutionPlan> Clock::build()
+    {
+        auto plan = std::make_unique<ExecutionPlan>(GraphCompiler::compile(*this));
+        
+        // Let the sinks know they're in the plan, so changing them rebuilds it (see Sink::graphChanged())
+        auto& clocks = getClocks().clocks;
+        auto mark = [&](Sink& sink)
+        {
+            const void* plannedBy = nullptr;
+            if (sink.plannedBy.compare_exchange_strong(plannedBy, this, std::memory_order_acq_rel) || plannedBy == this || plannedBy == &sharedPlan)
+                return;
+            
+            // Sinks planned by clocks that have been destroyed are taken over
+            const bool shared = std::find(clocks.begin(), clocks.end(), plannedBy) != clocks.end();
+            sink.plannedBy.store(shared ? static_cast<const void*>(&sharedPlan) : this, std::memory_order_release);
+        };
+        
+        for (auto& sink : plan->getSinks())
+            mark(*sink);
+        
+        for (auto& node : plan->getSignals())
+            mark(*node.signal);
+        
+        return plan;
+    }
+    
+    void Clock::updatePlan()
+    {
+        std::lock_guard<std::recursive_mutex> lock(getClocks().mutex);
+        if (deferrals == 0)
+            reclaimPlans();
+        
+        auto next = std::unique_ptr<ExecutionPlan>(pendingPlan.exchange(nullptr, std::memory_order_acquire));
+        if (!isCompiled() && !isOptimized())
+        {
+            plan = nullptr;
+            return;
+        }
+        
+        if (next)
+            plan = std::move(next);
+        else if (!plan)
+            plan = build();
+    }
+    
+    void Clock::retire(ExecutionPlan* plan)
+    {
+        if (!plan)
+            return;
+        
+        plan->next = retiredPlans.load(std::memory_order_relaxed);
+        while (!retiredPlans.compare_exchange_weak(plan->next, plan, std::memory_order_release, std::memory_order_relaxed));
+    }
+    
+    void Clock::reclaimPlans()
+    {
+        auto plan = retiredPlans.exchange(nullptr, std::memory_order_acquire);
+        while (plan)
+        {
+            auto next = plan->next;
+            delete plan;
+            plan = next;
+        }
+    }
+    
+    void Clock::rebuildPlans(const void* plannedBy)
+    {
+        if (!plannedBy)
+            return;
+        
+        auto& clocks = getClocks();
+        std::lock_guard<std::recursive_mutex> lock(clocks.mutex);
+        for (std::size_t i = 0; i < clocks.clocks.size(); ++i)
+        {
+            if (plannedBy == &sharedPlan || plannedBy == clocks.clocks[i])
+                clocks.clocks[i]->graphChanged();
+        }
+    }
+    
+    Clock::DeferralScope::DeferralScope()
+    {
+        ++deferrals;
+    }
+    
+    Clock::DeferralScope::~DeferralScope()
+    {
+        --deferrals;
+    }
+    
+    std::atomic<uint64_t>& Clock::getLocalRenderOffset() const
+    {
+        for (auto scope = renderOffsetScope; scope; scope = scope->previous)
+        {
+            if (&scope->clock == this)
+                return scope->offset;
+        }
+        
+        return const_cast<std::atomic<uint64_t>&>(renderOffset);
+    }
+    
+    Clock::RenderOffsetScope::RenderOffsetScope(const Clock& clock) :
+        clock(clock),
+        offset(clock.getRenderOffset()),
+        previous(renderOffsetScope)
+    {
+        renderOffsetScope = this;
+        clock.localRenderOffsets.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    Clock::RenderOffsetScope::~RenderOffsetScope()
+    {
+        clock.localRenderOffsets.fetch_sub(1, std::memory_order_relaxed);
+        renderOffsetScope = previous;
+    }
+    
+    void Clock::onTick(std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            onTick();
+    }
+    
+    void Clock::recordTick(std::chrono::steady_clock::time_point start, std::size_t count)
+    {
+        const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        auto monitor = this->monitor.load(std::memory_order_relaxed);
+        monitor->latency.record(duration);
+        
+        auto allowed = deadline.load(std::memory_order_relaxed);
+        if (allowed == 0)
+            allowed = static_cast<int64_t>(delta() * 1e9);
+        
+        if (allowed > 0 && duration > allowed * static_cast<int64_t>(count))
+            monitor->deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    void Clock::setCompiled(bool compiled)
+    {
+        this->compiled.store(compiled, std::memory_order_release);
+        updatePlan();
+    }
+    
+    void Clock::setOptimized(bool optimized)
+    {
+        if (optimized == isOptimized())
+            return;
+        
+        // Undo the optimizations while the plan still knows the signals of the graph
+        updatePlan();
+        if (!optimized && plan)
+            GraphOptimizer::deoptimize(*plan);
+        
+        this->optimized.store(optimized, std::memory_order_release);
+        updatePlan();
+        
+        if (optimized)
+            GraphOptimizer::optimize(*plan);
+    }
+    
+    void Clock::setExecutor(ParallelExecutor* executor)
+    {
+        this->executor = executor;
+        if (executor)
+            setCompiled(true);
+    }
+    
+    void Clock::setMonitored(bool monitored)
+    {
+        if (monitored && !monitor.load(std::memory_order_relaxed))
+            monitor.store(new TickMonitor, std::memory_order_release);
+        
+        this->monitored.store(monitored, std::memory_order_release);
+    }
+    
+    Clock::TickStatistics Clock::getTickStatistics() const
+    {
+        TickStatistics statistics;
+        auto monitor = this->monitor.load(std::memory_order_acquire);
+        if (!monitor)
+            return statistics;
+        
+        statistics.latency = monitor->latency.getSnapshot();
+        statistics.deadlineMisses = monitor->deadlineMisses.load(std::memory_order_relaxed);
+        return statistics;
+    }
+    
+    void Clock::resetTickStatistics()
+    {
+        auto monitor = this->monitor.load(std::memory_order_acquire);
+        if (!monitor)
+            return;
+        
+        monitor->latency.reset();
+        monitor->deadlineMisses.store(0, std::memory_order_relaxed);
+    }
+}
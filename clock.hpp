@@ -29,57 +29,316 @@
 #ifndef OCTOPUS_CLOCK_HPP
 #define OCTOPUS_CLOCK_HPP
 
+#include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
-#include <set>
+#include <memory>
+#include <vector>
 
+#include "latency_histogram.hpp"
 #include "sink.hpp"
 
 namespace octo
 {
+    class ExecutionPlan;
+    class ParallelExecutor;
+    
     //! Base class VariableClock and InvariableClock
     class Clock
     {
+        friend class Sink;
+        
     public:
+        class DeferralScope;
+        class RenderOffsetScope;
+        
+        //! The durations of the ticks of a clock (see setMonitored())
+        struct TickStatistics
+        {
+            //! The wall-clock durations of the ticks (in nanoseconds)
+            LatencyHistogram::Snapshot latency;
+            
+            //! The number of ticks that took longer than the deadline
+            uint64_t deadlineMisses = 0;
+        };
+    
+    public:
+        //! Construct the clock
+        Clock();
+        
         //! Virtual destructor, because this is a base class
-        virtual ~Clock() = default;
+        virtual ~Clock();
         
         //! Return the rate at which the clock runs (in Hertz)
         virtual float rate() const = 0;
         
         //! Return the delta between ticks (in seconds)
-        virtual float delta() const { return 1.0 / rate(); }
+        /*! The delta is cached, because signals tend to ask for it with every sample. Derived clocks
+            call rateChanged() to keep it up to date. Until they first do, it's computed from rate(). */
+        virtual float delta() const { return delta_ ? delta_ : 1.0 / rate(); }
         
         //! Tick the clock
-        uint64_t tick()
-        {
-            onTick();
-            
-            for (auto& sink : persistentSinks)
-                sink->update();
-            
-            return now();
-        }
+        uint64_t tick();
+        
+        //! Tick the clock a number of times, updating the persistent sinks a block at a time
+        /*! Persistent signals render all frames at once (see Signal::pullBlock()), instead of being updated
+            frame by frame, and the clock is then moved past them. Sinks that aren't signals are updated
+            frame by frame unless they override Sink::updateBlock(). Because every sink renders its whole
+            block before the next sink does, feedback loops between persistent sinks are delayed by a block.
+            Clocks with an executor (see setExecutor()) render the tasks of their plan a block at a time in
+            parallel (see ParallelExecutor::runBlock()).
+         
+            Like tick(), this renders the frames after now(), so a block pulled before ticking overlaps the
+            rendered one by all but its first frame, which is reused. The frames rendered by persistent
+            signals can be read afterwards with Signal::getRenderedBlock().
+            @return The time index of the clock after the last tick */
+        uint64_t tick(std::size_t count);
         
         //! Return the clocks current time index
         virtual uint64_t now() const = 0;
         
+        //! Return the time index at which signals are currently rendered
+        /*! This equals now(), except while a block is being rendered sample-by-sample (see
+            Signal::generateBlock()), during which it walks through the frames of that block. */
+        uint64_t renderTime() const { return now() + getRenderOffset(); }
+        
+        //! Offset the render time relative to now()
+        /*! Only changes the offset of the calling thread inside a RenderOffsetScope for the clock. */
+        void setRenderOffset(uint64_t offset) { getRenderOffsetVariable().store(offset, std::memory_order_relaxed); }
+        
+        //! Return the offset of the render time relative to now()
+        uint64_t getRenderOffset() const { return getRenderOffsetVariable().load(std::memory_order_relaxed); }
+        
         //! Add a signal as persistent
-        void addPersistentSink(Sink& sink) { persistentSinks.emplace(&sink); }
+        void addPersistentSink(Sink& sink);
         
         //! Remove a signal as persistent
-        void removePersistentSink(Sink& sink) { persistentSinks.erase(&sink); }
+        void removePersistentSink(Sink& sink);
         
         //! Is a signal persistent for this clock?
-        bool isSinkPersistent(const Sink& sink) const { return persistentSinks.count(const_cast<Sink*>(&sink)); }
+        bool isSinkPersistent(const Sink& sink) const;
+        
+        //! Return the sinks that are updated with each tick, in the order in which they were added
+        const std::vector<Sink*>& getPersistentSinks() const { return persistentSinks; }
+        
+        //! Have the clock tick according to a compiled execution plan
+        /*! Instead of recursively pulling the graph from each persistent sink, a compiled clock flattens
+            the graph into a topologically ordered schedule (see GraphCompiler), updating each node once
+            per tick. The plan is recompiled automatically whenever the structure of the graph changes (see
+            getGraphEpoch()). Call this from the thread ticking the clock, or while it isn't ticking. */
+        void setCompiled(bool compiled);
+        
+        //! Does the clock tick according to a compiled execution plan?
+        bool isCompiled() const { return compiled.load(std::memory_order_acquire); }
+        
+        //! Have the clock optimize the graph it ticks
+        /*! Constant subgraphs are folded, constant terms are merged and identities are removed (see
+            GraphOptimizer). The graph is reoptimized automatically whenever its structure changes or a
+            Value is assigned. Call this from the thread ticking the clock, or while it isn't ticking. */
+        void setOptimized(bool optimized);
+        
+        //! Does the clock optimize the graph it ticks?
+        bool isOptimized() const { return optimized.load(std::memory_order_acquire); }
         
+        //! Return the epoch of the graph ticked by this clock
+        /*! The epoch changes whenever the structure of the graph changes in a way that matters to the
+            execution plan of the clock (e.g. a Value in the plan is reassigned, or a persistent sink is
+            added). The thread making the change rebuilds the plan right away, and the thread ticking
+            the clock swaps it in at its next tick, so ticking never compiles the graph itself. Clocks
+            that aren't compiled or optimized have no plan to rebuild. */
+        uint64_t getGraphEpoch() const { return graphEpoch.load(std::memory_order_acquire); }
+        
+        //! Have signals skip generating samples as long as their inputs don't change
+        /*! In incremental mode, pure signals (see SignalBase::isPure()) only generate a new sample when
+            the output of one of their dependencies changed, and keep their cache otherwise. Signals only
+            let their dependents know they changed if their new sample differs from the previous one (see
+            SignalBase::getRevision()). This pays off for graphs that hold still most of the time (e.g.
+            parameters and control signals), at the cost of comparing every generated sample. */
+        void setIncremental(bool incremental) { this->incremental.store(incremental, std::memory_order_relaxed); }
+        
+        //! Do signals at this clock skip generating samples as long as their inputs don't change?
+        bool isIncremental() const { return incremental.load(std::memory_order_relaxed); }
+        
+        //! Have the clock run its execution plan on multiple cores
+        /*! Setting an executor compiles the clock (see setCompiled()). Pass nullptr to have the clock
+            tick on a single thread again. The executor isn't owned by the clock, and should outlive it
+            or be removed before it is destroyed. */
+        void setExecutor(ParallelExecutor* executor);
+        
+        //! Return the executor running the execution plan, if any
+        ParallelExecutor* getExecutor() const { return executor; }
+        
+        //! Measure how long every tick takes, and count the ticks that miss their deadline
+        /*! Ticks are timed from start to end, including the updates of the persistent sinks and any
+            reoptimization or recompilation of the graph. Ticking multiple frames at once (see tick(std::size_t))
+            counts as a single tick, with a deadline that many times as long. The histogram is allocated the
+            first time monitoring is enabled, and ticking doesn't allocate after that. */
+        void setMonitored(bool monitored);
+        
+        //! Are the durations of the ticks being measured?
+        bool isMonitored() const { return monitored.load(std::memory_order_acquire); }
+        
+        //! Set the time a tick may take, beyond which it counts as a deadline miss
+        /*! Zero (the default) uses the period of the clock (see delta()), e.g. 1/44100th of a second at 44.1kHz */
+        void setDeadline(std::chrono::nanoseconds deadline) { this->deadline.store(deadline.count(), std::memory_order_relaxed); }
+        
+        //! Return the time a tick may take, or zero when it's the period of the clock
+        std::chrono::nanoseconds getDeadline() const { return std::chrono::nanoseconds(deadline.load(std::memory_order_relaxed)); }
+        
+        //! Return the durations of the ticks measured so far
+        /*! Can be called from any thread, without blocking the thread ticking the clock. */
+        TickStatistics getTickStatistics() const;
+        
+        //! Forget the durations of the ticks measured so far
+        void resetTickStatistics();
+    
+    protected:
+        //! Let the clock know its rate changed, so it can update the cached delta
+        void rateChanged() { delta_ = 1.0 / rate(); }
+    
     private:
+        //! Swap in the plan rebuilt since the last tick, if any, and optimize it
+        void prepare();
+        
+        //! Let the clock know the structure of its graph changed, and rebuild the plan
+        void graphChanged();
+        
+        //! Rebuild the plan, and publish it to the thread ticking the clock
+        void rebuild();
+        
+        //! Compile a plan, and mark the sinks it includes as planned by this clock
+        std::unique_ptr<ExecutionPlan> build();
+        
+        //! Build or drop the plan right away, depending on whether the clock is compiled or optimized
+        /*! Unlike rebuild(), this is called by the thread ticking the clock. */
+        void updatePlan();
+        
+        //! Hand a plan that is no longer run back to the threads rebuilding the plan
+        void retire(ExecutionPlan* plan);
+        
+        //! Delete the plans handed back by retire()
+        void reclaimPlans();
+        
+        //! Rebuild the plans of the clocks that planned a sink (see Sink::graphChanged())
+        static void rebuildPlans(const void* plannedBy);
+        
         //! Move the clock to its next time index
         virtual void onTick() = 0;
         
+        //! Move the clock a number of time indices ahead
+        /*! The default implementation calls onTick() for every index. */
+        virtual void onTick(std::size_t count);
+        
+        //! Measure a tick that started at a given time and rendered a number of frames
+        void recordTick(std::chrono::steady_clock::time_point start, std::size_t count);
+        
+        //! Return the render offset of the calling thread (see RenderOffsetScope)
+        std::atomic<uint64_t>& getRenderOffsetVariable() const
+        {
+            // Only look for an offset of the calling thread while some thread has one
+            if (localRenderOffsets.load(std::memory_order_relaxed) == 0)
+                return const_cast<std::atomic<uint64_t>&>(renderOffset);
+            
+            return getLocalRenderOffset();
+        }
+        
+        //! Return the render offset of the calling thread, if it's inside a RenderOffsetScope for the clock
+        std::atomic<uint64_t>& getLocalRenderOffset() const;
+    
+    private:
+        //! The sinks that will be updated with each tick (a flat array, which is faster to walk than a tree)
+        std::vector<Sink*> persistentSinks;
+        
+        //! The persistent sinks that are signals, which tick(std::size_t) renders before the others
+        std::vector<Sink*> persistentSignals;
+        
+        //! The persistent sinks that aren't signals
+        std::vector<Sink*> otherPersistentSinks;
+        
+        //! The delta between ticks, as of the last rate change (zero if rateChanged() was never called)
+        float delta_ = 0;
+        
+        //! The offset of the render time relative to now()
+        std::atomic<uint64_t> renderOffset{0};
+        
+        //! The number of threads with a render offset of their own (see RenderOffsetScope)
+        mutable std::atomic<std::size_t> localRenderOffsets{0};
+        
+        //! The execution plan the clock ticks with, if compiled or optimized (owned by the thread ticking the clock)
+        std::unique_ptr<ExecutionPlan> plan;
+        
+        //! A plan rebuilt since the last tick, waiting to be swapped in by prepare()
+        std::atomic<ExecutionPlan*> pendingPlan{nullptr};
+        
+        //! Plans swapped out by prepare(), waiting to be deleted by the next rebuild()
+        std::atomic<ExecutionPlan*> retiredPlans{nullptr};
+        
+        //! The epoch of the graph ticked by this clock (see getGraphEpoch())
+        std::atomic<uint64_t> graphEpoch{0};
+        
+        //! The executor running the execution plan on multiple cores, if any
+        ParallelExecutor* executor = nullptr;
+        
+        //! Does the clock tick according to its plan?
+        std::atomic<bool> compiled{false};
+        
+        //! Does the clock optimize its graph?
+        std::atomic<bool> optimized{false};
+        
+        //! Do signals skip generating samples as long as their inputs don't change?
+        std::atomic<bool> incremental{false};
+        
+        //! The measurements of the ticks, allocated when first monitored and owned by the clock
+        /*! Atomic, so monitoring threads can read them while monitoring is being enabled */
+        struct TickMonitor;
+        std::atomic<TickMonitor*> monitor{nullptr};
+        
+        //! Are the durations of the ticks being measured?
+        std::atomic<bool> monitored{false};
+        
+        //! The time a tick may take (in nanoseconds), or zero for the period of the clock
+        std::atomic<int64_t> deadline{0};
+    };
+    
+    //! Keeps the plans retired by clocks from being deleted on the calling thread, for as long as it exists
+    /*! Deleting a plan destroys the signals only it kept alive, which could be the very signals changing
+        the graph at the time (e.g. values disconnecting from a signal being destroyed, see
+        SignalBase::disconnectDependees()). The plans are deleted by the first rebuild after the scope,
+        or along with the clock. Scopes nest. */
+    class Clock::DeferralScope
+    {
+    public:
+        DeferralScope();
+        ~DeferralScope();
+        
+        DeferralScope(const DeferralScope&) = delete;
+        DeferralScope& operator=(const DeferralScope&) = delete;
+    };
+    
+    //! Gives the calling thread a render offset of its own for a clock, for as long as it exists
+    /*! The offset starts out as the render offset of the clock. Used by ParallelExecutor, so the threads
+        rendering blocks at once don't move each other's render times. */
+    class Clock::RenderOffsetScope
+    {
+        friend class Clock;
+    
+    public:
+        RenderOffsetScope(const Clock& clock);
+        ~RenderOffsetScope();
+        
+        RenderOffsetScope(const RenderOffsetScope&) = delete;
+        RenderOffsetScope& operator=(const RenderOffsetScope&) = delete;
+    
     private:
-        //! The sinks that will be updated with each tick
-        std::set<Sink*> persistentSinks;
+        //! The clock whose render offset is replaced
+        const Clock& clock;
+        
+        //! The render offset of the calling thread
+        std::atomic<uint64_t> offset;
+        
+        //! The scope that was innermost on the calling thread before this one
+        RenderOffsetScope* previous = nullptr;
     };
     
     //! A clock with an invariable, constant rate
@@ -100,28 +359,35 @@ namespace octo
         InvariableClock(float rateInHertz) :
             rate_(rateInHertz)
         {
-            
+            rateChanged();
         }
         
         //! Set the sample rate of the clock (in Hertz)
-        void setRate(float rateInHertz) { rate_ = rateInHertz; }
+        void setRate(float rateInHertz)
+        {
+            rate_ = rateInHertz;
+            rateChanged();
+        }
         
         //! Return the rate at which the clock runs (in Hertz)
         float rate() const final override { return rate_; }
         
         //! Return the clocks current time index
-        uint64_t now() const final override { return timestamp; }
+        uint64_t now() const final override { return timestamp.load(std::memory_order_relaxed); }
         
     private:
         //! Move the clock to its next time index
-        void onTick() final override { ++timestamp; }
+        void onTick() final override { timestamp.fetch_add(1, std::memory_order_relaxed); }
         
+        //! Move the clock a number of time indices ahead
+        void onTick(std::size_t count) final override { timestamp.fetch_add(count, std::memory_order_relaxed); }
+    
     private:
         //! The rate at which the clock runs
         float rate_ = 0;
         
-        //! The current time index of the clock
-        uint64_t timestamp = 0;
+        //! The current time index of the clock (atomic, so control threads can read it while ticking)
+        std::atomic<uint64_t> timestamp{0};
     };
     
     //! A clock with a variable sample rate
@@ -143,31 +409,36 @@ namespace octo
             rate_(startingRateInHertz)
         {
             lastNow = std::chrono::high_resolution_clock::now();
+            rateChanged();
         }
         
         //! Return the rate at which the clock runs (in Hertz)
         float rate() const final override { return rate_; }
         
         //! Return the clocks current time index
-        uint64_t now() const final override { return timestamp; }
+        uint64_t now() const final override { return timestamp.load(std::memory_order_relaxed); }
         
     private:
         //! Move the clock to its next time index
-        void onTick() final override
+        void onTick() final override { onTick(1); }
+        
+        //! Move the clock a number of time indices ahead, spreading the elapsed time over them
+        void onTick(std::size_t count) final override
         {
             auto now = std::chrono::high_resolution_clock::now();
-            rate_ = 1.0 / std::chrono::duration_cast<std::chrono::duration<double>>(now - lastNow).count();
+            rate_ = count / std::chrono::duration_cast<std::chrono::duration<double>>(now - lastNow).count();
             lastNow = now;
+            rateChanged();
             
-            ++timestamp;
+            timestamp.fetch_add(count, std::memory_order_relaxed);
         }
         
     private:
         //! The rate at which the clock currently runs
         float rate_ = 0;
         
-        //! The current time index of the clock
-        uint64_t timestamp = 0;
+        //! The current time index of the clock (atomic, so control threads can read it while ticking)
+        std::atomic<uint64_t> timestamp{0};
         
         //! The time at the previous tick() call
         std::chrono::high_resolution_clock::time_point lastNow;
@@ -0,0 +1,82 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <chrono>
+
+#include "clock.hpp"
+#include "clock_thread.hpp"
+
+namespace octo
+{
+    ClockThread::ClockThread(Clock& clock) :
+        clock(clock)
+    {
+    
+    }
+    
+    ClockThread::~ClockThread()
+    {
+        stop();
+    }
+    
+    void ClockThread::start()
+    {
+        if (running.exchange(true))
+            return;
+        
+        thread = std::thread([this]{ run(); });
+    }
+    
+    void ClockThread::stop()
+    {
+        running.store(false);
+        if (thread.joinable())
+            thread.join();
+    }
+    
+    void ClockThread::run()
+    {
+        using namespace std::chrono;
+        
+        auto next = steady_clock::now();
+        while (running.load(std::memory_order_relaxed))
+        {
+            clock.tick();
+            
+            const auto period = duration_cast<steady_clock::duration>(duration<double>(clock.delta()));
+            next += period;
+            
+            // Don't try to catch up if we fell behind
+            const auto now = steady_clock::now();
+            if (next + period < now)
+                next = now;
+            
+            std::this_thread::sleep_until(next);
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_CLOCK_THREAD_HPP
+#define OCTOPUS_CLOCK_THREAD_HPP
+
+#include <atomic>
+#include <thread>
+
+namespace octo
+{
+    class Clock;
+    
+    //! Ticks a clock on a thread of its own, at the rate of the clock
+    /*! Use it to give a clock domain its own thread, like a video or control clock running next to
+        an audio clock that is ticked by the audio callback. Samples can be passed safely between the
+        domains with bridges (see Bridge).
+        
+        If ticking falls behind by more than a tick, the thread doesn't try to catch up but resumes at
+        the current time. */
+    class ClockThread
+    {
+    public:
+        //! Construct the thread (call start() to start ticking)
+        ClockThread(Clock& clock);
+        
+        //! Stop ticking and join the thread
+        ~ClockThread();
+        
+        ClockThread(const ClockThread&) = delete;
+        ClockThread& operator=(const ClockThread&) = delete;
+        
+        //! Start ticking
+        void start();
+        
+        //! Stop ticking (waits for the current tick to finish)
+        void stop();
+        
+        //! Is the thread ticking?
+        bool isRunning() const { return running.load(std::memory_order_relaxed); }
+        
+        //! Return the clock being ticked
+        Clock& getClock() const { return clock; }
+    
+    private:
+        //! The loop run by the thread
+        void run();
+    
+    private:
+        //! The clock being ticked
+        Clock& clock;
+        
+        //! The thread ticking the clock
+        std::thread thread;
+        
+        //! Should the thread keep ticking?
+        std::atomic<bool> running{false};
+    };
+}
+
+#endif
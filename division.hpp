@@ -29,9 +29,13 @@
 #ifndef OCTOPUS_DIVISION_HPP
 #define OCTOPUS_DIVISION_HPP
 
+#include <cstddef>
+#include <functional>
 #include <type_traits>
 
 #include "binary_operation.hpp"
+#include "expression.hpp"
+#include "simd.hpp"
 
 namespace octo
 {
@@ -45,12 +49,43 @@ namespace octo
         
         GENERATE_MOVE(Division)
         
+        // Inherited from SignalBase
+        bool isPure() const final override { return true; }
+    
     private:
+        //! Pass the left-hand side through when dividing by one
+        Signal<T>* simplify() final override
+        {
+            // Types that can't be compared with one (e.g. some user types) are never simplified
+            if constexpr (IsEqualityComparable<T>::value && std::is_constructible<T, int>::value)
+                return this->right.isFolded() && this->right() == T(1) ? &this->left : nullptr;
+            else
+                return nullptr;
+        }
+        
         //! Generate a new sample
         void combineSamples(const T& lhs, const T& rhs, T& out) final override
         {
             out = lhs / rhs;
         }
+        
+        //! Generate a new block of samples
+        void combineBlocks(const T* lhs, const T* rhs, T* out, std::size_t size) final override
+        {
+            simd::divide(lhs, rhs, out, size);
+        }
+        
+        //! Generate a new block of samples with a constant right-hand side
+        void combineBlockAndScalar(const T* lhs, const T& rhs, T* out, std::size_t size) final override
+        {
+            simd::divide(lhs, rhs, out, size);
+        }
+        
+        //! Generate a new block of samples with a constant left-hand side
+        void combineScalarAndBlock(const T& lhs, const T* rhs, T* out, std::size_t size) final override
+        {
+            simd::divide(lhs, rhs, out, size);
+        }
     };
     
     //! Combine a scalar and a signal into a division
@@ -120,6 +155,13 @@ namespace octo
         
         return {lhs.getClock(), std::move(lhs), std::move(rhs)};
     }
+    
+    //! Fuse a division into an arithmetic expression
+    template <class L, class R, class = EnableIfExpression<L, R>>
+    auto operator/(L&& lhs, R&& rhs)
+    {
+        return makeBinaryExpression<std::divides<>>(std::forward<L>(lhs), std::forward<R>(rhs));
+    }
 }
 
 #endif
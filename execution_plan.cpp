@@ -0,0 +1,215 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "clock.hpp"
+#include "execution_plan.hpp"
+#include "graph_optimizer.hpp"
+#include "signal_base.hpp"
+
+namespace octo
+{
+    void ExecutionPlan::run() const
+    {
+        Sink::PlanScope scope(*clock);
+        for (auto& sink : sinks)
+            sink->update();
+    }
+    
+    void ExecutionPlan::runBlock(std::size_t size) const
+    {
+        Sink::PlanScope scope(*clock);
+        for (auto& sink : sinks)
+            sink->updateBlock(size);
+    }
+    
+    ExecutionPlan GraphCompiler::compile(const Clock& clock)
+    {
+        ExecutionPlan plan;
+        plan.clock = &clock;
+        plan.epoch = clock.getGraphEpoch();
+        
+        std::unordered_set<Sink*> visited;
+        
+        // Walk the graph depth-first without recursing, so that long chains can't overflow the stack.
+        // Every frame holds a sink, its dependencies and the number of them that have yet to be visited.
+        struct Frame
+        {
+            Sink* sink;
+            std::vector<SignalBase*> dependencies;
+            std::size_t remaining;
+        };
+        
+        std::vector<Frame> stack;
+        auto visit = [&](Sink* sink)
+        {
+            auto signal = dynamic_cast<SignalBase*>(sink);
+            if (!signal)
+            {
+                stack.push_back({sink, {}, 0});
+                return;
+            }
+            
+            auto dependencies = signal->getAssignedDependencies();
+            if (auto pin = signal->pinAssigned())
+                plan.pins.emplace_back(std::move(pin));
+            
+            const auto remaining = dependencies.size();
+            stack.push_back({sink, std::move(dependencies), remaining});
+        };
+        
+        // Schedule sinks that aren't signals last. Nothing depends on them, and when the plan is run
+        // a block at a time, they should read from the blocks the signals have already rendered.
+        auto roots = clock.getPersistentSinks();
+        std::stable_partition(roots.begin(), roots.end(), [](Sink* sink){ return dynamic_cast<SignalBase*>(sink) != nullptr; });
+        
+        for (auto& root : roots)
+        {
+            if (!visited.emplace(root).second)
+                continue;
+            
+            visit(root);
+            while (!stack.empty())
+            {
+                auto& frame = stack.back();
+                if (frame.remaining == 0)
+                {
+                    // All dependencies have been scheduled, so schedule the sink itself
+                    if (frame.sink->getClock() == &clock)
+                        plan.sinks.emplace_back(frame.sink);
+                    
+                    if (auto signal = dynamic_cast<SignalBase*>(frame.sink))
+                        plan.signals.push_back({signal, std::move(frame.dependencies)});
+                    
+                    stack.pop_back();
+                    continue;
+                }
+                
+                auto dependency = frame.dependencies[--frame.remaining];
+                
+                // Signals running at other clocks are kept up to date by their own clock
+                if (dependency->getClock() != &clock && dependency->getClock() != nullptr)
+                    continue;
+                
+                if (visited.emplace(dependency).second)
+                    visit(dependency);
+            }
+        }
+        
+        partition(plan);
+        GraphOptimizer::reserve(plan);
+        return plan;
+    }
+    
+    void GraphCompiler::partition(ExecutionPlan& plan)
+    {
+        const auto& sinks = plan.sinks;
+        
+        std::unordered_map<Sink*, std::size_t> indices;
+        for (std::size_t i = 0; i < sinks.size(); ++i)
+            indices.emplace(sinks[i], i);
+        
+        std::unordered_map<SignalBase*, const std::vector<SignalBase*>*> nodes;
+        for (auto& node : plan.signals)
+            nodes.emplace(node.signal, &node.dependencies);
+        
+        // Find the scheduled sinks each sink depends on. Unscheduled clockless signals are pulled
+        // on demand, so look through them. Dependencies scheduled later are feedback loops and are
+        // dropped, as they read the previous sample anyway.
+        std::vector<std::vector<std::size_t>> dependencies(sinks.size());
+        std::vector<std::size_t> dependentCounts(sinks.size(), 0);
+        for (std::size_t i = 0; i < sinks.size(); ++i)
+        {
+            auto node = nodes.find(dynamic_cast<SignalBase*>(sinks[i]));
+            if (node == nodes.end())
+                continue;
+            
+            std::unordered_set<SignalBase*> visited;
+            auto stack = *node->second;
+            while (!stack.empty())
+            {
+                auto dependency = stack.back();
+                stack.pop_back();
+                
+                if (!visited.emplace(dependency).second)
+                    continue;
+                
+                auto index = indices.find(dependency);
+                if (index != indices.end())
+                {
+                    if (index->second < i)
+                        dependencies[i].emplace_back(index->second);
+                } else if (dependency->getClock() == nullptr) {
+                    auto next = nodes.find(dependency);
+                    if (next != nodes.end())
+                        stack.insert(stack.end(), next->second->begin(), next->second->end());
+                }
+            }
+            
+            for (auto& dependency : dependencies[i])
+                ++dependentCounts[dependency];
+        }
+        
+        // Assign each sink to a task, appending it to the task of its only dependency if it is that
+        // dependency's only dependent. Because sinks are in topological order, tasks are too.
+        std::vector<std::size_t> taskOfSink(sinks.size());
+        for (std::size_t i = 0; i < sinks.size(); ++i)
+        {
+            if (dependencies[i].size() == 1 && dependentCounts[dependencies[i].front()] == 1)
+            {
+                taskOfSink[i] = taskOfSink[dependencies[i].front()];
+            } else {
+                taskOfSink[i] = plan.tasks.size();
+                plan.tasks.emplace_back();
+            }
+            
+            plan.tasks[taskOfSink[i]].sinks.emplace_back(sinks[i]);
+        }
+        
+        // Connect the tasks
+        for (std::size_t i = 0; i < sinks.size(); ++i)
+        {
+            for (auto& dependency : dependencies[i])
+            {
+                auto& task = plan.tasks[taskOfSink[dependency]];
+                if (taskOfSink[dependency] == taskOfSink[i])
+                    continue;
+                
+                if (std::find(task.dependents.begin(), task.dependents.end(), taskOfSink[i]) != task.dependents.end())
+                    continue;
+                
+                task.dependents.emplace_back(taskOfSink[i]);
+                ++plan.tasks[taskOfSink[i]].dependencyCount;
+            }
+        }
+    }
+}
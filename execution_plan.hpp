@@ -0,0 +1,172 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_EXECUTION_PLAN_HPP
+#define OCTOPUS_EXECUTION_PLAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace octo
+{
+    class Clock;
+    class SignalBase;
+    class Sink;
+    
+    //! A flat, topologically ordered schedule of the sinks in a graph
+    /*! Running the plan updates every sink exactly once, dependencies first. Because every
+        dependency is already up to date by the time a sink is updated, pulling it no longer
+        recurses through the graph, nor even calls Sink::update() (see Sink::isUpdatedByPlan()).
+        Plans are created by GraphCompiler. */
+    class ExecutionPlan
+    {
+        friend class Clock;
+        friend class GraphCompiler;
+        friend class GraphOptimizer;
+    
+    public:
+        //! A chain of sinks that can be updated independently of the rest of the plan
+        /*! A task can run as soon as all tasks it depends on have finished. Together, the tasks form
+            a dependency graph that lets ParallelExecutor update independent subgraphs on different cores. */
+        struct Task
+        {
+            //! The sinks in the task, in the order in which they are updated
+            std::vector<Sink*> sinks;
+            
+            //! The indices of the tasks that depend on this one
+            std::vector<std::size_t> dependents;
+            
+            //! The number of tasks this one depends on
+            std::size_t dependencyCount = 0;
+        };
+        
+        //! A signal in the graph, along with the signals it pulls
+        struct Node
+        {
+            //! The signal
+            SignalBase* signal = nullptr;
+            
+            //! The dependencies of the signal (see SignalBase::getAssignedDependencies())
+            std::vector<SignalBase*> dependencies;
+        };
+    
+    public:
+        //! Update every sink in the plan, in order
+        void run() const;
+        
+        //! Update every sink in the plan for a number of consecutive frames, in order
+        /*! See Sink::updateBlock() */
+        void runBlock(std::size_t size) const;
+        
+        //! Return the sinks in the order in which they are updated
+        const std::vector<Sink*>& getSinks() const { return sinks; }
+        
+        //! Return the sinks partitioned into tasks
+        /*! Tasks are stored in topological order, so running them one by one in this order is
+            equivalent to run(). */
+        const std::vector<Task>& getTasks() const { return tasks; }
+        
+        //! Return every signal in the graph running at the clock or without a clock, dependencies first
+        /*! Unlike getSinks(), this includes signals without a clock, which are pulled on demand instead of
+            being scheduled. Used by GraphOptimizer. */
+        const std::vector<Node>& getSignals() const { return signals; }
+        
+        //! Return the clock the plan was compiled for
+        const Clock* getClock() const { return clock; }
+        
+        //! Return the epoch of the graph at which the plan was compiled
+        /*! If this differs from Clock::getGraphEpoch(), the plan is outdated */
+        uint64_t getEpoch() const { return epoch; }
+    
+    private:
+        //! An entry in the hash table GraphOptimizer finds signals computing the same with
+        struct Candidate
+        {
+            //! The hash of the operation and the inputs of the signal
+            std::size_t key = 0;
+            
+            //! One past the index of the signal in signals, or zero if the entry is empty
+            std::size_t node = 0;
+            
+            //! The position of the resolved inputs of the signal in inputs
+            std::size_t begin = 0;
+        };
+    
+    private:
+        //! The sinks, in topological order
+        std::vector<Sink*> sinks;
+        
+        //! The sinks, partitioned into tasks
+        std::vector<Task> tasks;
+        
+        //! The signals in the graph, dependencies first
+        std::vector<Node> signals;
+        
+        //! Keep the signals in the plan alive (see SignalBase::pinAssigned())
+        std::vector<std::shared_ptr<void>> pins;
+        
+        //! The hash table used by GraphOptimizer, allocated along with the plan so that optimizing doesn't allocate
+        std::vector<Candidate> candidates;
+        
+        //! The resolved inputs of the signals in candidates
+        std::vector<SignalBase*> inputs;
+        
+        //! The clock the plan was compiled for
+        const Clock* clock = nullptr;
+        
+        //! The graph epoch at which the plan was compiled
+        uint64_t epoch = 0;
+        
+        //! The next plan in the list of plans retired by a clock
+        ExecutionPlan* next = nullptr;
+    };
+    
+    //! Flattens graphs into execution plans
+    class GraphCompiler
+    {
+    public:
+        //! Compile the graph pulled by the persistent sinks of a clock
+        /*! The graph is walked as the thread assigning to values sees it (see SignalBase::getAssignedDependencies()),
+            so plans can be compiled away from the thread ticking the clock. The plan keeps the signals it
+            includes alive. Only sinks running at the given clock are scheduled, signals of other clocks are
+            left alone. Signals folded by GraphOptimizer are scheduled all the same, as optimizations are made
+            by the thread ticking the clock. Feedback loops are broken at the point where they refer back to
+            a signal already being visited. */
+        static ExecutionPlan compile(const Clock& clock);
+    
+    private:
+        //! Partition the sinks of a plan into tasks
+        /*! Chains of sinks with a single dependency and a single dependent are merged into one task,
+            so that threads don't have to synchronise for every node of a long chain. */
+        static void partition(ExecutionPlan& plan);
+    };
+}
+
+#endif
@@ -0,0 +1,396 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_EXPRESSION_HPP
+#define OCTOPUS_EXPRESSION_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "signal.hpp"
+#include "value.hpp"
+
+namespace octo
+{
+    template <class E>
+    class FusedSignal;
+    
+    //! Base class for lazily evaluated arithmetic expressions
+    /*! Chaining arithmetic operators on signals builds a graph with one node per operator (Sum,
+        Product, etc.), each pulling its inputs through a Value. Expressions instead build a
+        tree of inlined terms, which is only turned into a signal once, as a FusedSignal. Every
+        sample (or block) is then computed in a single evaluation, without dispatching between
+        nodes.
+        
+        Expressions are started with lazy(), after which the regular arithmetic operators
+        extend them:
+        
+        @code
+        oscillator.frequency = lazy(Sine(&audio, 0.5f)) * 100.0f + 440.0f;
+        @endcode
+        
+        Expressions convert to a FusedSignal wherever a Signal rvalue is expected. Use fuse()
+        where that conversion isn't picked up automatically (e.g. Value<float> v = fuse(...)). */
+    template <class Derived>
+    class Expression
+    {
+    public:
+        //! Fuse the expression into a single signal
+        operator FusedSignal<Derived>() && { return FusedSignal<Derived>(std::move(static_cast<Derived&>(*this))); }
+    };
+    
+    //! Is a type an expression?
+    template <class T>
+    class IsExpression
+    {
+    private:
+        template <class D>
+        static std::true_type test(const Expression<D>*);
+        static std::false_type test(...);
+    
+    public:
+        static constexpr bool value = decltype(test(std::declval<std::decay_t<T>*>()))::value;
+    };
+    
+    //! Is a type a signal?
+    template <class T>
+    using IsSignal = std::is_base_of<SignalBase, std::decay_t<T>>;
+    
+    //! Can an operator on these operands be turned into an expression?
+    /*! At least one of the operands should be an expression already, the other ones are
+        wrapped into terms. Operators on signals alone keep building regular nodes. */
+    template <class... Operands>
+    using EnableIfExpression = std::enable_if_t<(IsExpression<Operands>::value || ...)>;
+    
+    //! A term in an expression that pulls from a signal
+    template <class T>
+    class SignalTerm : public Expression<SignalTerm<T>>
+    {
+    public:
+        //! The type of the values the term evaluates to
+        using value_type = T;
+    
+    public:
+        //! Construct the term by referencing or owning a signal
+        SignalTerm(Value<T> value) :
+            value(std::move(value))
+        {
+        
+        }
+        
+        //! Pull a block of samples, which are then evaluated frame by frame
+        void prepare(std::size_t size) { block = value.pullBlock(size); }
+        
+        //! Evaluate the term for the current sample
+        T evaluate() { return value(); }
+        
+        //! Evaluate a frame of the prepared block
+        T evaluate(std::size_t index) const { return block[index]; }
+        
+        //! Return the clock of the term
+        Clock* getClock() const { return value.getClock(); }
+        
+        //! Does the term always evaluate to the same value?
+        bool isConstant() const { return false; }
+        
+        //! Add the signals the term pulls from
+        void collectDependencies(std::vector<SignalBase*>& dependencies) { dependencies.emplace_back(&value); }
+    
+    private:
+        //! The signal that is pulled
+        Value<T> value;
+        
+        //! The last prepared block
+        const T* block = nullptr;
+    };
+    
+    //! A constant term in an expression
+    template <class T>
+    class ConstantTerm : public Expression<ConstantTerm<T>>
+    {
+    public:
+        //! The type of the values the term evaluates to
+        using value_type = T;
+    
+    public:
+        //! Construct the term with its constant
+        ConstantTerm(const T& constant) :
+            constant(constant)
+        {
+        
+        }
+        
+        //! Constants don't need preparing
+        void prepare(std::size_t size) { }
+        
+        //! Evaluate the term for the current sample
+        T evaluate() const { return constant; }
+        
+        //! Evaluate a frame of the prepared block
+        T evaluate(std::size_t index) const { return constant; }
+        
+        //! Constants don't run at any clock
+        Clock* getClock() const { return nullptr; }
+        
+        //! Does the term always evaluate to the same value?
+        bool isConstant() const { return true; }
+        
+        //! Constants don't pull from any signals
+        void collectDependencies(std::vector<SignalBase*>& dependencies) { }
+    
+    private:
+        //! The constant
+        T constant;
+    };
+    
+    //! Applies an operator on the result of an expression
+    template <class Operator, class E>
+    class UnaryExpression : public Expression<UnaryExpression<Operator, E>>
+    {
+    public:
+        //! The type of the values the expression evaluates to
+        using value_type = std::decay_t<decltype(std::declval<Operator>()(std::declval<typename E::value_type>()))>;
+    
+    public:
+        //! Construct the expression with its operand
+        UnaryExpression(E operand) :
+            operand(std::move(operand))
+        {
+        
+        }
+        
+        //! Prepare the operand for evaluating a block
+        void prepare(std::size_t size) { operand.prepare(size); }
+        
+        //! Evaluate the expression for the current sample
+        value_type evaluate() { return op(operand.evaluate()); }
+        
+        //! Evaluate a frame of the prepared block
+        value_type evaluate(std::size_t index) const { return op(operand.evaluate(index)); }
+        
+        //! Return the clock of the expression
+        Clock* getClock() const { return operand.getClock(); }
+        
+        //! Does the expression always evaluate to the same value?
+        bool isConstant() const { return operand.isConstant(); }
+        
+        //! Add the signals the expression pulls from
+        void collectDependencies(std::vector<SignalBase*>& dependencies) { operand.collectDependencies(dependencies); }
+    
+    private:
+        //! The operand
+        E operand;
+        
+        //! The operator
+        Operator op;
+    };
+    
+    //! Combines the results of two expressions using an operator
+    template <class Operator, class L, class R>
+    class BinaryExpression : public Expression<BinaryExpression<Operator, L, R>>
+    {
+    public:
+        //! The type of the values the expression evaluates to
+        using value_type = std::decay_t<decltype(std::declval<Operator>()(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()))>;
+    
+    public:
+        //! Construct the expression with its operands
+        /*! @throw std::invalid_argument if both operands pull from signals of different clocks */
+        BinaryExpression(L lhs, R rhs) :
+            lhs(std::move(lhs)),
+            rhs(std::move(rhs))
+        {
+            if (!this->lhs.isConstant() && !this->rhs.isConstant() && this->lhs.getClock() != this->rhs.getClock())
+                throw std::invalid_argument("cannot combine two signals that do not use the same clock");
+        }
+        
+        //! Prepare the operands for evaluating a block
+        void prepare(std::size_t size)
+        {
+            lhs.prepare(size);
+            rhs.prepare(size);
+        }
+        
+        //! Evaluate the expression for the current sample
+        value_type evaluate()
+        {
+            // Evaluate the operands in order, so signals are pulled in a predictable order
+            auto left = lhs.evaluate();
+            return op(left, rhs.evaluate());
+        }
+        
+        //! Evaluate a frame of the prepared block
+        value_type evaluate(std::size_t index) const { return op(lhs.evaluate(index), rhs.evaluate(index)); }
+        
+        //! Return the clock of the expression
+        Clock* getClock() const { return lhs.isConstant() ? rhs.getClock() : lhs.getClock(); }
+        
+        //! Does the expression always evaluate to the same value?
+        bool isConstant() const { return lhs.isConstant() && rhs.isConstant(); }
+        
+        //! Add the signals the expression pulls from
+        void collectDependencies(std::vector<SignalBase*>& dependencies)
+        {
+            lhs.collectDependencies(dependencies);
+            rhs.collectDependencies(dependencies);
+        }
+    
+    private:
+        //! The left-hand side operand
+        L lhs;
+        
+        //! The right-hand side operand
+        R rhs;
+        
+        //! The operator
+        Operator op;
+    };
+    
+    //! A signal computing a whole expression per sample
+    template <class E>
+    class FusedSignal : public Signal<typename E::value_type>
+    {
+    public:
+        //! The type of the samples
+        using T = typename E::value_type;
+    
+    public:
+        //! Construct the signal from an expression
+        FusedSignal(E expression) :
+            Signal<T>(expression.getClock()),
+            expression(std::move(expression))
+        {
+        
+        }
+        
+        // Inherited from SignalBase
+        std::vector<SignalBase*> getDependencies() final override
+        {
+            std::vector<SignalBase*> dependencies;
+            expression.collectDependencies(dependencies);
+            return dependencies;
+        }
+        
+        GENERATE_MOVE(FusedSignal)
+        
+        // Inherited from SignalBase
+        bool isPure() const final override { return true; }
+        
+        //! Expressions embed constants that aren't dependencies, so they're never shared
+        bool isSameOperation(const SignalBase& other) const final override { return false; }
+    
+    private:
+        //! Generate a new sample
+        void generateSample(T& out) final override
+        {
+            out = expression.evaluate();
+        }
+        
+        //! Generate a new block of samples
+        void generateBlock(T* out, std::size_t size) final override
+        {
+            expression.prepare(size);
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = expression.evaluate(i);
+        }
+    
+    private:
+        //! The fused expression
+        E expression;
+    };
+    
+    //! Start an expression with a reference to a signal
+    template <class T>
+    SignalTerm<T> lazy(Signal<T>& signal)
+    {
+        return {Value<T>(signal)};
+    }
+    
+    //! Start an expression owning a signal
+    template <class T>
+    SignalTerm<T> lazy(Signal<T>&& signal)
+    {
+        return {Value<T>(std::move(signal))};
+    }
+    
+    //! Fuse an expression into a single signal
+    template <class E>
+    FusedSignal<E> fuse(Expression<E>&& expression)
+    {
+        return {std::move(static_cast<E&>(expression))};
+    }
+    
+    //! Wrap an operand into an expression term
+    /*! Expressions are taken as-is, signals are pulled by a SignalTerm and scalars are turned into a
+        ConstantTerm of type T (the type of the other operand) */
+    template <class T, class Operand>
+    auto makeTerm(Operand&& operand)
+    {
+        if constexpr (IsExpression<Operand>::value)
+            return std::decay_t<Operand>(std::forward<Operand>(operand));
+        else if constexpr (IsSignal<Operand>::value)
+            return lazy(std::forward<Operand>(operand));
+        else
+            return ConstantTerm<T>(operand);
+    }
+    
+    //! The type of the values an operand evaluates to
+    template <class Operand, class = void>
+    struct OperandType { using type = std::decay_t<Operand>; };
+    
+    template <class Operand>
+    struct OperandType<Operand, std::enable_if_t<IsExpression<Operand>::value>> { using type = typename std::decay_t<Operand>::value_type; };
+    
+    template <class Operand>
+    struct OperandType<Operand, std::enable_if_t<IsSignal<Operand>::value>> { using type = std::decay_t<decltype(std::declval<Operand&>()())>; };
+    
+    //! Apply an operator on an expression operand
+    template <class Operator, class Operand>
+    auto makeUnaryExpression(Operand&& operand)
+    {
+        using T = typename OperandType<Operand>::type;
+        auto term = makeTerm<T>(std::forward<Operand>(operand));
+        return UnaryExpression<Operator, decltype(term)>(std::move(term));
+    }
+    
+    //! Combine two operands of which at least one is an expression using an operator
+    /*! Scalar operands are converted to the type of the other operand, like the regular operator
+        overloads on signals do */
+    template <class Operator, class L, class R>
+    auto makeBinaryExpression(L&& lhs, R&& rhs)
+    {
+        auto left = makeTerm<typename OperandType<R>::type>(std::forward<L>(lhs));
+        auto right = makeTerm<typename OperandType<L>::type>(std::forward<R>(rhs));
+        return BinaryExpression<Operator, decltype(left), decltype(right)>(std::move(left), std::move(right));
+    }
+}
+
+#endif
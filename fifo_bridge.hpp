@@ -0,0 +1,94 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_FIFO_BRIDGE_HPP
+#define OCTOPUS_FIFO_BRIDGE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+#include "bridge.hpp"
+
+namespace octo
+{
+    //! Bridges every sample from one clock domain to another, in order
+    /*! Every time the bridge updates, it outputs the oldest sample that hasn't been output yet. If the
+        producer hasn't produced a new sample in time, the previous one is repeated (an underrun). If
+        the consumer falls behind so far that the ring fills up, new samples are dropped (see
+        Bridge::getDropCount()). Use it when no sample may be skipped, like streaming audio between two
+        clocks running at the same rate. */
+    template <class T>
+    class FifoBridge : public Bridge<T>
+    {
+    public:
+        //! Construct the bridge
+        /*! @param capacity The number of samples the producer can run ahead before samples are dropped */
+        FifoBridge(Clock* producer, Clock* consumer, std::size_t capacity = 1024, const T& initialCache = T{}) :
+            Bridge<T>(producer, consumer, capacity, initialCache),
+            last(initialCache)
+        {
+        
+        }
+        
+        //! Move a bridge
+        FifoBridge(FifoBridge&& rhs) :
+            Bridge<T>(std::move(rhs)),
+            last(std::move(rhs.last)),
+            underruns(rhs.underruns.load(std::memory_order_relaxed))
+        {
+        
+        }
+        
+        GENERATE_MOVE(FifoBridge)
+        
+        //! Return the number of times the previous sample was repeated because no new one was available
+        std::size_t getUnderrunCount() const { return underruns.load(std::memory_order_relaxed); }
+    
+    private:
+        // Inherited from Bridge
+        T makeEntry(const T& sample) final override { return sample; }
+        
+        //! Output the oldest sample
+        void generateSample(T& out) final override
+        {
+            if (!this->getRing().pop(last))
+                underruns.fetch_add(1, std::memory_order_relaxed);
+            
+            out = last;
+        }
+    
+    private:
+        //! The last sample popped
+        T last;
+        
+        //! The number of underruns
+        std::atomic<std::size_t> underruns{0};
+    };
+}
+
+#endif
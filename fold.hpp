@@ -29,10 +29,14 @@
 #ifndef OCTOPUS_FOLD_HPP
 #define OCTOPUS_FOLD_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
-#include <numeric>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "signal.hpp"
@@ -40,27 +44,196 @@
 
 namespace octo
 {
+    template <class In, class Out = In, class Op = void>
+    class Fold;
+    
+    //! Stores the operation policy of a fold, without taking up space for policies without state
+    template <class Op, bool = std::is_empty<Op>::value && !std::is_final<Op>::value>
+    class FoldPolicy
+    {
+    protected:
+        Op& policy() { return operation; }
+        const Op& policy() const { return operation; }
+    
+    private:
+        //! The operation policy
+        Op operation;
+    };
+    
+    //! Stores an operation policy without state, as an empty base
+    template <class Op>
+    class FoldPolicy<Op, true> : private Op
+    {
+    protected:
+        Op& policy() { return *this; }
+        const Op& policy() const { return *this; }
+    };
+    
+    //! The operation with which a fold combines its inputs
+    /*! Folds with an operation policy (the Op argument of Fold) call into it directly, so the compiler can
+        inline it into the per-sample and per-block loops. A policy provides:
+        - A static constexpr bool commutative, stating whether the order of the inputs doesn't matter
+        - Out init() const, returning the initial value of the fold
+        - void operator()(Out& out, const In& in) const, folding an input sample into an output sample
+        - Optionally void operator()(Out* out, const In* in, std::size_t size) const, folding a block of input samples
+        - Optionally void operator()(const In* const* blocks, std::size_t count, const Out& constant, Out* out, std::size_t size) const,
+          folding the blocks of all inputs of a commutative fold at once (with constant the folded constant inputs) */
+    template <class In, class Out, class Op>
+    class FoldOperation : public Signal<Out>, private FoldPolicy<Op>
+    {
+    public:
+        using Signal<Out>::Signal;
+        using Signal<Out>::operator();
+        
+        //! Retrieve the operation policy
+        Op& getOperation() { return this->policy(); }
+        
+        // Inherited from Signal, so folds with a policy can be used as is (subclasses use GENERATE_MOVE)
+        std::unique_ptr<Signal<Out>> moveToHeap() && override
+        {
+            return std::make_unique<Fold<In, Out, Op>>(std::move(static_cast<Fold<In, Out, Op>&>(*this)));
+        }
+        
+        std::size_t getStorageSize() const override
+        {
+            return alignof(Fold<In, Out, Op>) <= alignof(std::max_align_t) ? sizeof(Fold<In, Out, Op>) : 0;
+        }
+        
+        Signal<Out>* moveTo(void* storage) && override
+        {
+            return ::new (storage) Fold<In, Out, Op>(std::move(static_cast<Fold<In, Out, Op>&>(*this)));
+        }
+        
+        std::size_t getSize() const override
+        {
+            return sizeof(Fold<In, Out, Op>);
+        }
+    
+    protected:
+        //! Return the initial value of the fold
+        Out init() const { return this->policy().init(); }
+        
+        //! Reset an output sample to the initial value in place
+        void reset(Out& out) const { out = this->policy().init(); }
+        
+        //! Fold an input sample into an output sample in place
+        void accumulate(Out& out, const In& in) const { this->policy()(out, in); }
+        
+        //! Fold a block of input samples into a block of output samples
+        void foldBlock(Out* out, const In* in, std::size_t size) const
+        {
+            if constexpr (std::is_invocable<const Op&, Out*, const In*, std::size_t>::value)
+            {
+                this->policy()(out, in, size);
+            } else {
+                for (std::size_t i = 0; i < size; ++i)
+                    this->policy()(out[i], in[i]);
+            }
+        }
+        
+        //! Fold the blocks of all inputs into a block of output samples
+        void foldBlocks(const In* const* blocks, std::size_t count, const Out& constant, Out* out, std::size_t size) const
+        {
+            if constexpr (std::is_invocable<const Op&, const In* const*, std::size_t, const Out&, Out*, std::size_t>::value)
+            {
+                this->policy()(blocks, count, constant, out, size);
+            } else {
+                std::fill_n(out, size, constant);
+                for (std::size_t i = 0; i < count; ++i)
+                    foldBlock(out, blocks[i], size);
+            }
+        }
+        
+        //! Does the order of the inputs not matter?
+        bool isCommutative() const { return Op::commutative; }
+    };
+    
+    //! The operation of folds that override virtual functions to combine their inputs
+    template <class In, class Out>
+    class FoldOperation<In, Out, void> : public Signal<Out>
+    {
+    public:
+        using Signal<Out>::Signal;
+    
+    protected:
+        //! Return the initial value of the fold
+        /*! The initial value with which input samples will be combined.
+            For an addition fold this would be 0, because 0 + x = x.
+            For a multiplication fold this would be 1, because 1 * x = x */
+        virtual Out init() const = 0;
+        
+        //! Combine an input sample with an output state sample, effectively folding it in
+        /*! This funtion is called on each input, where the output is given as the first argument to the next call.
+            It 'accumulates' all input samples in a single sample of type Out. */
+        virtual Out fold(const Out& out, const In& in) const = 0;
+        
+        //! Reset an output sample to the initial value in place
+        /*! The default implementation assigns init(). Override it for outputs that own memory
+            (e.g. vectors), to reuse that memory instead of reallocating it every sample. */
+        virtual void reset(Out& out) const { out = init(); }
+        
+        //! Fold an input sample into an output sample in place
+        /*! The default implementation assigns the result of fold(). Override it for outputs that
+            own memory, to accumulate without copying the output for every input. */
+        virtual void accumulate(Out& out, const In& in) const { out = fold(out, in); }
+        
+        //! Fold a block of input samples into a block of output samples
+        /*! The default implementation calls accumulate() for each frame. Override it for a faster path. */
+        virtual void foldBlock(Out* out, const In* in, std::size_t size) const
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                accumulate(out[i], in[i]);
+        }
+        
+        //! Fold the blocks of all inputs of a commutative fold into a block of output samples
+        /*! The default implementation fills the output with the folded constant inputs and calls foldBlock()
+            for each block. Override it to fold all inputs at once (e.g. keeping the intermediate results in registers). */
+        virtual void foldBlocks(const In* const* blocks, std::size_t count, const Out& constant, Out* out, std::size_t size) const
+        {
+            std::fill_n(out, size, constant);
+            for (std::size_t i = 0; i < count; ++i)
+                foldBlock(out, blocks[i], size);
+        }
+        
+        //! Does the order of the inputs not matter?
+        /*! Constant inputs of commutative folds are merged into a single term by GraphOptimizer */
+        virtual bool isCommutative() const { return false; }
+    };
+    
     //! Folds a variadic amount of signals into one
     /*! Folds (a term coming from functional programming) form a big category of signals. They
         take multiple signals of the same type and fold them into a single output signal. Sum and
-        Product are good examples (they fold by applying + or * on each input signal). */
-    template <class In, class Out = In>
-    class Fold : public Signal<Out>
+        Product are good examples (they fold by applying + or * on each input signal).
+        
+        Without an operation policy (see FoldOperation), subclasses override init() and fold().
+        With one, the policy is inlined into the loops instead of being called per sample per input.
+        @code{cpp}
+        struct Maximum
+        {
+            static constexpr bool commutative = true;
+            float init() const { return -std::numeric_limits<float>::infinity(); }
+            void operator()(float& out, float in) const { out = std::max(out, in); }
+        };
+        
+        Fold<float, float, Maximum> maximum(&clock);
+        @endcode */
+    template <class In, class Out, class Op>
+    class Fold : public FoldOperation<In, Out, Op>
     {
     public:
         //! Construct an empty fold
-        using Signal<Out>::Signal;
+        using FoldOperation<In, Out, Op>::FoldOperation;
         
         //! Construct a fold with a given number of inputs
         Fold(Clock* clock, std::size_t size) :
-            Signal<Out>(clock)
+            FoldOperation<In, Out, Op>(clock)
         {
             resize(size);
         }
         
         //! Construct a fold with two terms
         Fold(Clock* clock, Value<In> lhs, Value<In> rhs) :
-            Signal<Out>(clock)
+            FoldOperation<In, Out, Op>(clock)
         {
             this->emplace(std::move(lhs));
             this->emplace(std::move(rhs));
@@ -76,6 +249,8 @@ namespace octo
         void emplace(Value<In> input)
         {
             inputs.emplace_back(std::make_unique<Value<In>>(std::move(input)));
+            blocks.reserve(inputs.size());
+            this->graphChanged();
         }
         
         //! Change the amount of inputs
@@ -86,6 +261,9 @@ namespace octo
             
             for (auto i = oldSize; i < size; ++i)
                 inputs[i] = std::make_unique<Value<In>>();
+            
+            blocks.reserve(inputs.size());
+            this->graphChanged();
         }
         
         //! Retrieve one of the inputs
@@ -94,30 +272,146 @@ namespace octo
         //! Return the number of inputs
         std::size_t getInputCount() const { return inputs.size(); }
         
+        // Inherited from SignalBase
+        std::size_t getHeapSize() const final override
+        {
+            return Signal<Out>::getHeapSize() + inputs.capacity() * sizeof(inputs[0]) + blocks.capacity() * sizeof(blocks[0]);
+        }
+        
+        std::vector<SignalBase*> getDependencies() final override
+        {
+            std::vector<SignalBase*> dependencies;
+            dependencies.reserve(inputs.size());
+            for (auto& input : inputs)
+                dependencies.emplace_back(input.get());
+            
+            return dependencies;
+        }
+    
+    protected:
+        //! Pull the blocks of all inputs that aren't constant, folding the constant ones into a single sample
+        /*! Only use this for folds of which the order of the inputs doesn't matter (e.g. Sum), because
+            the constants are folded before everything else.
+            @param constant Should be initialized with the initial value of the fold, accumulates all constant inputs
+            @return The blocks of the other inputs, valid until the next call */
+        const std::vector<const In*>& pullBlocks(std::size_t size, Out& constant)
+        {
+            if (merged)
+                constant = constantTerm;
+            
+            blocks.clear();
+            for (auto& input : inputs)
+            {
+                if (merged && input->isFolded())
+                    continue;
+                
+                if (auto sample = input->pullConstant())
+                    this->accumulate(constant, *sample);
+                else
+                    blocks.emplace_back(input->pullBlock(size));
+            }
+            
+            return blocks;
+        }
+    
     private:
         //! Generate a new sample
         void generateSample(Out& out) final override
         {
             if (inputs.empty())
+            {
                 out = {};
+                return;
+            }
+            
+            // Accumulate into the cache, so its capacity is reused across ticks
+            if (merged)
+                out = constantTerm;
             else
-                out = std::accumulate(inputs.begin(), inputs.end(), init(), [&](auto& a, auto& b){ return fold(a, (*b)()); });
+                this->reset(out);
+            
+            for (auto& input : inputs)
+            {
+                if (!merged || !input->isFolded())
+                    this->accumulate(out, (*input)());
+            }
         }
         
-        //! Return the initial value of the fold
-        /*! The initial value with which input samples will be combined.
-            For an addition fold this would be 0, because 0 + x = x.
-            For a multiplication fold this would be 1, because 1 * x = x */
-        virtual Out init() const = 0;
+        //! Merge the constant inputs into a single term
+        Signal<Out>* simplify() override
+        {
+            if (!this->isCommutative())
+                return nullptr;
+            
+            this->reset(constantTerm);
+            std::size_t count = 0;
+            Value<In>* varying = nullptr;
+            for (auto& input : inputs)
+            {
+                if (input->isFolded())
+                {
+                    this->accumulate(constantTerm, (*input)());
+                } else {
+                    varying = input.get();
+                    ++count;
+                }
+            }
+            
+            merged = true;
+            
+            // Pass a single input through if the constants cancel out (e.g. x + 0 or x * 1)
+            if constexpr (std::is_same<In, Out>::value && IsEqualityComparable<Out>::value)
+            {
+                if (count == 1 && constantTerm == this->init())
+                    return varying;
+            }
+            
+            return nullptr;
+        }
         
-        //! Combine an input sample with an output state sample, effectively folding it in
-        /*! This funtion is called on each input, where the output is given as the first argument to the next call.
-            It 'accumulates' all input samples in a single sample of type Out. */
-        virtual Out fold(const Out& out, const In& in) const = 0;
+        //! Stop merging constant inputs
+        void restore() override
+        {
+            merged = false;
+        }
         
+        //! Generate a new block of samples
+        void generateBlock(Out* out, std::size_t size) final override
+        {
+            if (inputs.empty())
+            {
+                std::fill_n(out, size, Out{});
+                return;
+            }
+            
+            if (this->isCommutative())
+            {
+                // Fold the constant terms beforehand, so they're broadcast instead of pulled as blocks
+                auto constant = this->init();
+                const auto& varying = pullBlocks(size, constant);
+                this->foldBlocks(varying.data(), varying.size(), constant, out, size);
+                return;
+            }
+            
+            for (std::size_t i = 0; i < size; ++i)
+                this->reset(out[i]);
+            
+            for (auto& input : inputs)
+                this->foldBlock(out, input->pullBlock(size), size);
+        }
+    
     private:
         //! The inputs to the fold
         std::vector<std::unique_ptr<Value<In>>> inputs;
+        
+        //! The blocks pulled by pullBlocks(), kept to reuse their memory
+        std::vector<const In*> blocks;
+        
+        //! Have the folded inputs been merged into constantTerm? (see simplify())
+        bool merged = false;
+        
+        //! The folded inputs, folded into the initial value
+        Out constantTerm = Out{};
     };
 }
 
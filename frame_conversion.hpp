@@ -0,0 +1,84 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_FRAME_CONVERSION_HPP
+#define OCTOPUS_FRAME_CONVERSION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "multi_channel_signal.hpp"
+#include "unary_operation.hpp"
+
+namespace octo
+{
+    //! Converts a fixed-channel multi-channel signal into a vector one
+    /*! For connecting multi-channel signals to graphs that use the std::vector idiom (e.g. Join and
+        Split). The vector keeps its capacity across samples, so converting doesn't allocate after
+        the first sample. */
+    template <class T, std::size_t N>
+    class FrameToVector : public UnaryOperation<Frame<T, N>, std::vector<T>>
+    {
+    public:
+        // Use the constructor from UnaryOperation
+        using UnaryOperation<Frame<T, N>, std::vector<T>>::UnaryOperation;
+        
+        GENERATE_MOVE(FrameToVector)
+    
+    private:
+        //! Convert a frame to a vector
+        void convertSample(const Frame<T, N>& in, std::vector<T>& out) final override
+        {
+            out.assign(in.begin(), in.end());
+        }
+    };
+    
+    //! Converts a vector multi-channel signal into a fixed-channel one
+    /*! Channels beyond N are dropped, missing channels output T{}. */
+    template <class T, std::size_t N>
+    class VectorToFrame : public UnaryOperation<std::vector<T>, Frame<T, N>>
+    {
+    public:
+        // Use the constructor from UnaryOperation
+        using UnaryOperation<std::vector<T>, Frame<T, N>>::UnaryOperation;
+        
+        GENERATE_MOVE(VectorToFrame)
+    
+    private:
+        //! Convert a vector to a frame
+        void convertSample(const std::vector<T>& in, Frame<T, N>& out) final override
+        {
+            const auto count = std::min(in.size(), N);
+            std::copy_n(in.begin(), count, out.begin());
+            std::fill(out.begin() + count, out.end(), T{});
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_FRAME_JOIN_HPP
+#define OCTOPUS_FRAME_JOIN_HPP
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "multi_channel_signal.hpp"
+#include "value.hpp"
+
+namespace octo
+{
+    //! Join a fixed number of signals into one multi-channel signal
+    /*! The fixed-channel counterpart of Join. Combines N signals of type T into a signal of
+        type Frame<T, N>, without allocating anything while running.
+        
+        @code{cpp}
+        FrameJoin<float, 2> stereo(clock, left, right);
+        @endcode */
+    template <class T, std::size_t N>
+    class FrameJoin : public MultiChannelSignal<T, N>
+    {
+    public:
+        //! Construct the join with constant inputs
+        FrameJoin(Clock* clock) :
+            MultiChannelSignal<T, N>(clock)
+        {
+        
+        }
+        
+        //! Construct the join by providing a signal or constant for every channel
+        template <class... Inputs, class = std::enable_if_t<sizeof...(Inputs) == N>>
+        FrameJoin(Clock* clock, Inputs&&... inputs) :
+            MultiChannelSignal<T, N>(clock)
+        {
+            std::size_t channel = 0;
+            ((this->inputs[channel++] = std::forward<Inputs>(inputs)), ...);
+        }
+        
+        //! Retrieve the input of a channel
+        Value<T>& operator[](std::size_t channel) { return inputs.at(channel); }
+        
+        // Inherited from SignalBase
+        std::vector<SignalBase*> getDependencies() final override
+        {
+            std::vector<SignalBase*> dependencies;
+            dependencies.reserve(N);
+            for (auto& input : inputs)
+                dependencies.emplace_back(&input);
+            
+            return dependencies;
+        }
+        
+        GENERATE_MOVE(FrameJoin)
+    
+    public:
+        //! The inputs, one for every channel
+        std::array<Value<T>, N> inputs;
+    
+    private:
+        //! Generate a new sample
+        void generateSample(Frame<T, N>& out) final override
+        {
+            for (std::size_t channel = 0; channel < N; ++channel)
+                out[channel] = inputs[channel]();
+        }
+        
+        //! Generate a new block of samples, interleaving the blocks of the inputs
+        /*! The blocks of the inputs are also forwarded as the planar channels, so pulling a planar
+            block doesn't copy them again. */
+        void generateBlock(Frame<T, N>* out, std::size_t size) final override
+        {
+            for (std::size_t channel = 0; channel < N; ++channel)
+            {
+                const auto in = inputs[channel].pullBlock(size);
+                for (std::size_t i = 0; i < size; ++i)
+                    out[i][channel] = in[i];
+                
+                this->forwardPlanar(channel, in, size);
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_FRAME_SIEVE_HPP
+#define OCTOPUS_FRAME_SIEVE_HPP
+
+#include <cstddef>
+
+#include "multi_channel_signal.hpp"
+#include "unary_operation.hpp"
+
+namespace octo
+{
+    //! Sifts out a single channel from a fixed-channel multi-channel signal
+    /*! The fixed-channel counterpart of Sieve. If you'd like to filter out all channels at once,
+        use a FrameSplit. */
+    template <class T, std::size_t N>
+    class FrameSieve : public UnaryOperation<Frame<T, N>, T>
+    {
+    public:
+        //! Create the sieve by passing the channel
+        FrameSieve(Clock* clock, std::size_t channel = 0, const T& initialCache = T{}) :
+            UnaryOperation<Frame<T, N>, T>(clock, initialCache),
+            channel(channel)
+        {
+        
+        }
+        
+        //! Create the sieve by passing the channel and input
+        FrameSieve(Clock* clock, Value<Frame<T, N>> input, std::size_t channel = 0) :
+            UnaryOperation<Frame<T, N>, T>(clock, std::move(input)),
+            channel(channel)
+        {
+        
+        }
+        
+        GENERATE_MOVE(FrameSieve)
+    
+    public:
+        //! The channel being sifted out
+        std::size_t channel = 0;
+    
+    private:
+        //! Generate the sifted out signal
+        void convertSample(const Frame<T, N>& in, T& out) final override
+        {
+            out = channel < N ? in[channel] : T{};
+        }
+        
+        //! Generate a block of sifted out samples
+        void convertBlock(const Frame<T, N>* in, T* out, std::size_t size) final override
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = channel < N ? in[i][channel] : T{};
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_FRAME_SPLIT_HPP
+#define OCTOPUS_FRAME_SPLIT_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+#include "frame_sieve.hpp"
+#include "value.hpp"
+
+namespace octo
+{
+    class Clock;
+    
+    //! Splits a fixed-channel multi-channel signal into single-channel ones
+    /*! The fixed-channel counterpart of Split. Every sieve reads its channel straight from the
+        frame of the input, so splitting doesn't copy frames. */
+    template <class T, std::size_t N>
+    class FrameSplit
+    {
+    public:
+        //! Construct the split
+        FrameSplit(Clock* clock)
+        {
+            for (std::size_t channel = 0; channel < N; ++channel)
+            {
+                sieves[channel] = std::make_unique<FrameSieve<T, N>>(clock, channel);
+                sieves[channel]->input = input;
+            }
+        }
+        
+        //! Construct the split by providing its input
+        FrameSplit(Clock* clock, Value<Frame<T, N>> input) :
+            FrameSplit(clock)
+        {
+            this->input = std::move(input);
+        }
+        
+        //! Retrieve the number of sieves in the split
+        static constexpr std::size_t size() { return N; }
+        
+        //! Retrieve one of the sieves
+        FrameSieve<T, N>& operator[](std::size_t channel) { return *sieves.at(channel); }
+        
+        //! Change the clock of all sieves
+        void setClock(Clock* clock)
+        {
+            for (auto& sieve : sieves)
+                sieve->setClock(clock);
+        }
+    
+    public:
+        //! The input to the split
+        Value<Frame<T, N>> input;
+    
+    private:
+        //! The sieves that make up this split
+        std::array<std::unique_ptr<FrameSieve<T, N>>, N> sieves;
+    };
+}
+
+#endif
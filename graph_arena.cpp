@@ -0,0 +1,87 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <cassert>
+#include <stdexcept>
+
+#include "graph_arena.hpp"
+
+namespace octo
+{
+    //! The resource signals are allocated from on this thread
+    static thread_local std::pmr::memory_resource* currentResource = nullptr;
+    
+    GraphArena::GraphArena(std::size_t initialSize, std::pmr::memory_resource* upstream) :
+        buffer(initialSize, upstream)
+    {
+    
+    }
+    
+    GraphArena::~GraphArena()
+    {
+        // Signals allocated from the arena should have been destroyed by now
+        assert(getLiveAllocationCount() == 0);
+    }
+    
+    void GraphArena::release()
+    {
+        if (getLiveAllocationCount() != 0)
+            throw std::runtime_error("cannot release a graph arena while its allocations are alive");
+        
+        buffer.release();
+    }
+    
+    std::pmr::memory_resource* GraphArena::getCurrentResource()
+    {
+        return currentResource;
+    }
+    
+    void* GraphArena::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        auto address = buffer.allocate(bytes, alignment);
+        liveAllocations.fetch_add(1, std::memory_order_relaxed);
+        return address;
+    }
+    
+    void GraphArena::do_deallocate(void* address, std::size_t bytes, std::size_t alignment)
+    {
+        // Monotonic memory is only reclaimed when the arena is released
+        liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+    }
+    
+    GraphArena::Scope::Scope(std::pmr::memory_resource& resource) :
+        previous(currentResource)
+    {
+        currentResource = &resource;
+    }
+    
+    GraphArena::Scope::~Scope()
+    {
+        currentResource = previous;
+    }
+}
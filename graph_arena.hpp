@@ -0,0 +1,118 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_GRAPH_ARENA_HPP
+#define OCTOPUS_GRAPH_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+
+namespace octo
+{
+    //! A memory resource from which graphs can be allocated
+    /*! Signals that are created on the heap (e.g. through moveToHeap() when building an expression,
+        or by Fold for its inputs) are normally allocated one by one. Inside a GraphArena::Scope they
+        are allocated from a memory resource instead. GraphArena is a bump allocator: allocating is a
+        pointer increment, and nodes are laid out in the order in which they're built (which, for
+        expressions, is the order in which they're evaluated).
+        
+        @code
+        GraphArena arena;
+        {
+            GraphArena::Scope scope(arena);
+            oscillator.frequency = 440.0f + 100.0f * Sine(&audio, 0.5f);
+        }
+        @endcode
+        
+        Memory is only reclaimed when the arena is released or destroyed, so the arena has to outlive
+        every signal allocated from it. Freeing a signal allocated from an arena never calls into the
+        upstream allocator, which also makes it safe to destroy such signals on a real-time thread. */
+    class GraphArena : public std::pmr::memory_resource
+    {
+    public:
+        class Scope;
+    
+    public:
+        //! Construct the arena
+        /*! @param initialSize The size of the first chunk requested from upstream (later chunks grow geometrically)
+            @param upstream The memory resource the chunks are requested from */
+        GraphArena(std::size_t initialSize = 64 * 1024, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+        
+        GraphArena(const GraphArena&) = delete;
+        GraphArena& operator=(const GraphArena&) = delete;
+        
+        //! Destruct the arena and return its memory upstream
+        ~GraphArena();
+        
+        //! Return all memory upstream
+        /*! @throw std::runtime_error if allocations from the arena are still alive */
+        void release();
+        
+        //! Return the number of allocations from the arena that haven't been deallocated yet
+        std::size_t getLiveAllocationCount() const { return liveAllocations.load(std::memory_order_relaxed); }
+        
+        //! Return the memory resource new signals are allocated from on this thread
+        /*! @return nullptr if there's no scope active, in which case signals are allocated with the global operator new */
+        static std::pmr::memory_resource* getCurrentResource();
+    
+    private:
+        // Inherited from std::pmr::memory_resource
+        void* do_allocate(std::size_t bytes, std::size_t alignment) final override;
+        void do_deallocate(void* address, std::size_t bytes, std::size_t alignment) final override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept final override { return this == &other; }
+    
+    private:
+        //! The buffer the arena bumps through
+        std::pmr::monotonic_buffer_resource buffer;
+        
+        //! The number of allocations that haven't been deallocated yet
+        std::atomic<std::size_t> liveAllocations{0};
+    };
+    
+    //! Allocates signals from a memory resource on the current thread, as long as the scope lives
+    /*! Scopes can be nested, in which case the innermost one is used. */
+    class GraphArena::Scope
+    {
+    public:
+        //! Start allocating signals from a memory resource (usually a GraphArena)
+        Scope(std::pmr::memory_resource& resource);
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        
+        //! Restore the previous resource
+        ~Scope();
+    
+    private:
+        //! The resource that was used before this scope
+        std::pmr::memory_resource* previous = nullptr;
+    };
+}
+
+#endif /* OCTOPUS_GRAPH_ARENA_HPP */
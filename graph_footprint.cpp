@@ -0,0 +1,84 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+#include "clock.hpp"
+#include "graph_footprint.hpp"
+#include "signal_base.hpp"
+
+namespace octo
+{
+    GraphFootprint GraphFootprint::measure(const Clock& clock)
+    {
+        std::vector<SignalBase*> signals;
+        std::unordered_set<SignalBase*> visited;
+        
+        // Gather every signal reachable from the persistent sinks
+        for (auto& root : clock.getPersistentSinks())
+        {
+            auto signal = dynamic_cast<SignalBase*>(root);
+            if (signal && visited.emplace(signal).second)
+                signals.emplace_back(signal);
+        }
+        
+        for (std::size_t i = 0; i < signals.size(); ++i)
+        {
+            for (auto& dependency : signals[i]->getDependencies())
+            {
+                if (visited.emplace(dependency).second)
+                    signals.emplace_back(dependency);
+            }
+        }
+        
+        // Walk the signals by address, so that signals embedded in others come right after them
+        auto start = [](SignalBase* signal){ return static_cast<const char*>(dynamic_cast<const void*>(signal)); };
+        std::sort(signals.begin(), signals.end(), [&](SignalBase* lhs, SignalBase* rhs){ return start(lhs) < start(rhs); });
+        
+        GraphFootprint footprint;
+        footprint.signalCount = signals.size();
+        
+        const char* end = nullptr;
+        for (auto& signal : signals)
+        {
+            footprint.heapByteCount += signal->getHeapSize();
+            if (start(signal) >= end)
+            {
+                footprint.byteCount += signal->getSize();
+                end = start(signal) + signal->getSize();
+            } else {
+                end = std::max(end, start(signal) + signal->getSize());
+            }
+        }
+        
+        footprint.byteCount += footprint.heapByteCount;
+        return footprint;
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_GRAPH_FOOTPRINT_HPP
+#define OCTOPUS_GRAPH_FOOTPRINT_HPP
+
+#include <cstddef>
+
+namespace octo
+{
+    class Clock;
+    
+    //! The memory occupied by a graph
+    /*! Large graphs are mostly bound by memory, so it pays to know how much of it every node takes:
+        @code
+        const auto footprint = GraphFootprint::measure(audio);
+        std::cout << footprint.signalCount << " signals, " << footprint.getBytesPerSignal() << " bytes each\n";
+        @endcode
+        
+        Signals embedded in other signals (e.g. a Value member of an operation) are counted as signals,
+        but their size is only counted once, as part of the signal containing them. Signals that aren't
+        reported as dependencies (see SignalBase::getDependencies()) are missed. Measure the graph from
+        the thread ticking it, or while it isn't ticking. */
+    struct GraphFootprint
+    {
+        //! Measure the graph pulled by the persistent sinks of a clock, including signals at other clocks
+        static GraphFootprint measure(const Clock& clock);
+        
+        //! Return the average number of bytes per signal
+        double getBytesPerSignal() const { return signalCount ? static_cast<double>(byteCount) / signalCount : 0; }
+        
+        //! The number of signals in the graph
+        std::size_t signalCount = 0;
+        
+        //! The number of bytes the signals occupy, including the memory they own on the heap
+        std::size_t byteCount = 0;
+        
+        //! The part of byteCount the signals own on the heap
+        /*! This includes the state signals only allocate once needed (block caches and the state of
+            incremental mode and pass-throughs, see Signal) and the states published by Values. */
+        std::size_t heapByteCount = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+
+#include "execution_plan.hpp"
+#include "graph_optimizer.hpp"
+#include "signal_base.hpp"
+
+namespace octo
+{
+    void GraphOptimizer::optimize(ExecutionPlan& plan)
+    {
+        // Start from scratch, so that signals in feedback loops don't see stale optimizations
+        deoptimize(plan);
+        
+        for (auto& node : plan.signals)
+        {
+            const auto& dependencies = node.dependencies;
+            node.signal->optimize(std::all_of(dependencies.begin(), dependencies.end(), [](SignalBase* dependency){ return dependency->isFolded(); }));
+        }
+        
+        share(plan);
+    }
+    
+    void GraphOptimizer::deoptimize(const ExecutionPlan& plan)
+    {
+        for (auto& node : plan.signals)
+            node.signal->deoptimize();
+    }
+    
+    void GraphOptimizer::reserve(ExecutionPlan& plan)
+    {
+        // Keep the hash table at most half full, so that probes stay short
+        std::size_t capacity = 1;
+        while (capacity < plan.signals.size() * 2)
+            capacity *= 2;
+        
+        plan.candidates.resize(capacity);
+        
+        std::size_t inputs = 0;
+        for (auto& node : plan.signals)
+            inputs += node.dependencies.size();
+        
+        plan.inputs.reserve(inputs);
+    }
+    
+    void GraphOptimizer::share(ExecutionPlan& plan)
+    {
+        // Signals are hashed by operation and resolved inputs, so only identical signals (and rare collisions)
+        // are compared. The hash table probes linearly, and its memory comes with the plan (see reserve()).
+        auto& candidates = plan.candidates;
+        auto& inputs = plan.inputs;
+        std::fill(candidates.begin(), candidates.end(), ExecutionPlan::Candidate{});
+        inputs.clear();
+        
+        const auto mask = candidates.size() - 1;
+        for (std::size_t i = 0; i < plan.signals.size(); ++i)
+        {
+            auto signal = plan.signals[i].signal;
+            if (!signal->isPure() || signal->folded || signal->passThrough)
+                continue;
+            
+            // Resolve the inputs at the back of the list, where they stay if the signal becomes a candidate
+            const auto& dependencies = plan.signals[i].dependencies;
+            const auto begin = inputs.size();
+            auto key = signal->hashOperation();
+            for (auto& dependency : dependencies)
+            {
+                auto input = resolve(dependency);
+                key = SignalBase::combineHashes(key, input->isFolded() ? input->hashConstant() : std::hash<SignalBase*>()(input));
+                inputs.emplace_back(input);
+            }
+            
+            SignalBase* match = nullptr;
+            auto slot = key & mask;
+            for (; candidates[slot].node != 0 && !match; slot = (slot + 1) & mask)
+            {
+                auto& candidate = candidates[slot];
+                auto& other = plan.signals[candidate.node - 1];
+                if (candidate.key != key || other.dependencies.size() != dependencies.size() || !other.signal->isSameOperation(*signal))
+                    continue;
+                
+                bool same = true;
+                for (std::size_t j = 0; j < dependencies.size() && same; ++j)
+                {
+                    auto lhs = inputs[candidate.begin + j];
+                    auto rhs = inputs[begin + j];
+                    same = (lhs == rhs) || lhs->hasSameConstant(*rhs);
+                }
+                
+                if (same)
+                    match = other.signal;
+            }
+            
+            if (match)
+            {
+                signal->passThrough = match;
+                inputs.resize(begin);
+            } else {
+                candidates[slot] = {key, i + 1, begin};
+            }
+        }
+    }
+    
+    SignalBase* GraphOptimizer::resolve(SignalBase* signal)
+    {
+        // Follow values and pass-throughs, giving up on chains that loop
+        for (auto i = 0; i < 64; ++i)
+        {
+            auto next = signal->pullRelayed();
+            if (next == signal)
+                next = signal->passThrough ? signal->passThrough : signal;
+            
+            if (next == signal)
+                break;
+            
+            signal = next;
+        }
+        
+        return signal;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_GRAPH_OPTIMIZER_HPP
+#define OCTOPUS_GRAPH_OPTIMIZER_HPP
+
+namespace octo
+{
+    class ExecutionPlan;
+    class SignalBase;
+    
+    //! Simplifies graphs without changing their output
+    /*! Patches tend to be full of constants, which would otherwise be recomputed every tick. The
+        optimizer walks a graph dependencies first and lets every signal optimize itself:
+        - Pure signals (see SignalBase::isPure()) of which all dependencies are constant are folded
+          into a constant, computed once. Values set to a constant are folded as well.
+        - Commutative folds (e.g. Sum and Product) merge their constant inputs into a single term.
+        - Identities are removed by passing an input through unchanged (x + 0, x * 1, x - 0, x / 1 and -(-x)).
+        - Common subexpressions are shared. A pure signal performing the same operation on the same inputs
+          as another one (see SignalBase::isSameOperation()) passes that signal through, so that it's only
+          computed once per tick.
+        
+        The structure of the graph is left intact, so optimizations can be undone or redone at any time.
+        Whenever a Value is reassigned (e.g. switching from a constant to a signal), the graph has to be
+        reoptimized. Clocks do this automatically (see Clock::setOptimized()). The optimizer works on the
+        signals of an execution plan (see GraphCompiler). It pulls the signals it folds, so it should be
+        run on the thread ticking the graph, but it doesn't allocate. */
+    class GraphOptimizer
+    {
+    public:
+        //! Optimize the signals of an execution plan
+        /*! Signals running at other clocks aren't in the plan, and are left alone. */
+        static void optimize(ExecutionPlan& plan);
+        
+        //! Undo the optimizations of the signals of an execution plan
+        static void deoptimize(const ExecutionPlan& plan);
+        
+        //! Allocate the memory optimize() needs along with a plan (called by GraphCompiler)
+        static void reserve(ExecutionPlan& plan);
+    
+    private:
+        //! Let signals computing the same as a signal before them pass that one through
+        static void share(ExecutionPlan& plan);
+        
+        //! Return the signal that actually produces the output of another one
+        static SignalBase* resolve(SignalBase* signal);
+    };
+}
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_INTERPOLATING_BRIDGE_HPP
+#define OCTOPUS_INTERPOLATING_BRIDGE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "bridge.hpp"
+#include "clock.hpp"
+
+namespace octo
+{
+    //! A sample, stamped with the time at which it was produced
+    template <class T>
+    struct TimedSample
+    {
+        //! The sample
+        T value;
+        
+        //! The time at which the sample was produced
+        std::chrono::steady_clock::time_point time;
+    };
+    
+    //! Bridges samples from one clock domain to another, interpolating between them
+    /*! Samples are stamped with the time at which they are produced. When the bridge updates, it
+        linearly interpolates between the two samples surrounding the current time minus a delay. The
+        delay should be at least one period of the producer clock, so that the next sample has usually
+        arrived by the time it is needed. Use it to upsample slow control data, like a 60 Hz motion
+        sensor driving a 48 kHz filter, without audible steps.
+        
+        T needs to support addition, subtraction and multiplication by a float. */
+    template <class T>
+    class InterpolatingBridge : public Bridge<T, TimedSample<T>>
+    {
+    public:
+        //! Construct the bridge
+        /*! The delay defaults to twice the current delta of the producer clock */
+        InterpolatingBridge(Clock* producer, Clock* consumer, std::size_t capacity = 64, const T& initialCache = T{}) :
+            Bridge<T, TimedSample<T>>(producer, consumer, capacity, initialCache),
+            previous{initialCache, {}},
+            next{initialCache, {}}
+        {
+            setDelay(2 * producer->delta());
+        }
+        
+        GENERATE_MOVE(InterpolatingBridge)
+        
+        //! Change the delay (in seconds) with which samples are rendered
+        void setDelay(float seconds) { delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(seconds)); }
+        
+        //! Return the delay (in seconds) with which samples are rendered
+        float getDelay() const { return std::chrono::duration<float>(delay).count(); }
+    
+    private:
+        // Inherited from Bridge
+        TimedSample<T> makeEntry(const T& sample) final override { return {sample, std::chrono::steady_clock::now()}; }
+        
+        //! Interpolate between the samples surrounding the delayed current time
+        void generateSample(T& out) final override
+        {
+            const auto time = getRenderTime() - delay;
+            
+            // Move forward until the next sample lies beyond the time being rendered
+            auto& ring = this->getRing();
+            while (next.time < time)
+            {
+                auto front = ring.front();
+                if (!front)
+                    break;
+                
+                previous = std::move(next);
+                next = std::move(*front);
+                ring.pop();
+            }
+            
+            // Hold the last sample if the producer is late, or the first if we're early
+            if (next.time <= time)
+                out = next.value;
+            else if (time <= previous.time)
+                out = previous.value;
+            else
+                out = previous.value + (next.value - previous.value) * getPosition(time);
+        }
+        
+        //! Return the time at which the frame being rendered is due
+        /*! The time is read once per tick of the consumer clock, for the first frame rendered in it. The
+            frames after it (e.g. those of a block, see Clock::tick(std::size_t)) follow one delta apart. */
+        std::chrono::steady_clock::time_point getRenderTime()
+        {
+            auto clock = this->getClock();
+            if (!clock)
+                return std::chrono::steady_clock::now();
+            
+            if (!anchored || clock->now() != anchorTick)
+            {
+                anchored = true;
+                anchorTick = clock->now();
+                anchorFrame = clock->renderTime();
+                anchorTime = std::chrono::steady_clock::now();
+            }
+            
+            const auto frames = static_cast<int64_t>(clock->renderTime() - anchorFrame);
+            return anchorTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(frames * clock->delta()));
+        }
+        
+        //! Return the position of a time between the previous and next sample (0 to 1)
+        float getPosition(std::chrono::steady_clock::time_point time) const
+        {
+            return std::chrono::duration<float>(time - previous.time) / std::chrono::duration<float>(next.time - previous.time);
+        }
+    
+    private:
+        //! The delay with which samples are rendered
+        std::chrono::steady_clock::duration delay;
+        
+        //! The sample before the time being rendered
+        TimedSample<T> previous;
+        
+        //! The sample after the time being rendered
+        TimedSample<T> next;
+        
+        //! Has the time of a frame been read yet? (see getRenderTime())
+        bool anchored = false;
+        
+        //! The time index of the consumer clock when the time was last read
+        uint64_t anchorTick = 0;
+        
+        //! The render time of the frame for which the time was last read
+        uint64_t anchorFrame = 0;
+        
+        //! The time that was last read
+        std::chrono::steady_clock::time_point anchorTime;
+    };
+}
+
+#endif
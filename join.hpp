@@ -62,6 +62,9 @@ namespace octo
         // Generate the move function
         GENERATE_MOVE(Join)
         
+        // Inherited from SignalBase
+        bool isPure() const final override { return true; }
+    
     private:
         //! Return the monoid identity
         std::vector<T> init() const final override { return {}; }
@@ -73,39 +76,45 @@ namespace octo
             y.emplace_back(x);
             return y;
         }
+        
+        //! Clear the channels, keeping the capacity of the vector
+        void reset(std::vector<T>& out) const final override { out.clear(); }
+        
+        //! Append a channel in place
+        void accumulate(std::vector<T>& out, const T& x) const final override { out.emplace_back(x); }
     };
     
     //! Combine a scalar and a signal into a join
     template <class T1, class T2>
-    std::enable_if_t<std::is_convertible<T1, T2>::value, Join<T2>> operator&(const T1& lhs, Signal<T2>& rhs) { return {lhs, rhs}; }
+    std::enable_if_t<std::is_convertible<T1, T2>::value, Join<T2>> operator&(const T1& lhs, Signal<T2>& rhs) { return {rhs.getClock(), lhs, rhs}; }
     
     //! Combine a scalar and a signal into a join
     template <class T1, class T2>
-    std::enable_if_t<std::is_convertible<T1, T2>::value, Join<T2>> operator&(const T1& lhs, Signal<T2>&& rhs) { return {lhs, std::move(rhs).moveToHeap()}; }
+    std::enable_if_t<std::is_convertible<T1, T2>::value, Join<T2>> operator&(const T1& lhs, Signal<T2>&& rhs) { return {rhs.getClock(), lhs, std::move(rhs)}; }
     
     //! Combine a scalar and a signal into a join
     template <class T1, class T2>
-    std::enable_if_t<std::is_convertible<T2, T1>::value, Join<T1>> operator&(Signal<T1>& lhs, const T2& rhs) { return {lhs, rhs}; }
+    std::enable_if_t<std::is_convertible<T2, T1>::value, Join<T1>> operator&(Signal<T1>& lhs, const T2& rhs) { return {lhs.getClock(), lhs, rhs}; }
     
     //! Combine two signals into a join
     template <class T1, class T2>
-    Join<std::common_type_t<T1, T2>> operator&(Signal<T1>& lhs, Signal<T2>& rhs) { return {lhs, rhs}; }
+    Join<std::common_type_t<T1, T2>> operator&(Signal<T1>& lhs, Signal<T2>& rhs) { return {lhs.getClock(), lhs, rhs}; }
     
     //! Combine two signals into a join
     template <class T1, class T2>
-    Join<std::common_type_t<T1, T2>> operator&(Signal<T1>& lhs, Signal<T2>&& rhs) { return {lhs, std::move(rhs).moveToHeap()}; }
+    Join<std::common_type_t<T1, T2>> operator&(Signal<T1>& lhs, Signal<T2>&& rhs) { return {lhs.getClock(), lhs, std::move(rhs)}; }
     
     //! Combine a scalar and a signal into a join
     template <class T1, class T2>
-    std::enable_if_t<std::is_convertible<T2, T1>::value, Join<T1>> operator&(Signal<T1>&& lhs, const T2& rhs) { return {std::move(lhs).moveToHeap(), rhs}; }
+    std::enable_if_t<std::is_convertible<T2, T1>::value, Join<T1>> operator&(Signal<T1>&& lhs, const T2& rhs) { return {lhs.getClock(), std::move(lhs), rhs}; }
     
     //! Combine two signals into a join
     template <class T1, class T2>
-    Join<std::common_type_t<T1, T2>> operator&(Signal<T1>&& lhs, Signal<T2>& rhs) { return {std::move(lhs).moveToHeap(), rhs}; }
+    Join<std::common_type_t<T1, T2>> operator&(Signal<T1>&& lhs, Signal<T2>& rhs) { return {lhs.getClock(), std::move(lhs), rhs}; }
     
     //! Combine two signals into a join
     template <class T1, class T2>
-    Join<std::common_type_t<T1, T2>> operator&(Signal<T1>&& lhs, Signal<T2>&& rhs) { return {std::move(lhs).moveToHeap(), std::move(rhs).moveToHeap()}; }
+    Join<std::common_type_t<T1, T2>> operator&(Signal<T1>&& lhs, Signal<T2>&& rhs) { return {lhs.getClock(), std::move(lhs), std::move(rhs)}; }
     
     //! Add another term to a join
     template <class T1, class T2>
@@ -0,0 +1,137 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "latency_histogram.hpp"
+
+namespace octo
+{
+    //! Return the position of the highest bit set in a non-zero number
+    static std::size_t getExponent(uint64_t number)
+    {
+    #if defined(__GNUC__)
+        return 63 - __builtin_clzll(number);
+    #else
+        std::size_t exponent = 0;
+        while (number >>= 1)
+            ++exponent;
+        
+        return exponent;
+    #endif
+    }
+    
+    LatencyHistogram::LatencyHistogram()
+    {
+        for (auto& bucket : counts)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+    
+    void LatencyHistogram::record(uint64_t nanoseconds)
+    {
+        counts[getBucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+        
+        auto longest = maximum.load(std::memory_order_relaxed);
+        while (nanoseconds > longest && !maximum.compare_exchange_weak(longest, nanoseconds, std::memory_order_relaxed));
+    }
+    
+    LatencyHistogram::Snapshot LatencyHistogram::getSnapshot() const
+    {
+        Snapshot snapshot;
+        snapshot.sum = sum.load(std::memory_order_relaxed);
+        snapshot.maximum = maximum.load(std::memory_order_relaxed);
+        
+        // The count is summed from the copied buckets, so it matches them even while durations are being recorded
+        for (std::size_t i = 0; i < bucketCount; ++i)
+        {
+            snapshot.counts[i] = counts[i].load(std::memory_order_relaxed);
+            snapshot.count += snapshot.counts[i];
+        }
+        
+        return snapshot;
+    }
+    
+    void LatencyHistogram::reset()
+    {
+        sum.store(0, std::memory_order_relaxed);
+        maximum.store(0, std::memory_order_relaxed);
+        for (auto& bucket : counts)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+    
+    std::size_t LatencyHistogram::getBucketIndex(uint64_t nanoseconds)
+    {
+        // The first buckets count a single duration each
+        if (nanoseconds < subBucketCount)
+            return nanoseconds;
+        
+        // The others count a range of durations, subBucketBits significant bits wide
+        const auto exponent = getExponent(nanoseconds);
+        if (exponent > maximumExponent)
+            return bucketCount - 1;
+        
+        const auto mantissa = static_cast<std::size_t>(nanoseconds >> (exponent - subBucketBits));
+        return (exponent - subBucketBits + 1) * subBucketCount + (mantissa - subBucketCount);
+    }
+    
+    uint64_t LatencyHistogram::getBucketLowerBound(std::size_t index)
+    {
+        if (index < subBucketCount)
+            return index;
+        
+        const auto exponent = index / subBucketCount + subBucketBits - 1;
+        const auto mantissa = index % subBucketCount + subBucketCount;
+        return static_cast<uint64_t>(mantissa) << (exponent - subBucketBits);
+    }
+    
+    uint64_t LatencyHistogram::getBucketUpperBound(std::size_t index)
+    {
+        return index + 1 < bucketCount ? getBucketLowerBound(index + 1) - 1 : UINT64_MAX;
+    }
+    
+    uint64_t LatencyHistogram::Snapshot::getQuantile(double quantile) const
+    {
+        if (count == 0)
+            return 0;
+        
+        // The rank of the duration looked for, counting from 1
+        const auto rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * count)), 1);
+        
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < bucketCount; ++i)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+                return std::min(getBucketUpperBound(i), maximum);
+        }
+        
+        return maximum;
+    }
+}
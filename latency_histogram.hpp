@@ -0,0 +1,137 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_LATENCY_HISTOGRAM_HPP
+#define OCTOPUS_LATENCY_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace octo
+{
+    //! Counts durations in a fixed amount of memory, with a bounded relative error
+    /*! Like an HDR histogram, buckets grow exponentially (one group of 32 buckets per power of two
+        nanoseconds), so every duration lands in a bucket no wider than about 3% of the duration. Durations
+        up to 2^36 nanoseconds (about a minute) are told apart, longer ones end up in the last bucket.
+        
+        Recording is wait-free and never allocates, so it can be done from a real-time thread. Snapshots
+        can be taken from any other thread at the same time, without blocking the recording one. */
+    class LatencyHistogram
+    {
+    public:
+        class Snapshot;
+        
+        //! The number of bits of precision per power of two
+        static constexpr std::size_t subBucketBits = 5;
+        
+        //! The number of buckets per power of two
+        static constexpr std::size_t subBucketCount = std::size_t(1) << subBucketBits;
+        
+        //! The largest power of two told apart
+        static constexpr std::size_t maximumExponent = 36;
+        
+        //! The total number of buckets, including the last one counting everything longer
+        static constexpr std::size_t bucketCount = (maximumExponent - subBucketBits + 2) * subBucketCount + 1;
+    
+    public:
+        //! Construct an empty histogram
+        LatencyHistogram();
+        
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+        
+        //! Count a duration
+        void record(uint64_t nanoseconds);
+        
+        //! Copy the counts, for reading them while recording continues
+        Snapshot getSnapshot() const;
+        
+        //! Clear the counts
+        /*! Durations recorded at the same time may be kept or dropped. */
+        void reset();
+        
+        //! Return the index of the bucket counting a duration
+        static std::size_t getBucketIndex(uint64_t nanoseconds);
+        
+        //! Return the smallest duration counted by a bucket
+        static uint64_t getBucketLowerBound(std::size_t index);
+        
+        //! Return the largest duration counted by a bucket
+        static uint64_t getBucketUpperBound(std::size_t index);
+    
+    private:
+        //! The number of durations per bucket
+        std::array<std::atomic<uint64_t>, bucketCount> counts;
+        
+        //! The sum of all durations recorded
+        std::atomic<uint64_t> sum{0};
+        
+        //! The longest duration recorded
+        std::atomic<uint64_t> maximum{0};
+    };
+    
+    //! A copy of the counts of a histogram at some point in time
+    class LatencyHistogram::Snapshot
+    {
+        friend class LatencyHistogram;
+    
+    public:
+        //! Return the number of durations
+        uint64_t getCount() const { return count; }
+        
+        //! Return the longest duration (in nanoseconds)
+        uint64_t getMaximum() const { return maximum; }
+        
+        //! Return the average duration (in nanoseconds)
+        double getMean() const { return count ? static_cast<double>(sum) / count : 0; }
+        
+        //! Return the duration that a fraction of all durations doesn't exceed (in nanoseconds)
+        /*! @param quantile The fraction, between 0 and 1 (e.g. 0.99 for the 99th percentile) */
+        uint64_t getQuantile(double quantile) const;
+        
+        //! Return the number of durations per bucket (see LatencyHistogram::getBucketIndex())
+        const std::array<uint64_t, bucketCount>& getCounts() const { return counts; }
+    
+    private:
+        //! The number of durations per bucket
+        std::array<uint64_t, bucketCount> counts = {};
+        
+        //! The number of durations
+        uint64_t count = 0;
+        
+        //! The sum of all durations
+        uint64_t sum = 0;
+        
+        //! The longest duration
+        uint64_t maximum = 0;
+    };
+}
+
+#endif
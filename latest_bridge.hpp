@@ -0,0 +1,77 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_LATEST_BRIDGE_HPP
+#define OCTOPUS_LATEST_BRIDGE_HPP
+
+#include <cstddef>
+
+#include "bridge.hpp"
+
+namespace octo
+{
+    //! Bridges the most recent sample from one clock domain to another
+    /*! Every time the bridge updates, it skips to the newest sample that has been produced since,
+        and holds on to it until a newer one arrives. Use it for control data that only needs to
+        be current, like passing a video frame's brightness to an audio synthesizer. */
+    template <class T>
+    class LatestBridge : public Bridge<T>
+    {
+    public:
+        //! Construct the bridge
+        /*! @param capacity The number of samples the producer can run ahead before samples are dropped */
+        LatestBridge(Clock* producer, Clock* consumer, std::size_t capacity = 64, const T& initialCache = T{}) :
+            Bridge<T>(producer, consumer, capacity, initialCache),
+            latest(initialCache)
+        {
+        
+        }
+        
+        GENERATE_MOVE(LatestBridge)
+    
+    private:
+        // Inherited from Bridge
+        T makeEntry(const T& sample) final override { return sample; }
+        
+        //! Skip to the most recent sample
+        void generateSample(T& out) final override
+        {
+            auto& ring = this->getRing();
+            while (ring.pop(latest))
+                ;
+            
+            out = latest;
+        }
+    
+    private:
+        //! The most recent sample
+        T latest;
+    };
+}
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_MAP_HPP
+#define OCTOPUS_MAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "signal.hpp"
+#include "value.hpp"
+
+namespace octo
+{
+    //! Applies a function to each sample of an input signal
+    /*! Unlike subclasses of UnaryOperation, the function isn't called through a virtual function, so the
+        compiler can inline it into the per-sample and per-block loops. Maps are easiest created using map()
+        @code{cpp}
+        auto squared = map(sine, [](float x){ return x * x; });
+        @endcode */
+    template <class F, class In, class Out = std::decay_t<std::invoke_result_t<F&, const In&>>>
+    class Map : public Signal<Out>
+    {
+    public:
+        //! Construct the map with its input and the function to apply
+        Map(Clock* clock, Value<In> input, F function) :
+            Signal<Out>(clock),
+            input(std::move(input)),
+            function(std::move(function))
+        {
+        
+        }
+        
+        GENERATE_MOVE(Map)
+        
+        // Inherited from SignalBase
+        std::vector<SignalBase*> getDependencies() final override { return {&input}; }
+        bool isPure() const final override { return pure; }
+        
+        //! Maps with state in their function (e.g. lambda captures) are never shared
+        bool isSameOperation(const SignalBase& other) const final override
+        {
+            return std::is_empty<F>::value && SignalBase::isSameOperation(other);
+        }
+    
+    public:
+        //! The input to the map
+        Value<In> input;
+        
+        //! Does the function only depend on its input?
+        /*! Pure maps are folded, shared and skipped like the built-in operations (see SignalBase::isPure()) */
+        bool pure = false;
+    
+    private:
+        //! Generate a new sample
+        void generateSample(Out& out) final override
+        {
+            out = function(input());
+        }
+        
+        //! Generate a new block of samples
+        void generateBlock(Out* out, std::size_t size) final override
+        {
+            if (size == 0)
+                return;
+            
+            // A constant is mapped once by pure functions, instead of being broadcast into a block first
+            // (impure functions may return something else each call, so they're called for every frame)
+            if (auto constant = input.pullConstant())
+            {
+                if (pure)
+                {
+                    out[0] = function(*constant);
+                    std::fill_n(out + 1, size - 1, out[0]);
+                } else {
+                    for (std::size_t i = 0; i < size; ++i)
+                        out[i] = function(*constant);
+                }
+                
+                return;
+            }
+            
+            const auto in = input.pullBlock(size);
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = function(in[i]);
+        }
+    
+    private:
+        //! The function applied to each sample
+        F function;
+    };
+    
+    //! Apply a function to each sample of a signal
+    template <class In, class F>
+    Map<std::decay_t<F>, In> map(Signal<In>& input, F&& function)
+    {
+        return {input.getClock(), input, std::forward<F>(function)};
+    }
+    
+    //! Apply a function to each sample of a signal
+    template <class In, class F>
+    Map<std::decay_t<F>, In> map(Signal<In>&& input, F&& function)
+    {
+        return {input.getClock(), std::move(input), std::forward<F>(function)};
+    }
+}
+
+#endif
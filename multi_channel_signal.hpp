@@ -0,0 +1,194 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_MULTI_CHANNEL_SIGNAL_HPP
+#define OCTOPUS_MULTI_CHANNEL_SIGNAL_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "clock.hpp"
+#include "signal.hpp"
+
+namespace octo
+{
+    //! A frame of a multi-channel signal with a fixed number of channels
+    template <class T, std::size_t N>
+    using Frame = std::array<T, N>;
+    
+    //! A multi-channel signal with a fixed number of channels
+    /*! Signals with a vector type are the common idiom within Octopus for representing
+        multi-channel signals, but they allocate their frames on the heap and can change their
+        number of channels at any time. Multi-channel signals output Frame objects instead, which
+        live in place.
+        
+        Blocks of multi-channel signals are interleaved (an array of frames), like those of any other
+        signal. For consumers that process channels separately (e.g. an audio API expecting one buffer
+        per channel), they can also be pulled as planar views, with one contiguous buffer per channel.
+        FrameSieve and FrameSplit read their channel straight from the interleaved frames. */
+    template <class T, std::size_t N>
+    class MultiChannelSignal : public Signal<Frame<T, N>>
+    {
+    public:
+        //! The number of channels
+        static constexpr std::size_t channelCount = N;
+    
+    public:
+        using Signal<Frame<T, N>>::Signal;
+        
+        //! Retrieve a planar view of a block of consecutive samples, starting at the clock's current render time
+        /*! The block is pulled with pullBlock(), so it's rendered, cached and reused the same way. Its
+            channels are then deinterleaved into one buffer each, unless they were forwarded while it was
+            rendered (see forwardPlanar()). Pulling the same block again doesn't deinterleave it twice.
+            @return A pointer to size samples for each channel. Copy and be done with it, this could change with the next block */
+        const std::array<const T*, N>& pullPlanar(std::size_t size)
+        {
+            const auto frames = this->pullBlock(size);
+            
+            // The pulled frames may lie anywhere within the block that was rendered last
+            const auto block = this->getRenderedBlock();
+            const auto offset = block.frames ? static_cast<std::size_t>(frames - block.frames) : 0;
+            
+            // Channels forwarded while rendering this very block need no deinterleaving
+            if (isForwarded(block))
+            {
+                for (std::size_t channel = 0; channel < N; ++channel)
+                    planar.channels[channel] = planar.forwarded[channel].samples + offset;
+                
+                return planar.channels;
+            }
+            
+            if (planar.frames != block.frames || planar.start != block.start || planar.size != block.size)
+            {
+                if (planar.capacity < block.size)
+                {
+                    planar.data = std::make_unique<T[]>(block.size * N);
+                    planar.capacity = block.size;
+                }
+                
+                for (std::size_t channel = 0; channel < N; ++channel)
+                {
+                    auto buffer = planar.data.get() + channel * planar.capacity;
+                    for (std::size_t i = 0; i < block.size; ++i)
+                        buffer[i] = block.frames[i][channel];
+                }
+                
+                planar.frames = block.frames;
+                planar.start = block.start;
+                planar.size = block.size;
+            }
+            
+            for (std::size_t channel = 0; channel < N; ++channel)
+                planar.channels[channel] = planar.data.get() + channel * planar.capacity + offset;
+            
+            return planar.channels;
+        }
+    
+    protected:
+        //! Hand out the samples of another signal as a channel of the block being rendered
+        /*! Call this from generateBlock() for channels whose samples already lie contiguously elsewhere
+            (e.g. in the block of an input signal), so pullPlanar() can point at them instead of
+            deinterleaving the block. The samples should stay alive until the next block is pulled. */
+        void forwardPlanar(std::size_t channel, const T* samples, std::size_t size)
+        {
+            // Blocks of clockless signals are identified by the graph epoch instead (see pullBlock())
+            auto clock = this->getClock();
+            planar.forwarded[channel] = {samples, clock ? clock->renderTime() : Sink::getGraphEpoch(), size};
+        }
+    
+    private:
+        //! Were all channels forwarded while rendering a block?
+        bool isForwarded(const typename Signal<Frame<T, N>>::BlockView& block) const
+        {
+            for (auto& forwarded : planar.forwarded)
+            {
+                if (!forwarded.samples || forwarded.start != block.start || forwarded.size != block.size)
+                    return false;
+            }
+            
+            return true;
+        }
+    
+    private:
+        //! A channel forwarded while rendering a block (see forwardPlanar())
+        struct Forwarded
+        {
+            //! The samples of the channel
+            const T* samples = nullptr;
+            
+            //! The render time of the first sample
+            uint64_t start = 0;
+            
+            //! The number of samples
+            std::size_t size = 0;
+        };
+        
+        //! A block of consecutively rendered samples, one buffer per channel
+        struct Planar
+        {
+            Planar() = default;
+            
+            //! Blocks are not carried over when signals are copied or moved
+            Planar(const Planar&) { }
+            
+            //! Blocks are not carried over when signals are copied or moved
+            Planar& operator=(const Planar&) { return *this = Planar(); }
+            
+            Planar& operator=(Planar&&) = default;
+            
+            //! The buffers of all channels, one after the other
+            std::unique_ptr<T[]> data;
+            
+            //! The channels of the block
+            std::array<const T*, N> channels{};
+            
+            //! The number of samples that fit in each buffer
+            std::size_t capacity = 0;
+            
+            //! The frames of the block the buffers were deinterleaved from
+            const Frame<T, N>* frames = nullptr;
+            
+            //! The render time of the first frame of that block
+            uint64_t start = 0;
+            
+            //! The number of frames in that block
+            std::size_t size = 0;
+            
+            //! The channels forwarded while rendering (see forwardPlanar())
+            std::array<Forwarded, N> forwarded{};
+        };
+    
+    private:
+        //! The last rendered planar block
+        Planar planar;
+    };
+}
+
+#endif
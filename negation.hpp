@@ -29,6 +29,11 @@
 #ifndef OCTOPUS_NEGATION_HPP
 #define OCTOPUS_NEGATION_HPP
 
+#include <cstddef>
+#include <functional>
+
+#include "expression.hpp"
+#include "simd.hpp"
 #include "unary_operation.hpp"
 
 namespace octo
@@ -44,12 +49,28 @@ namespace octo
         // Generate the moveToHeap() function
         GENERATE_MOVE(Negation)
         
+        // Inherited from SignalBase
+        bool isPure() const final override { return true; }
+    
     private:
+        //! Pass the input of a negated negation through
+        Signal<T>* simplify() final override
+        {
+            auto inner = dynamic_cast<Negation*>(this->input.pullSource());
+            return inner ? &inner->input : nullptr;
+        }
+        
         //! Generate a negative sample
         void convertSample(const T& in, T& out) final override
         {
             out = -in;
         }
+        
+        //! Generate a block of negative samples
+        void convertBlock(const T* in, T* out, std::size_t size) final override
+        {
+            simd::negate(in, out, size);
+        }
     };
     
     //! Operator overload for negating signals
@@ -65,6 +86,13 @@ namespace octo
     {
         return {signal.getClock(), std::move(signal)};
     }
+    
+    //! Fuse a negation into an arithmetic expression
+    template <class E, class = EnableIfExpression<E>>
+    auto operator-(E&& expression)
+    {
+        return makeUnaryExpression<std::negate<>>(std::forward<E>(expression));
+    }
 }
 
 #endif
@@ -34,12 +34,34 @@
 #include "arithmetic.hpp"
 #include "binary_operation.hpp"
 #include "clock.hpp"
+#include "clock_thread.hpp"
+#include "execution_plan.hpp"
+#include "expression.hpp"
+#include "fifo_bridge.hpp"
 #include "fold.hpp"
+#include "frame_conversion.hpp"
+#include "frame_join.hpp"
+#include "frame_sieve.hpp"
+#include "frame_split.hpp"
+#include "graph_arena.hpp"
+#include "graph_footprint.hpp"
+#include "graph_optimizer.hpp"
+#include "interpolating_bridge.hpp"
 #include "join.hpp"
+#include "latency_histogram.hpp"
+#include "latest_bridge.hpp"
+#include "map.hpp"
+#include "multi_channel_signal.hpp"
+#include "parallel_executor.hpp"
+#include "profiler.hpp"
+#include "realtime_checker.hpp"
 #include "sieve.hpp"
 #include "signal.hpp"
+#include "signal_pool.hpp"
 #include "split.hpp"
+#include "tracer.hpp"
 #include "unary_operation.hpp"
 #include "value.hpp"
+#include "zip.hpp"
 
 #endif
@@ -0,0 +1,312 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "clock.hpp"
+#include "execution_plan.hpp"
+#include "parallel_executor.hpp"
+#include "realtime_checker.hpp"
+#include "sink.hpp"
+#include "tracer.hpp"
+
+namespace octo
+{
+    //! A fixed-capacity work-stealing deque (after Chase & Lev)
+    /*! The owning worker pushes and pops tasks at the bottom, other workers steal from the top.
+        Queues are only refilled while all workers are idle, so they never need to grow while running. */
+    class ParallelExecutor::TaskQueue
+    {
+    public:
+        //! Empty the queue and make sure it can hold at least the given number of tasks
+        void reset(std::size_t capacity)
+        {
+            if (capacity > buffer.size())
+            {
+                std::size_t size = 1;
+                while (size < capacity)
+                    size *= 2;
+                
+                buffer = std::vector<std::atomic<std::size_t>>(size);
+            }
+            
+            top.store(0);
+            bottom.store(0);
+        }
+        
+        //! Push a task (owner only)
+        void push(std::size_t task)
+        {
+            const auto b = bottom.load();
+            buffer[b & (buffer.size() - 1)].store(task, std::memory_order_relaxed);
+            bottom.store(b + 1);
+        }
+        
+        //! Pop the most recently pushed task (owner only)
+        bool pop(std::size_t& task)
+        {
+            const auto b = bottom.load() - 1;
+            bottom.store(b);
+            
+            auto t = top.load();
+            if (t > b)
+            {
+                bottom.store(b + 1);
+                return false;
+            }
+            
+            task = buffer[b & (buffer.size() - 1)].load(std::memory_order_relaxed);
+            if (t < b)
+                return true;
+            
+            // This is the last task, so race the thieves for it
+            const bool won = top.compare_exchange_strong(t, t + 1);
+            bottom.store(b + 1);
+            return won;
+        }
+        
+        //! Take the least recently pushed task (any thread)
+        bool steal(std::size_t& task)
+        {
+            auto t = top.load();
+            const auto b = bottom.load();
+            if (t >= b)
+                return false;
+            
+            task = buffer[t & (buffer.size() - 1)].load(std::memory_order_relaxed);
+            return top.compare_exchange_strong(t, t + 1);
+        }
+    
+    private:
+        //! The tasks, indexed modulo the (power of two) size
+        std::vector<std::atomic<std::size_t>> buffer;
+        
+        //! The index at which tasks are stolen
+        std::atomic<int64_t> top{0};
+        
+        //! The index at which tasks are pushed and popped
+        std::atomic<int64_t> bottom{0};
+    };
+    
+    ParallelExecutor::ParallelExecutor(std::size_t threadCount)
+    {
+        threadCount = std::max<std::size_t>(threadCount, 1);
+        
+        for (std::size_t i = 0; i < threadCount; ++i)
+            queues.emplace_back(std::make_unique<TaskQueue>());
+        
+        for (std::size_t i = 1; i < threadCount; ++i)
+            threads.emplace_back([this, i]{ work(i); });
+    }
+    
+    ParallelExecutor::~ParallelExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        
+        wake.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+    }
+    
+    void ParallelExecutor::run(const ExecutionPlan& plan)
+    {
+        start(plan, 0);
+    }
+    
+    void ParallelExecutor::runBlock(const ExecutionPlan& plan, std::size_t size)
+    {
+        if (size != 0)
+            start(plan, size);
+    }
+    
+    void ParallelExecutor::start(const ExecutionPlan& plan, std::size_t size)
+    {
+        const auto& tasks = plan.getTasks();
+        if (threads.empty() || tasks.size() < 2)
+            return size ? plan.runBlock(size) : plan.run();
+        
+        // Handing out the plan and waiting for the workers may allocate and lock, only the tasks are checked
+    #ifdef OCTOPUS_REALTIME_CHECKS
+        RealTimeChecker::Exemption exemption;
+    #endif
+        
+        if (running.exchange(true))
+            throw std::runtime_error("ParallelExecutor is already running a plan");
+        
+        // Prepare the plan, and hand out the tasks without dependencies to the workers
+        this->plan = &plan;
+        blockSize = size;
+        if (pending.size() != tasks.size())
+            pending = std::vector<std::atomic<std::size_t>>(tasks.size());
+        
+        for (auto& queue : queues)
+            queue->reset(tasks.size());
+        
+        std::size_t worker = 0;
+        for (std::size_t i = 0; i < tasks.size(); ++i)
+        {
+            pending[i].store(tasks[i].dependencyCount, std::memory_order_relaxed);
+            if (tasks[i].dependencyCount == 0)
+                queues[worker++ % queues.size()]->push(i);
+        }
+        
+        completed.store(0, std::memory_order_relaxed);
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = 0;
+            ++generation;
+        }
+        
+        wake.notify_all();
+        process(0);
+        
+        // Wait for the workers to leave the plan, so it can safely be changed or destroyed
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&]{ return finished == threads.size(); });
+        }
+        
+        this->plan = nullptr;
+        running.store(false);
+        
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+    }
+    
+    void ParallelExecutor::work(std::size_t worker)
+    {
+        uint64_t seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]{ return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                
+                seen = generation;
+            }
+            
+            process(worker);
+            
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (++finished == threads.size())
+                    done.notify_one();
+            }
+        }
+    }
+    
+    void ParallelExecutor::process(std::size_t worker)
+    {
+        const auto& tasks = plan->getTasks();
+        auto& queue = *queues[worker];
+        
+    #ifdef OCTOPUS_REALTIME_CHECKS
+        RealTimeChecker::TickScope check;
+    #endif
+        
+        // Workers rendering blocks walk through the frames at their own pace
+        std::optional<Clock::RenderOffsetScope> offset;
+        if (blockSize)
+            offset.emplace(*plan->getClock());
+        
+        // Other workers may pull the same sinks, but threads ticking other clocks don't need to know
+        Sink::beginConcurrentUpdates();
+        Sink::PlanScope scope(*plan->getClock());
+        
+        while (completed.load(std::memory_order_acquire) < tasks.size())
+        {
+            std::size_t index;
+            if (!queue.pop(index) && !steal(worker, index))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            
+            auto& task = tasks[index];
+            try
+            {
+            #ifdef OCTOPUS_TRACING
+                Tracer::Scope trace("task", &task);
+            #endif
+                if (blockSize)
+                {
+                    for (auto& sink : task.sinks)
+                        sink->updateBlock(blockSize);
+                } else {
+                    for (auto& sink : task.sinks)
+                        sink->update();
+                }
+            } catch (...) {
+                // The dependents of the task will never run, so mark every task as finished to let the
+                // workers leave the plan, and have run() rethrow the exception
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+                
+                completed.store(tasks.size(), std::memory_order_release);
+                break;
+            }
+            
+            // Schedule the dependents for which this was the last unfinished dependency
+            for (auto& dependent : task.dependents)
+            {
+                if (pending[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                #ifdef OCTOPUS_TRACING
+                    Tracer::recordInstant("task scheduled", &tasks[dependent]);
+                #endif
+                    queue.push(dependent);
+                }
+            }
+            
+            completed.fetch_add(1, std::memory_order_release);
+        }
+        
+        Sink::endConcurrentUpdates();
+    }
+    
+    bool ParallelExecutor::steal(std::size_t worker, std::size_t& task)
+    {
+        for (std::size_t i = 1; i < queues.size(); ++i)
+        {
+            if (queues[(worker + i) % queues.size()]->steal(task))
+                return true;
+        }
+        
+        return false;
+    }
+}
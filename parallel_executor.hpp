@@ -0,0 +1,143 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_PARALLEL_EXECUTOR_HPP
+#define OCTOPUS_PARALLEL_EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace octo
+{
+    class ExecutionPlan;
+    
+    //! Runs execution plans on multiple cores
+    /*! The tasks of a plan (see ExecutionPlan::getTasks()) are distributed over a pool of worker
+        threads. Every worker has a queue of tasks that are ready to run. When a task finishes, the
+        tasks depending on it that have no other unfinished dependencies are pushed onto the queue of
+        the worker that finished it, so chains of tasks tend to stay on one core. Workers that run out
+        of tasks steal them from the others. The thread calling run() acts as one of the workers, and
+        run() returns once every task of the plan has finished.
+        
+        Attach an executor to a clock with Clock::setExecutor() to have it tick in parallel. */
+    class ParallelExecutor
+    {
+    public:
+        //! Construct the executor
+        /*! @param threadCount The number of threads (including the one calling run()) working on a plan */
+        ParallelExecutor(std::size_t threadCount = std::thread::hardware_concurrency());
+        
+        //! Stop and join the worker threads
+        ~ParallelExecutor();
+        
+        ParallelExecutor(const ParallelExecutor&) = delete;
+        ParallelExecutor& operator=(const ParallelExecutor&) = delete;
+        
+        //! Update every sink in the plan, spreading the work over the worker threads
+        /*! Plans with less than two tasks are simply run on the calling thread. If updating a sink throws,
+            the tasks that haven't started yet are skipped, and the first exception is rethrown once every
+            worker has left the plan. */
+        void run(const ExecutionPlan& plan);
+        
+        //! Update every sink in the plan for a number of consecutive frames, spreading the work over the worker threads
+        /*! Every task renders its sinks for the whole block at once (see ExecutionPlan::runBlock()).
+            Plans with less than two tasks are simply run on the calling thread. */
+        void runBlock(const ExecutionPlan& plan, std::size_t size);
+        
+        //! Return the number of threads (including the one calling run()) working on a plan
+        std::size_t getThreadCount() const { return queues.size(); }
+    
+    private:
+        class TaskQueue;
+    
+    private:
+        //! Run a plan for a block of frames, or a single frame if the size is zero
+        void start(const ExecutionPlan& plan, std::size_t size);
+        
+        //! The loop run by each worker thread
+        void work(std::size_t worker);
+        
+        //! Run and steal tasks until all tasks of the current plan have finished
+        void process(std::size_t worker);
+        
+        //! Try to take a task from the queue of another worker
+        bool steal(std::size_t worker, std::size_t& task);
+    
+    private:
+        //! The task queue of each worker (the thread calling run() uses the first)
+        std::vector<std::unique_ptr<TaskQueue>> queues;
+        
+        //! The worker threads
+        std::vector<std::thread> threads;
+        
+        //! The plan being run
+        const ExecutionPlan* plan = nullptr;
+        
+        //! The number of frames the plan is run for, or zero for a single frame (see runBlock())
+        std::size_t blockSize = 0;
+        
+        //! For each task, the number of dependencies that have yet to finish
+        std::vector<std::atomic<std::size_t>> pending;
+        
+        //! The number of tasks that have finished
+        std::atomic<std::size_t> completed{0};
+        
+        //! Is a plan being run?
+        std::atomic<bool> running{false};
+        
+        //! Guards the hand-over of plans between run() and the worker threads
+        std::mutex mutex;
+        
+        //! Wakes up the worker threads when a new plan is to be run
+        std::condition_variable wake;
+        
+        //! Signals run() that all worker threads are done with the plan
+        std::condition_variable done;
+        
+        //! Incremented for every plan run, so workers know when to start
+        uint64_t generation = 0;
+        
+        //! The number of worker threads that finished the current plan
+        std::size_t finished = 0;
+        
+        //! The first exception thrown while running the current plan, if any
+        std::exception_ptr error;
+        
+        //! Should the worker threads stop?
+        bool stopping = false;
+    };
+}
+
+#endif
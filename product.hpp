@@ -29,18 +29,43 @@
 #ifndef OCTOPUS_PRODUCT_HPP
 #define OCTOPUS_PRODUCT_HPP
 
+#include <cstddef>
+#include <functional>
 #include <type_traits>
 
+#include "expression.hpp"
 #include "fold.hpp"
+#include "simd.hpp"
 
 namespace octo
 {
+    //! Fold policy that multiplies its inputs, used by Product
+    template <class T>
+    struct Multiplication
+    {
+        static constexpr bool commutative = true;
+        
+        T init() const { return 1; }
+        
+        void operator()(T& out, const T& in) const { out = out * in; }
+        
+        void operator()(T* out, const T* in, std::size_t size) const
+        {
+            simd::multiply(out, in, out, size);
+        }
+        
+        void operator()(const T* const* blocks, std::size_t count, const T& constant, T* out, std::size_t size) const
+        {
+            simd::product(blocks, count, constant, out, size);
+        }
+    };
+    
     //! Multiplies an variadic amount of signals with each other
     template <class T>
-    class Product : public Fold<T>
+    class Product : public Fold<T, T, Multiplication<T>>
     {
     public:
-        using Fold<T>::Fold;
+        using Fold<T, T, Multiplication<T>>::Fold;
         
         //! Add another term to the product
         template <class U>
@@ -52,10 +77,8 @@ namespace octo
         
         GENERATE_MOVE(Product)
         
-    private:
-        // Inherited from Fold
-        T init() const final override { return 1; }
-        T fold(const T& in, const T& out) const final override { return in * out; }
+        // Inherited from SignalBase
+        bool isPure() const final override { return true; }
     };
     
     //! Combine a scalar and a signal into a product
@@ -127,7 +150,7 @@ namespace octo
     }
     
     //! Add another factor to a product
-    template <class T1, class T2>
+    template <class T1, class T2, class = std::enable_if_t<!IsExpression<T2>::value>>
     Product<T1> operator*(Product<T1>&& lhs, T2&& rhs)
     {
         lhs.emplace(std::forward<T2&&>(rhs));
@@ -135,12 +158,19 @@ namespace octo
     }
     
     //! Add another factor to a product
-    template <class T1, class T2>
+    template <class T1, class T2, class = std::enable_if_t<!IsExpression<T1>::value>>
     Product<T2> operator*(T1&& lhs, Product<T2>&& rhs)
     {
         rhs.emplace(std::forward<T1&&>(lhs));
         return std::move(rhs);
     }
+    
+    //! Fuse a product into an arithmetic expression
+    template <class L, class R, class = EnableIfExpression<L, R>>
+    auto operator*(L&& lhs, R&& rhs)
+    {
+        return makeBinaryExpression<std::multiplies<>>(std::forward<L>(lhs), std::forward<R>(rhs));
+    }
 }
 
 #endif
@@ -0,0 +1,296 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <typeinfo>
+#include <string>
+#include <utility>
+
+#include "profiler.hpp"
+#include "sink.hpp"
+
+namespace octo
+{
+    namespace
+    {
+        //! The measurements of a sink on a single thread
+        /*! Written by the thread owning the table only, and read by the thread taking a snapshot */
+        struct Record
+        {
+            std::atomic<uint64_t> calls{0};
+            std::atomic<uint64_t> hits{0};
+            std::atomic<uint64_t> inclusiveTime{0};
+            std::atomic<uint64_t> exclusiveTime{0};
+        };
+        
+        //! The number of records in a chunk of a table
+        constexpr std::size_t chunkSize = 256;
+        
+        //! The number of chunks in a table, limiting the number of sinks that can be profiled
+        constexpr std::size_t chunkCount = 4096;
+        
+        //! The records of a single thread, indexed by the slots of the sinks (see Slot)
+        /*! Chunks are added by the thread owning the table, so recording never needs a lock. */
+        struct Table
+        {
+            std::atomic<Record*> chunks[chunkCount] = {};
+            
+            ~Table()
+            {
+                for (auto& chunk : chunks)
+                    delete[] chunk.load(std::memory_order_relaxed);
+            }
+        };
+        
+        //! A sink that was profiled, or given a label
+        /*! Slots are handed out once per sink and cached in the sink, and never reused, because an update
+            may still be measuring a sink while it's destructed. */
+        struct Slot
+        {
+            //! The sink, or nullptr once it was destructed
+            const Sink* sink = nullptr;
+            
+            const std::type_info* type = &typeid(void);
+            std::string label;
+        };
+        
+        //! An update being measured
+        struct Frame
+        {
+            Record* record = nullptr;
+            std::chrono::steady_clock::time_point start;
+            uint64_t childTime = 0;
+        };
+        
+        //! Guards the list of tables and the slots
+        std::mutex mutex;
+        
+        //! The tables of every thread that recorded something
+        std::vector<std::shared_ptr<Table>> tables;
+        
+        //! The slots of the sinks, the first one unused (see Sink::profilerSlot)
+        std::vector<Slot> slots(1);
+        
+        //! The updates being measured on this thread, the innermost last
+        thread_local std::vector<Frame> frames;
+        
+        //! Return the table of this thread, creating it on first use
+        Table& getTable()
+        {
+            thread_local std::shared_ptr<Table> table;
+            if (!table)
+            {
+                table = std::make_shared<Table>();
+                std::lock_guard<std::mutex> lock(mutex);
+                tables.emplace_back(table);
+            }
+            
+            return *table;
+        }
+        
+        //! Return the slot of a sink, handing it one if it hasn't got one yet (call with the mutex locked)
+        /*! @return The index of the slot, or 0 if all slots have been handed out */
+        std::uint32_t assignSlot(const Sink& sink, std::atomic<std::uint32_t>& slot)
+        {
+            auto index = slot.load(std::memory_order_acquire);
+            if (index || slots.size() == chunkSize * chunkCount)
+                return index;
+            
+            index = static_cast<std::uint32_t>(slots.size());
+            slots.push_back({&sink, &typeid(sink), {}});
+            slot.store(index, std::memory_order_release);
+            return index;
+        }
+        
+        //! Return the record of a sink on this thread, creating it on first use
+        /*! @return The record, or nullptr if the sink couldn't be given a slot */
+        Record* getRecord(const Sink& sink, std::atomic<std::uint32_t>& slot)
+        {
+            auto index = slot.load(std::memory_order_acquire);
+            if (!index)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                index = assignSlot(sink, slot);
+                if (!index)
+                    return nullptr;
+            }
+            
+            auto& chunk = getTable().chunks[index / chunkSize];
+            auto records = chunk.load(std::memory_order_relaxed);
+            if (!records)
+            {
+                records = new Record[chunkSize];
+                chunk.store(records, std::memory_order_release);
+            }
+            
+            return &records[index % chunkSize];
+        }
+        
+        //! Add to a counter that only this thread writes to
+        void add(std::atomic<uint64_t>& counter, uint64_t amount)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+    }
+    
+    std::atomic<bool> Profiler::enabled{false};
+    
+    void Profiler::setEnabled(bool enabled)
+    {
+    #ifndef OCTOPUS_PROFILING
+        if (enabled)
+            throw std::runtime_error("octopus was built without profiling, define OCTOPUS_PROFILING to enable it");
+    #endif
+        
+        Profiler::enabled.store(enabled, std::memory_order_relaxed);
+    }
+    
+    std::vector<Profiler::Entry> Profiler::getSnapshot()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        
+        // Sum the records of every thread per sink
+        std::vector<Entry> snapshot;
+        for (std::size_t index = 1; index < slots.size(); ++index)
+        {
+            auto& slot = slots[index];
+            if (!slot.sink)
+                continue;
+            
+            Entry entry;
+            entry.sink = slot.sink;
+            entry.type = *slot.type;
+            entry.label = slot.label;
+            for (auto& table : tables)
+            {
+                auto chunk = table->chunks[index / chunkSize].load(std::memory_order_acquire);
+                if (!chunk)
+                    continue;
+                
+                auto& record = chunk[index % chunkSize];
+                entry.calls += record.calls.load(std::memory_order_relaxed);
+                entry.hits += record.hits.load(std::memory_order_relaxed);
+                entry.inclusiveTime += record.inclusiveTime.load(std::memory_order_relaxed);
+                entry.exclusiveTime += record.exclusiveTime.load(std::memory_order_relaxed);
+            }
+            
+            // Sinks that were only labelled haven't been recorded
+            if (entry.calls)
+                snapshot.emplace_back(std::move(entry));
+        }
+        
+        std::sort(snapshot.begin(), snapshot.end(), [](const Entry& lhs, const Entry& rhs){ return lhs.exclusiveTime > rhs.exclusiveTime; });
+        return snapshot;
+    }
+    
+    void Profiler::reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& table : tables)
+        {
+            for (auto& chunk : table->chunks)
+            {
+                auto records = chunk.load(std::memory_order_acquire);
+                for (std::size_t i = 0; records && i < chunkSize; ++i)
+                {
+                    records[i].calls.store(0, std::memory_order_relaxed);
+                    records[i].hits.store(0, std::memory_order_relaxed);
+                    records[i].inclusiveTime.store(0, std::memory_order_relaxed);
+                    records[i].exclusiveTime.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+    
+    void Profiler::setLabel(const Sink& sink, std::string label)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto index = assignSlot(sink, sink.profilerSlot);
+        if (index)
+            slots[index].label = std::move(label);
+    }
+    
+    std::string Profiler::getLabel(const Sink& sink)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto index = sink.profilerSlot.load(std::memory_order_relaxed);
+        return index ? slots[index].label : std::string();
+    }
+    
+    void Profiler::forget(const Sink& sink)
+    {
+        // Most sinks are never profiled, and don't need to take the lock
+        const auto index = sink.profilerSlot.load(std::memory_order_acquire);
+        if (!index)
+            return;
+        
+        // Another sink may be constructed at the same address, which shouldn't inherit the records
+        std::lock_guard<std::mutex> lock(mutex);
+        slots[index] = Slot();
+    }
+    
+    void Profiler::hit(const Sink& sink)
+    {
+        auto record = getRecord(sink, sink.profilerSlot);
+        if (!record)
+            return;
+        
+        add(record->calls, 1);
+        add(record->hits, 1);
+    }
+    
+    void Profiler::begin(const Sink& sink)
+    {
+        auto record = getRecord(sink, sink.profilerSlot);
+        if (record)
+            add(record->calls, 1);
+        
+        frames.push_back({record, std::chrono::steady_clock::now(), 0});
+    }
+    
+    void Profiler::end()
+    {
+        const auto frame = frames.back();
+        frames.pop_back();
+        
+        const auto time = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - frame.start).count());
+        if (frame.record)
+        {
+            add(frame.record->inclusiveTime, time);
+            add(frame.record->exclusiveTime, time - std::min(frame.childTime, time));
+        }
+        
+        // The time of this update is excluded from the sink that pulled it
+        if (!frames.empty())
+            frames.back().childTime += time;
+    }
+}
@@ -0,0 +1,170 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_PROFILER_HPP
+#define OCTOPUS_PROFILER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+namespace octo
+{
+    class Sink;
+    
+    //! Measures how much time every sink of a graph takes to update
+    /*! The profiler hooks into Sink::update() and Signal::pullBlock(), recording for every sink how often
+        it was pulled, how often it was up to date already (a cache hit) and how much time its updates took,
+        both including (inclusive) and excluding (exclusive) the time spent updating its dependencies.
+        
+        Profiling is compiled in by defining OCTOPUS_PROFILING (see the CMake option of the same name),
+        for the library and everything including its headers. Without it, the hooks compile to nothing.
+        With it, the hooks cost a single branch per update until the profiler is enabled:
+        @code{cpp}
+        Profiler::setLabel(oscillator, "carrier");
+        Profiler::setEnabled(true);
+        for (auto i = 0; i < 44100; ++i)
+            audio.tick();
+        
+        for (auto& entry : Profiler::getSnapshot())
+            std::cout << entry.type.name() << " " << entry.label << ": " << entry.exclusiveTime << "ns\n";
+        @endcode
+        
+        Every thread records into its own tables, so graphs ticked in parallel can be profiled as well.
+        Snapshots can be taken from any thread, while the graph is ticking. */
+    class Profiler
+    {
+    public:
+        //! The measurements of a single sink
+        struct Entry
+        {
+            //! Return the fraction of pulls for which the sink was up to date already
+            double getHitRatio() const { return calls ? static_cast<double>(hits) / calls : 0; }
+            
+            //! The sink that was measured (only use it to identify the sink, it may have been destructed)
+            const Sink* sink = nullptr;
+            
+            //! The dynamic type of the sink (e.g. octo::Sum<float>)
+            std::type_index type = typeid(void);
+            
+            //! The label given to the sink with setLabel(), if any
+            std::string label;
+            
+            //! The number of times the sink was pulled
+            uint64_t calls = 0;
+            
+            //! The number of pulls that were skipped because the sink was up to date
+            uint64_t hits = 0;
+            
+            //! The time spent updating the sink, including its dependencies (in nanoseconds)
+            uint64_t inclusiveTime = 0;
+            
+            //! The time spent updating the sink itself, excluding its dependencies (in nanoseconds)
+            uint64_t exclusiveTime = 0;
+        };
+        
+        class Scope;
+    
+    public:
+        //! Start or stop recording
+        /*! @throw std::runtime_error if the library was built without OCTOPUS_PROFILING */
+        static void setEnabled(bool enabled);
+        
+        //! Is the profiler recording?
+        static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+        
+        //! Return the measurements of every sink that was recorded, the highest exclusive time first
+        static std::vector<Entry> getSnapshot();
+        
+        //! Forget everything that was recorded so far
+        /*! Only call this while no graph is being ticked. */
+        static void reset();
+        
+        //! Give a sink a label, to tell it apart from others of the same type in snapshots
+        static void setLabel(const Sink& sink, std::string label);
+        
+        //! Return the label of a sink, or an empty string if it hasn't got one
+        static std::string getLabel(const Sink& sink);
+        
+        //! Record that a sink was pulled while it was up to date already
+        static void recordHit(const Sink& sink)
+        {
+            if (isEnabled())
+                hit(sink);
+        }
+        
+        //! Stop tracking a sink, because it's being destructed
+        /*! Only locks if the sink was ever profiled or labelled. */
+        static void forget(const Sink& sink);
+    
+    private:
+        //! Record a cache hit
+        static void hit(const Sink& sink);
+        
+        //! Start measuring the update of a sink on this thread
+        static void begin(const Sink& sink);
+        
+        //! Stop measuring the update started last on this thread
+        static void end();
+    
+    private:
+        //! Is the profiler recording?
+        static std::atomic<bool> enabled;
+    };
+    
+    //! Measures a single update of a sink, as long as the scope lives
+    class Profiler::Scope
+    {
+    public:
+        //! Start measuring, if the profiler is enabled
+        Scope(const Sink& sink) :
+            active(isEnabled())
+        {
+            if (active)
+                begin(sink);
+        }
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        
+        //! Stop measuring
+        ~Scope()
+        {
+            if (active)
+                end();
+        }
+    
+    private:
+        //! Was the profiler enabled when the scope started?
+        bool active = false;
+    };
+}
+
+#endif
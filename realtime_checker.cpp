@@ -0,0 +1,342 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <typeinfo>
+
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#endif
+
+#include "realtime_checker.hpp"
+#include "sink.hpp"
+
+namespace octo
+{
+    namespace
+    {
+        //! What the checker knows about a thread
+        struct ThreadState
+        {
+            //! The number of ticks the thread is in, zero if it isn't rendering
+            std::size_t depth = 0;
+            
+            //! The sink being updated, if any
+            const Sink* sink = nullptr;
+            
+            //! Is the thread reporting a violation? (Reporting may allocate and lock itself)
+            bool reporting = false;
+        };
+        
+        thread_local ThreadState state;
+        
+        //! Guards the recorded violations and the handler
+        std::mutex mutex;
+        
+        //! The first violations since the last reset
+        std::vector<RealTimeChecker::Violation> violations;
+        
+        //! The number of violations since the last reset
+        std::size_t violationCount = 0;
+        
+        //! The function called for every violation, or empty for the default handler
+        RealTimeChecker::Handler handler;
+        
+        //! Are mutex locks checked?
+        std::atomic<bool> checkingLocks{false};
+    
+    #ifdef OCTOPUS_REALTIME_CHECKS
+        //! Return the name of a kind of violation
+        const char* getName(RealTimeChecker::Violation::Kind kind)
+        {
+            switch (kind)
+            {
+                case RealTimeChecker::Violation::Kind::ALLOCATION: return "allocation";
+                case RealTimeChecker::Violation::Kind::DEALLOCATION: return "deallocation";
+                case RealTimeChecker::Violation::Kind::LOCK: return "mutex lock";
+            }
+            
+            return "violation";
+        }
+        
+        //! Print a violation to std::cerr
+        void print(const RealTimeChecker::Violation& violation)
+        {
+            std::cerr << "octopus: " << getName(violation.kind);
+            if (violation.kind == RealTimeChecker::Violation::Kind::ALLOCATION)
+                std::cerr << " of " << violation.size << " bytes";
+            
+            if (violation.sink)
+                std::cerr << " while updating " << violation.type.name() << " at " << violation.sink << "\n";
+            else
+                std::cerr << " while ticking, outside of sink updates\n";
+            
+            for (auto& frame : violation.getStack())
+                std::cerr << "    " << frame << "\n";
+        }
+        
+        //! Record and handle a violation on the calling thread
+        void report(RealTimeChecker::Violation::Kind kind, std::size_t size)
+        {
+            RealTimeChecker::Violation violation;
+            violation.kind = kind;
+            violation.sink = state.sink;
+            violation.type = state.sink ? std::type_index(typeid(*state.sink)) : std::type_index(typeid(void));
+            violation.size = size;
+        
+        #if defined(__GLIBC__)
+            // Leave the checker out of the stack
+            void* frames[64];
+            const auto count = backtrace(frames, 64);
+            if (count > 2)
+                violation.frames.assign(frames + 2, frames + count);
+        #endif
+            
+            RealTimeChecker::Handler handler;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++violationCount;
+                if (violations.size() < RealTimeChecker::capacity)
+                    violations.emplace_back(violation);
+                
+                handler = octo::handler;
+            }
+            
+            if (handler)
+                handler(violation);
+            else
+                print(violation);
+        }
+        
+        //! Record a violation if the calling thread is rendering
+        void check(RealTimeChecker::Violation::Kind kind, std::size_t size)
+        {
+            if (!RealTimeChecker::isEnabled() || state.depth == 0 || state.reporting)
+                return;
+            
+            // Reporting allocates and locks itself, which mustn't be reported again
+            state.reporting = true;
+            report(kind, size);
+            state.reporting = false;
+        }
+    #endif
+    }
+    
+    std::atomic<bool> RealTimeChecker::enabled{false};
+    
+    std::vector<std::string> RealTimeChecker::Violation::getStack() const
+    {
+        std::vector<std::string> stack;
+    
+    #if defined(__GLIBC__)
+        std::unique_ptr<char*, void(*)(void*)> symbols(backtrace_symbols(frames.data(), frames.size()), std::free);
+        if (symbols)
+        {
+            stack.assign(symbols.get(), symbols.get() + frames.size());
+            return stack;
+        }
+    #endif
+        
+        for (auto& frame : frames)
+        {
+            std::ostringstream stream;
+            stream << frame;
+            stack.emplace_back(stream.str());
+        }
+        
+        return stack;
+    }
+    
+    void RealTimeChecker::setEnabled(bool enabled)
+    {
+    #ifndef OCTOPUS_REALTIME_CHECKS
+        if (enabled)
+            throw std::runtime_error("octopus was built without real-time checks, define OCTOPUS_REALTIME_CHECKS to enable them");
+    #endif
+        
+        RealTimeChecker::enabled.store(enabled, std::memory_order_relaxed);
+    }
+    
+    void RealTimeChecker::setCheckingLocks(bool checkingLocks)
+    {
+    #if !defined(OCTOPUS_REALTIME_CHECKS) || !defined(__GLIBC__)
+        if (checkingLocks)
+            throw std::runtime_error("mutex locks can only be checked with OCTOPUS_REALTIME_CHECKS on glibc");
+    #endif
+        
+        octo::checkingLocks.store(checkingLocks, std::memory_order_relaxed);
+    }
+    
+    bool RealTimeChecker::isCheckingLocks()
+    {
+        return checkingLocks.load(std::memory_order_relaxed);
+    }
+    
+    void RealTimeChecker::setHandler(Handler handler)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        octo::handler = std::move(handler);
+    }
+    
+    std::vector<RealTimeChecker::Violation> RealTimeChecker::getViolations()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return violations;
+    }
+    
+    std::size_t RealTimeChecker::getViolationCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return violationCount;
+    }
+    
+    void RealTimeChecker::reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        violations.clear();
+        violationCount = 0;
+    }
+    
+    std::size_t RealTimeChecker::enter()
+    {
+        return state.depth++;
+    }
+    
+    void RealTimeChecker::leave(std::size_t depth)
+    {
+        state.depth = depth;
+    }
+    
+    std::size_t RealTimeChecker::suspend()
+    {
+        const auto depth = state.depth;
+        state.depth = 0;
+        return depth;
+    }
+    
+    const Sink* RealTimeChecker::setSink(const Sink* sink)
+    {
+        const auto previous = state.sink;
+        state.sink = sink;
+        return previous;
+    }
+}
+
+#ifdef OCTOPUS_REALTIME_CHECKS
+
+// Replace the global allocation functions, so that allocations on rendering threads can be checked
+// (the other forms of new and delete call these ones by default)
+
+void* operator new(std::size_t size)
+{
+    octo::check(octo::RealTimeChecker::Violation::Kind::ALLOCATION, size);
+    
+    while (true)
+    {
+        if (auto pointer = std::malloc(size ? size : 1))
+            return pointer;
+        
+        auto handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        
+        handler();
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    octo::check(octo::RealTimeChecker::Violation::Kind::ALLOCATION, size);
+    
+    // aligned_alloc() wants the size to be a multiple of the alignment
+    const auto align = static_cast<std::size_t>(alignment);
+    size = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+    
+    while (true)
+    {
+        if (auto pointer = std::aligned_alloc(align, size))
+            return pointer;
+        
+        auto handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        
+        handler();
+    }
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer)
+        octo::check(octo::RealTimeChecker::Violation::Kind::DEALLOCATION, 0);
+    
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    if (pointer)
+        octo::check(octo::RealTimeChecker::Violation::Kind::DEALLOCATION, 0);
+    
+    std::free(pointer);
+}
+
+#if defined(__GLIBC__)
+
+// Intercept mutex locks (std::mutex locks through here as well), passing them on to the C library
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+{
+    using Lock = int(*)(pthread_mutex_t*);
+    static std::atomic<Lock> lock{nullptr};
+    
+    auto next = lock.load(std::memory_order_relaxed);
+    if (!next)
+    {
+        next = reinterpret_cast<Lock>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        lock.store(next, std::memory_order_relaxed);
+    }
+    
+    if (octo::checkingLocks.load(std::memory_order_relaxed))
+        octo::check(octo::RealTimeChecker::Violation::Kind::LOCK, 0);
+    
+    return next(mutex);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,249 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_REALTIME_CHECKER_HPP
+#define OCTOPUS_REALTIME_CHECKER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+namespace octo
+{
+    class Sink;
+    
+    //! Detects memory allocations and mutex locks while graphs are being ticked
+    /*! Rendering shouldn't allocate or lock, because both can block for an unbounded amount of time. The
+        checker replaces the global operator new and delete and, if asked to, intercepts pthread_mutex_lock()
+        (and with it std::mutex). Whenever one of them is called on a thread that is inside Clock::tick()
+        or running tasks for a ParallelExecutor, it records a violation naming the sink being updated and
+        the call stack, and passes it to the handler (which prints it to std::cerr by default):
+        @code{cpp}
+        // Warm up first, so that caches and blocks have been allocated
+        audio.tick(1024);
+        
+        RealTimeChecker::setEnabled(true);
+        for (auto i = 0; i < 44100; ++i)
+            audio.tick();
+        
+        RealTimeChecker::setEnabled(false);
+        assert(RealTimeChecker::getViolationCount() == 0);
+        @endcode
+        
+        Adapting to a changed graph (reoptimizing, recompiling the execution plan) and the synchronisation
+        of a ParallelExecutor aren't steady-state rendering and are exempt from the checks.
+        
+        The checker is compiled in by defining OCTOPUS_REALTIME_CHECKS (see the CMake option of the same
+        name), for the library and everything including its headers. It's meant for debug and test builds:
+        it can't be combined with sanitizers that replace operator new themselves (e.g. AddressSanitizer),
+        and the Profiler and Tracer allocate when they first see a sink or thread. Stacks are captured with
+        backtrace() where glibc provides it; link with -rdynamic to see the names of functions in executables. */
+    class RealTimeChecker
+    {
+    public:
+        //! Something that shouldn't happen while rendering
+        struct Violation
+        {
+            //! The kinds of violations
+            enum class Kind
+            {
+                ALLOCATION,
+                DEALLOCATION,
+                LOCK
+            };
+            
+            //! Return the call stack, as one readable line per frame (the innermost first)
+            std::vector<std::string> getStack() const;
+            
+            //! What happened
+            Kind kind = Kind::ALLOCATION;
+            
+            //! The sink being updated, or nullptr if it happened outside of updates (only use it to identify the sink)
+            const Sink* sink = nullptr;
+            
+            //! The dynamic type of the sink (e.g. octo::Join<float>)
+            std::type_index type = typeid(void);
+            
+            //! The number of bytes allocated, for allocations
+            std::size_t size = 0;
+            
+            //! The return addresses of the call stack, the innermost first
+            std::vector<void*> frames;
+        };
+        
+        //! A function called for every violation, on the thread that caused it
+        /*! It's called from within operator new or delete, so it mustn't throw (allocating and locking are fine). */
+        using Handler = std::function<void(const Violation&)>;
+        
+        class TickScope;
+        class UpdateScope;
+        class Exemption;
+        
+        //! The number of violations that are kept for getViolations()
+        static constexpr std::size_t capacity = 256;
+    
+    public:
+        //! Start or stop checking
+        /*! @throw std::runtime_error if the library was built without OCTOPUS_REALTIME_CHECKS */
+        static void setEnabled(bool enabled);
+        
+        //! Is the checker checking?
+        static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+        
+        //! Also check for mutex locks (off by default)
+        /*! @throw std::runtime_error if locks can't be intercepted on this platform */
+        static void setCheckingLocks(bool checkingLocks);
+        
+        //! Are mutex locks checked as well?
+        static bool isCheckingLocks();
+        
+        //! Set the function called for every violation, or restore the default handler if it's empty
+        static void setHandler(Handler handler);
+        
+        //! Return the first violations recorded since the last reset (at most capacity of them)
+        static std::vector<Violation> getViolations();
+        
+        //! Return the number of violations since the last reset
+        static std::size_t getViolationCount();
+        
+        //! Forget the recorded violations
+        static void reset();
+    
+    private:
+        //! Have this thread enter a tick, returning the previous depth
+        static std::size_t enter();
+        
+        //! Have this thread leave a tick, or the ticks suspended by an exemption
+        static void leave(std::size_t depth);
+        
+        //! Suspend the checks on this thread, returning the depth to restore
+        static std::size_t suspend();
+        
+        //! Set the sink being updated on this thread, returning the previous one
+        static const Sink* setSink(const Sink* sink);
+    
+    private:
+        //! Is the checker checking?
+        static std::atomic<bool> enabled;
+    };
+    
+    //! Marks a thread as rendering as long as the scope lives (used by Clock::tick() and ParallelExecutor)
+    class RealTimeChecker::TickScope
+    {
+    public:
+        //! Start checking this thread, if the checker is enabled
+        TickScope() :
+            active(isEnabled())
+        {
+            if (active)
+                depth = enter();
+        }
+        
+        TickScope(const TickScope&) = delete;
+        TickScope& operator=(const TickScope&) = delete;
+        
+        //! Stop checking this thread, unless it's still inside another tick
+        ~TickScope()
+        {
+            if (active)
+                leave(depth);
+        }
+    
+    private:
+        //! Was the checker enabled when the scope started?
+        bool active = false;
+        
+        //! The depth of the thread before entering
+        std::size_t depth = 0;
+    };
+    
+    //! Attributes violations to a sink as long as the scope lives (used by Sink::update())
+    class RealTimeChecker::UpdateScope
+    {
+    public:
+        //! Start attributing to the sink, if the checker is enabled
+        UpdateScope(const Sink& sink) :
+            active(isEnabled())
+        {
+            if (active)
+                previous = setSink(&sink);
+        }
+        
+        UpdateScope(const UpdateScope&) = delete;
+        UpdateScope& operator=(const UpdateScope&) = delete;
+        
+        //! Attribute to the sink updated before again
+        ~UpdateScope()
+        {
+            if (active)
+                setSink(previous);
+        }
+    
+    private:
+        //! Was the checker enabled when the scope started?
+        bool active = false;
+        
+        //! The sink being updated before the scope started
+        const Sink* previous = nullptr;
+    };
+    
+    //! Suspends the checks on this thread as long as the scope lives
+    class RealTimeChecker::Exemption
+    {
+    public:
+        //! Suspend the checks, if the checker is enabled
+        Exemption() :
+            active(isEnabled())
+        {
+            if (active)
+                depth = suspend();
+        }
+        
+        Exemption(const Exemption&) = delete;
+        Exemption& operator=(const Exemption&) = delete;
+        
+        //! Resume the checks
+        ~Exemption()
+        {
+            if (active)
+                leave(depth);
+        }
+    
+    private:
+        //! Was the checker enabled when the scope started?
+        bool active = false;
+        
+        //! The depth of the thread before suspending
+        std::size_t depth = 0;
+    };
+}
+
+#endif
@@ -29,6 +29,7 @@
 #ifndef OCTOPUS_SIEVE_HPP
 #define OCTOPUS_SIEVE_HPP
 
+#include <cstddef>
 #include <vector>
 
 #include "unary_operation.hpp"
@@ -61,6 +62,17 @@ namespace octo
         
         GENERATE_MOVE(Sieve)
         
+        // Inherited from SignalBase
+        bool isPure() const final override { return true; }
+        
+        bool isSameOperation(const SignalBase& other) const final override
+        {
+            auto sieve = dynamic_cast<const Sieve*>(&other);
+            return sieve && sieve->channel == channel;
+        }
+        
+        std::size_t hashOperation() const final override { return SignalBase::combineHashes(SignalBase::hashOperation(), channel); }
+    
     public:
         //! The channel being sifted out
         unsigned int channel = 0;
@@ -71,6 +83,13 @@ namespace octo
         {
             out = channel < in.size() ? in[channel] : T{};
         }
+        
+        //! Generate a block of sifted out samples
+        void convertBlock(const std::vector<T>* in, T* out, std::size_t size) final override
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = channel < in[i].size() ? in[i][channel] : T{};
+        }
     };
 }
 
@@ -29,15 +29,47 @@
 #ifndef OCTOPUS_SIGNAL_HPP
 #define OCTOPUS_SIGNAL_HPP
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #include "clock.hpp"
+#include "profiler.hpp"
+#include "realtime_checker.hpp"
 #include "signal_base.hpp"
+#include "tracer.hpp"
 
 namespace octo
 {
+    //! Can two objects of type T be compared with ==?
+    template <class T, class = void>
+    struct IsEqualityComparable : std::false_type { };
+    
+    //! Can the elements of a container be compared with ==? (true for types that aren't containers)
+    /*! Containers declare == regardless of their elements (e.g. std::vector), so the elements are checked as well. */
+    template <class T, class = void>
+    struct AreElementsEqualityComparable : std::true_type { };
+    
+    template <class T>
+    struct AreElementsEqualityComparable<T, std::void_t<typename T::value_type>> : IsEqualityComparable<typename T::value_type> { };
+    
+    template <class T>
+    struct IsEqualityComparable<T, std::void_t<decltype(std::declval<const T&>() == std::declval<const T&>())>> : AreElementsEqualityComparable<T> { };
+    
+    //! Can objects of type T be hashed with std::hash?
+    template <class T, class = void>
+    struct IsHashable : std::false_type { };
+    
+    template <class T>
+    struct IsHashable<T, std::void_t<decltype(std::hash<T>()(std::declval<const T&>()))>> : std::true_type { };
+    
     //! A discrete signal of _any_ given type.
     /*! This is the major class of all signal processing. Everything in octopus is a signal
         derivative. When constructing a signal, it asks for a Clock (see Clock.hpp for more
@@ -65,6 +97,14 @@ namespace octo
         @code{.cpp}
         // Vibrato
         sine.frequency = Sine<float>(clock, 0.1) * 30 + 440;
+        @endcode
+        
+        Signals can also be rendered a block at a time with pullBlock(). Signals that override
+        generateBlock() then process whole buffers per call, instead of paying for a virtual call
+        and a clock check for every single sample.
+        
+        @code{.cpp}
+        const float* block = sine.pullBlock(64);
         @endcode */
     template <class T>
     class Signal : public SignalBase
@@ -85,8 +125,13 @@ namespace octo
         /*! @return A reference to the generated sample in cache. Copy and be done with it, this could change with each call */
         const T& operator()()
         {
-            update(); // Update the signal as a sink
-            return cache;
+            // Signals an execution plan has updated already are read directly (profiling counts the hits)
+        #ifndef OCTOPUS_PROFILING
+            if (!this->isUpdatedByPlan())
+        #endif
+                update(); // Update the signal as a sink
+            
+            return output ? *output : cache;
         }
         
         //! Retrieve a signal of the sample, relative to the its clock's current timestamp
@@ -96,25 +141,474 @@ namespace octo
         //! Return the current sample of the signal
         explicit operator T() { return (*this)(); }
         
+        //! Retrieve a block of consecutive samples, starting at the clock's current render time
+        /*! The block is cached, so pulling the signal sample-by-sample while its clock walks through
+            the block returns the samples that were rendered already. A block overlapping the previous
+            one (e.g. pulling a block before Clock::tick(std::size_t) renders the frames after now())
+            reuses the overlapping frames and only renders the rest, so stateful signals never generate
+            a frame twice. Signals without a clock render a block larger than the previous one whole.
+            Pulling a block from within its own rendering (a feedback loop) returns the previous block,
+            delaying the loop by one block.
+            @return A pointer to size samples. Copy and be done with it, this could change with the next block */
+        const T* pullBlock(std::size_t size)
+        {
+            if (!Sink::isUpdatingConcurrently())
+                return renderBlock(size);
+            
+            // The threads of a ParallelExecutor may pull the block at once, so one renders it and the
+            // others wait to reuse it. A feedback loop owns the sink already, and gets the previous block.
+            if (!this->claim())
+                return getBlock().frames();
+            
+            struct Release
+            {
+                ~Release() { signal.release(); }
+                Signal& signal;
+            } release{*this};
+            
+            return renderBlock(size);
+        }
+        
+        //! The frames of a rendered block (see getRenderedBlock())
+        struct BlockView
+        {
+            //! The frames, or nullptr if no block was rendered
+            const T* frames = nullptr;
+            
+            //! The number of frames
+            std::size_t size = 0;
+            
+            //! The render time of the first frame
+            uint64_t start = 0;
+        };
+        
+        //! Return the frames of the block the signal rendered last
+        /*! After Clock::tick(std::size_t) ticked a persistent signal count times, these are the frames at
+            render times [now() - count + 1, now()], the last of which is also returned by pull(). The frames
+            are valid until the signal renders its next block. */
+        BlockView getRenderedBlock() const
+        {
+            auto extension = lazyExtension.pointer.get();
+            if (!extension || !extension->block.size)
+                return {};
+            
+            return {extension->block.frames(), extension->block.size, extension->block.start};
+        }
+        
+        // Inherited from Sink
+        void updateBlock(std::size_t size) override { pullBlock(size); }
+        
+        // Inherited from SignalBase
+        void optimize(bool constantDependencies) final override
+        {
+            deoptimize();
+            ++this->revision;
+            
+            // Pure signals with constant inputs are computed once
+            if (isPure() && constantDependencies)
+            {
+                generateSample(cache);
+                if (output)
+                    cache = *output;
+                
+                output = nullptr;
+                this->folded = true;
+                return;
+            }
+            
+            this->passThrough = simplify();
+            if (this->passThrough)
+                getExtension().passedRevision = this->passThrough->getRevision();
+        }
+        
+        bool hasSameConstant(SignalBase& other) override
+        {
+            if constexpr (IsEqualityComparable<T>::value)
+            {
+                auto signal = dynamic_cast<Signal*>(&other);
+                return this->folded && signal && signal->folded && cache == signal->cache;
+            } else {
+                return false;
+            }
+        }
+        
+        std::size_t hashConstant() const override
+        {
+            if constexpr (IsHashable<T>::value)
+                return this->folded ? std::hash<T>()(cache) : 0;
+            else
+                return 0;
+        }
+        
+        void deoptimize() final override
+        {
+            this->folded = false;
+            this->passThrough = nullptr;
+            output = nullptr;
+            restore();
+            ++this->revision;
+        }
+        
         //! Move this signal to the heap
         /*! Signals need to implement this to support in-place creation of signals in expressions.
             @note This function can only be used on r-value signal objects. */
         virtual std::unique_ptr<Signal> moveToHeap() && = 0;
         
+        //! Return the number of bytes needed to move this signal into storage with moveTo()
+        /*! @return 0 if the signal can't be moved into storage, in which case it's moved to the heap instead */
+        virtual std::size_t getStorageSize() const { return 0; }
+        
+        //! Move this signal into storage provided by the caller (e.g. a Value holding it inline)
+        /*! The storage should be at least getStorageSize() bytes large and aligned to std::max_align_t.
+            The caller is responsible for destructing the signal, without deallocating it.
+            @note This function can only be used on r-value signal objects. */
+        virtual Signal* moveTo(void* storage) && { throw std::runtime_error("signal can't be moved into storage"); }
+        
+        // Inherited from SignalBase
+        std::size_t getSize() const override { return sizeof(Signal); }
+        
+        std::size_t getHeapSize() const override
+        {
+            auto extension = lazyExtension.pointer.get();
+            if (!extension)
+                return SignalBase::getHeapSize();
+            
+            return SignalBase::getHeapSize() + sizeof(Extension) + extension->block.capacity * sizeof(T) +
+                extension->observed.dependencies.capacity() * sizeof(extension->observed.dependencies[0]);
+        }
+    
+    protected:
+        //! Output a sample of another signal, instead of copying it into the cache
+        /*! Used by signals that pass samples through unchanged (e.g. Value). The sample should stay
+            alive until the next update. Pass nullptr to output the cache again. */
+        void forward(const T* sample) { output = sample; }
+        
+        //! Output a block of another signal, instead of copying it into the block
+        /*! Call this from generateBlock(). The samples should stay alive until the next pull. */
+        void forwardBlock(const T* samples) { getBlock().forwarded = samples; }
+        
         // Inherited from SignalBase
         const std::type_info& getTypeInfo() const final override { return typeid(T); }
         const void* pullGeneric() final override { return &(*this)(); }
         
     private:
+        //! Simplify the signal (called by GraphOptimizer if the signal isn't folded into a constant)
+        /*! Override this to precompute the parts of the output that won't change as long as the graph
+            doesn't (e.g. merging constant inputs). Dependencies have been optimized already, and can be
+            asked whether they're folded (see SignalBase::isFolded()).
+            @return A signal whose output this signal can pass through unchanged (e.g. x * 1), or nullptr */
+        virtual Signal* simplify() { return nullptr; }
+        
+        //! Undo whatever simplify() precomputed
+        virtual void restore() { }
+        
         //! Generate a new sample
         virtual void generateSample(T& out) = 0;
         
+        //! Generate a block of new samples
+        /*! Override this for signals that can process whole buffers at once. The default implementation
+            renders the block sample-by-sample, offsetting the render time of the clock for every frame. */
+        virtual void generateBlock(T* out, std::size_t size)
+        {
+            if (size == 0)
+                return;
+            
+            auto clock = this->getClock();
+            if (!clock)
+            {
+                this->update();
+                std::fill_n(out, size, output ? *output : cache);
+                return;
+            }
+            
+            // Update as a sink for every frame, so that frames that were pulled already
+            // aren't generated twice and feedback loops see the previous frame
+            const auto offset = clock->getRenderOffset();
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                clock->setRenderOffset(offset + i);
+                this->update();
+                out[i] = output ? *output : cache;
+            }
+            
+            clock->setRenderOffset(offset);
+        }
+        
         // Inherited from Sink
-        void onUpdate() final override { generateSample(cache); }
+        void onUpdate() final override
+        {
+            // Folded signals keep outputting the constant in their cache
+            if (this->folded)
+                return;
+            
+            if (this->passThrough)
+            {
+                output = &(*static_cast<Signal*>(this->passThrough))();
+                auto& passedRevision = getExtension().passedRevision;
+                if (this->passThrough->getRevision() != passedRevision)
+                {
+                    passedRevision = this->passThrough->getRevision();
+                    ++this->revision;
+                }
+                
+                return;
+            }
+            
+            // Reuse the last rendered block if the clock is walking through it
+            auto clock = this->getClock();
+            const auto timestamp = this->timestamp.load(std::memory_order_relaxed);
+            auto block = lazyExtension.pointer ? &lazyExtension.pointer->block : nullptr;
+            if (block && block->isReusable() && block->clock && block->clock == clock && timestamp - block->start < block->size)
+            {
+                cache = block->frames()[timestamp - block->start];
+                output = nullptr;
+                ++this->revision;
+            } else if (clock && clock->isIncremental()) {
+                generateIncrementally();
+            } else {
+                generateSample(cache);
+                ++this->revision;
+            }
+        }
+    
+    private:
+        //! Render a block, or reuse the one rendered before (see pullBlock())
+        const T* renderBlock(std::size_t size)
+        {
+            auto& block = getBlock();
+            
+            // Feedback loop, hand out the previous block
+            if (block.rendering)
+                return block.frames();
+            
+            if (this->passThrough)
+            {
+                block.rendering = true;
+                auto frames = static_cast<Signal*>(this->passThrough)->pullBlock(size);
+                block.rendering = false;
+                
+                // Blocks of the pass-through are ours, so its changes are too (see onUpdate())
+                auto& passedRevision = getExtension().passedRevision;
+                if (this->passThrough->getRevision() != passedRevision)
+                {
+                    passedRevision = this->passThrough->getRevision();
+                    ++this->revision;
+                }
+                
+                return frames;
+            }
+            
+            // Blocks of clockless signals are identified by the graph epoch instead, and only reused if their
+            // output is constant (see Sink::update())
+            auto clock = this->getClock();
+            const auto start = clock ? clock->renderTime() : Sink::getGraphEpoch();
+            const auto shift = start - block.start;
+            const bool sameEpoch = !clock && block.size && !block.clock && shift == 0;
+            const bool reusable = block.isReusable() && block.clock == clock && start >= block.start && (clock || (sameEpoch && block.memoized));
+            if (reusable && shift + size <= block.size)
+            {
+            #ifdef OCTOPUS_PROFILING
+                Profiler::recordHit(*this);
+            #endif
+                return block.frames() + shift;
+            }
+            
+            // Keep the frames that overlap with the previous block, moving them to the front. Signals
+            // without a clock have no render times to render the remaining frames at, and output the
+            // same sample throughout the block anyway, so they render a larger block whole.
+            const std::size_t reused = reusable && clock && shift < block.size ? block.size - shift : 0;
+            if (block.capacity < size)
+            {
+                // Growing the block allocates, which is attributed to the signal like its rendering
+            #ifdef OCTOPUS_REALTIME_CHECKS
+                RealTimeChecker::UpdateScope check(*this);
+            #endif
+                auto data = std::make_unique<T[]>(size);
+                std::move(block.data.get() + shift, block.data.get() + shift + reused, data.get());
+                block.data = std::move(data);
+                block.capacity = size;
+            } else if (reused) {
+                std::move(block.data.get() + shift, block.data.get() + shift + reused, block.data.get());
+            }
+            
+            block.size = 0;
+            block.forwarded = nullptr;
+            block.rendering = true;
+            try
+            {
+                if (this->folded)
+                {
+                    std::fill_n(block.data.get(), size, cache);
+                } else {
+                #ifdef OCTOPUS_PROFILING
+                    Profiler::Scope profile(*this);
+                #endif
+                #ifdef OCTOPUS_TRACING
+                    Tracer::Scope trace(*this);
+                #endif
+                #ifdef OCTOPUS_REALTIME_CHECKS
+                    RealTimeChecker::UpdateScope check(*this);
+                #endif
+                    if (reused)
+                    {
+                        assert(clock);
+                        
+                        // Render the frames after the reused ones, at their own render times
+                        const auto offset = clock->getRenderOffset();
+                        clock->setRenderOffset(offset + reused);
+                        generateBlock(block.data.get() + reused, size - reused);
+                        clock->setRenderOffset(offset);
+                        
+                        // Blocks forwarded from another signal only hold the rendered frames
+                        if (block.forwarded)
+                            std::copy_n(block.forwarded, size - reused, block.data.get() + reused);
+                        
+                        block.forwarded = nullptr;
+                    } else {
+                        generateBlock(block.data.get(), size);
+                    }
+                    
+                    ++this->revision;
+                }
+            } catch (...) {
+                // The block is left empty, so it's rendered again by the next pull
+                block.rendering = false;
+                throw;
+            }
+            
+            block.rendering = false;
+            block.output = block.forwarded;
+            block.clock = clock;
+            block.start = start;
+            block.size = size;
+            
+            // Whether the output is constant only changes along with the epoch
+            if (!clock && !sameEpoch)
+                block.memoized = this->isMemoizable();
+            
+            return block.frames();
+        }
+        
+        //! Generate a sample if it can differ from the previous one, and only change the revision if it does
+        void generateIncrementally()
+        {
+            // Pure signals whose dependencies didn't change would generate the same sample again
+            auto& extension = getExtension();
+            if (isPure() && !this->updateDependencies(extension.observed))
+                return;
+            
+            generateSample(cache);
+            
+            if constexpr (IsEqualityComparable<T>::value)
+            {
+                const auto& sample = output ? *output : cache;
+                if (extension.previousRevision == this->revision && sample == extension.previous)
+                    return;
+                
+                extension.previous = sample;
+                extension.previousRevision = this->revision + 1;
+            }
+            
+            ++this->revision;
+        }
+    
+    private:
+        //! A block of consecutively rendered samples
+        struct Block
+        {
+            //! Return the samples of the block, wherever they're stored
+            const T* frames() const { return output ? output : data.get(); }
+            
+            //! Can the samples be handed out again? Forwarded blocks can't, because they belong to another
+            //! signal that may render over them
+            bool isReusable() const { return size && !output; }
+            
+            //! The samples in the block
+            std::unique_ptr<T[]> data;
+            
+            //! The samples of another signal, if the block was forwarded (see forwardBlock())
+            const T* output = nullptr;
+            
+            //! The samples forwarded while rendering the block
+            const T* forwarded = nullptr;
+            
+            //! The number of samples that fit in data
+            std::size_t capacity = 0;
+            
+            //! The number of valid samples
+            std::size_t size = 0;
+            
+            //! The render time of the first sample
+            uint64_t start = 0;
+            
+            //! The clock the block was rendered with
+            Clock* clock = nullptr;
+            
+            //! Is the block being rendered right now?
+            bool rendering = false;
+            
+            //! Can the block of a signal without a clock be reused until the graph epoch changes? (see Sink::isMemoizable())
+            bool memoized = false;
+        };
+        
+        //! The state of a signal that is only allocated once it's needed
+        /*! Most signals are never pulled a block at a time, run incrementally or pass another signal
+            through, so they don't pay for any of it. */
+        struct Extension
+        {
+            //! The last rendered block
+            Block block;
+            
+            //! The dependencies as of the last update in incremental mode
+            ObservedDependencies observed;
+            
+            //! The sample generated at previousRevision, to tell whether the output changed in incremental mode
+            T previous = T{};
+            
+            //! The revision at which the previous sample was generated
+            uint64_t previousRevision = std::numeric_limits<uint64_t>::max();
+            
+            //! The revision of the pass-through signal as of the last update
+            uint64_t passedRevision = 0;
+        };
+        
+        //! Owns the extension of a signal, if it has one
+        struct LazyExtension
+        {
+            LazyExtension() = default;
+            
+            //! The extension is not carried over when signals are copied or moved
+            LazyExtension(const LazyExtension&) { }
+            
+            //! The extension is not carried over when signals are copied or moved
+            LazyExtension& operator=(const LazyExtension&) { pointer = nullptr; return *this; }
+            
+            //! The extension, if it was allocated
+            std::unique_ptr<Extension> pointer;
+        };
+    
+    private:
+        //! Return the last rendered block, allocating it if there is none yet
+        Block& getBlock() { return getExtension().block; }
         
+        //! Return the extension, allocating it if there is none yet
+        Extension& getExtension()
+        {
+            if (!lazyExtension.pointer)
+                lazyExtension.pointer = std::make_unique<Extension>();
+            
+            return *lazyExtension.pointer;
+        }
+    
     private:
         //! A cache for previously generated samples
         T cache = T{};
+        
+        //! The sample of another signal, if it was forwarded instead of cached (see forward())
+        const T* output = nullptr;
+        
+        //! The block cache and the state of incremental mode and pass-throughs, allocated once needed
+        LazyExtension lazyExtension;
     };
     
     // Convenience macro for overriding Signal::move()
@@ -122,6 +616,21 @@ namespace octo
     auto moveToHeap() && -> std::unique_ptr<octo::Signal<typename std::decay<decltype(std::declval<CLASS>().operator()())>::type>> override \
     { \
         return std::make_unique<CLASS>(std::move(*this)); \
+    } \
+    \
+    std::size_t getStorageSize() const override \
+    { \
+        return alignof(CLASS) <= alignof(std::max_align_t) ? sizeof(CLASS) : 0; \
+    } \
+    \
+    auto moveTo(void* storage) && -> octo::Signal<typename std::decay<decltype(std::declval<CLASS>().operator()())>::type>* override \
+    { \
+        return ::new (storage) CLASS(std::move(*this)); \
+    } \
+    \
+    std::size_t getSize() const override \
+    { \
+        return sizeof(CLASS); \
     }
 }
 
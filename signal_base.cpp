@@ -26,8 +26,13 @@
  
  */
 
+#include <algorithm>
+#include <cassert>
+#include <memory_resource>
 #include <stdexcept>
 
+#include "clock.hpp"
+#include "graph_arena.hpp"
 #include "signal_base.hpp"
 
 using namespace std;
@@ -45,8 +50,86 @@ namespace octo
         disconnectDependees();
     }
     
+    vector<SignalBase*> SignalBase::getActiveDependencies()
+    {
+        if (folded)
+            return {};
+        
+        if (passThrough)
+            return {passThrough};
+        
+        return getDependencies();
+    }
+    
+    size_t SignalBase::getHeapSize() const
+    {
+        return sinkListeners.getHeapSize() + dependees.getHeapSize();
+    }
+    
+    bool SignalBase::updateDependencies(ObservedDependencies& observed)
+    {
+        bool changed = false;
+        
+        // Gather the dependencies again if the graph changed
+        const auto epoch = getGraphEpoch();
+        if (observed.epoch != epoch)
+        {
+            observed.epoch = epoch;
+            observed.dependencies.clear();
+            for (auto& dependency : getDependencies())
+                observed.dependencies.emplace_back(dependency, dependency->getRevision());
+            
+            changed = true;
+        }
+        
+        for (auto& dependency : observed.dependencies)
+        {
+            dependency.first->update();
+            
+            const auto revision = dependency.first->getRevision();
+            if (revision != dependency.second)
+            {
+                dependency.second = revision;
+                changed = true;
+            }
+        }
+        
+        return changed;
+    }
+    
+    bool SignalBase::hasConstantOutput()
+    {
+        if (folded)
+            return true;
+        
+        if (!isPure())
+            return false;
+        
+        // Bound the recursion, so feedback loops end and large subtrees don't stall the pulling thread
+        static thread_local size_t depth = 0;
+        if (depth == 32)
+            return false;
+        
+        ++depth;
+        bool constant = true;
+        for (auto& dependency : getDependencies())
+        {
+            if (!dependency->isMemoizable())
+            {
+                constant = false;
+                break;
+            }
+        }
+        
+        --depth;
+        return constant;
+    }
+    
     void SignalBase::disconnectDependees()
     {
+        // Disconnecting a dependee can rebuild plans, which mustn't destroy the dependees they kept alive
+        // while they're being disconnected
+        Clock::DeferralScope deferral;
         auto cachedDependees = dependees;
         for (auto& dependee : cachedDependees)
             dependee->disconnectFromDependent(*this);
@@ -54,4 +137,97 @@ namespace octo
         if (!dependees.empty())
             throw runtime_error("not all dependees disconnected");
     }
+    
+    //! The memory of the last signal allocated from a memory resource on this thread, until it's constructed
+    static thread_local const char* resourceAllocationBegin = nullptr;
+    static thread_local const char* resourceAllocationEnd = nullptr;
+    
+    //! The signals allocated from a memory resource that were destroyed on this thread, but not deallocated yet
+    /*! Destroying a signal can destroy others before its memory is deallocated (e.g. ~Sink rebuilding the
+        plan of a clock), so every deallocation looks for the signal within its own memory. Those signals
+        are deallocated first, so the list is used as a stack. */
+    static thread_local const void* destroyedFromResource[64];
+    static thread_local size_t destroyedFromResourceCount = 0;
+    
+    SignalBase::Allocation::Allocation()
+    {
+        // Only the first signal constructed within the memory claims it, not the signals it contains
+        const auto address = reinterpret_cast<const char*>(this);
+        if (address >= resourceAllocationBegin && address < resourceAllocationEnd)
+        {
+            fromResource = true;
+            resourceAllocationBegin = resourceAllocationEnd = nullptr;
+        }
+    }
+    
+    SignalBase::Allocation::~Allocation()
+    {
+        if (!fromResource)
+            return;
+        
+        // Only signals destroyed while destroying another one pile up, so the list stays short
+        assert(destroyedFromResourceCount < sizeof(destroyedFromResource) / sizeof(destroyedFromResource[0]));
+        destroyedFromResource[destroyedFromResourceCount++] = this;
+    }
+    
+    //! Was the memory of a signal that's being deallocated allocated from a memory resource?
+    static bool isFromResource(const void* address, size_t size)
+    {
+        // The constructor never ran, or threw before claiming the memory
+        if (address == resourceAllocationBegin)
+        {
+            resourceAllocationBegin = resourceAllocationEnd = nullptr;
+            return true;
+        }
+        
+        const auto begin = static_cast<const char*>(address);
+        for (auto i = destroyedFromResourceCount; i-- > 0;)
+        {
+            const auto signal = static_cast<const char*>(destroyedFromResource[i]);
+            if (signal >= begin && signal < begin + size)
+            {
+                copy(destroyedFromResource + i + 1, destroyedFromResource + destroyedFromResourceCount, destroyedFromResource + i);
+                --destroyedFromResourceCount;
+                return true;
+            }
+        }
+        
+        return false;
+    }
+    
+    //! The size of the header in front of signals allocated from a memory resource, storing the resource
+    static size_t headerSize(size_t alignment)
+    {
+        return max(alignment, max(sizeof(pmr::memory_resource*), alignof(max_align_t)));
+    }
+    
+    void* SignalBase::allocate(size_t size, size_t alignment)
+    {
+        auto resource = GraphArena::getCurrentResource();
+        if (!resource)
+            return ::operator new(size, align_val_t(alignment));
+        
+        const auto header = headerSize(alignment);
+        auto memory = static_cast<char*>(resource->allocate(header + size, alignment));
+        
+        // Remember the resource right in front of the signal, so it doesn't matter who deallocates it
+        auto address = memory + header;
+        reinterpret_cast<pmr::memory_resource**>(address)[-1] = resource;
+        resourceAllocationBegin = address;
+        resourceAllocationEnd = address + size;
+        return address;
+    }
+    
+    void SignalBase::deallocate(void* address, size_t size, size_t alignment)
+    {
+        if (!isFromResource(address, size))
+        {
+            ::operator delete(address, size, align_val_t(alignment));
+            return;
+        }
+        
+        const auto header = headerSize(alignment);
+        auto resource = reinterpret_cast<pmr::memory_resource**>(address)[-1];
+        resource->deallocate(static_cast<char*>(address) - header, header + size, alignment);
+    }
 }
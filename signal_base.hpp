@@ -29,16 +29,26 @@
 #ifndef OCTOPUS_SIGNAL_BASE_HPP
 #define OCTOPUS_SIGNAL_BASE_HPP
 
-#include <set>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
 #include <typeinfo>
+#include <utility>
+#include <vector>
 
 #include "sink.hpp"
+#include "small_set.hpp"
 
 namespace octo
 {
     //! Base class for all signals in Octopus, regardless of their output type
     class SignalBase : public Sink
     {
+        friend class GraphOptimizer;
+    
     public:
         //! Construct the signal base
         SignalBase(Clock* clock);
@@ -46,6 +56,17 @@ namespace octo
         //! Virtual destructor, because this is a polymorphic base class
         virtual ~SignalBase();
         
+        //! Allocate a signal
+        /*! Inside a GraphArena::Scope, signals are allocated from the memory resource of the scope.
+            The resource is remembered in front of those signals, so they can be deallocated from anywhere.
+            Other signals are allocated with the global operator new, without any overhead. */
+        static void* operator new(std::size_t size) { return allocate(size, alignof(std::max_align_t)); }
+        static void* operator new(std::size_t size, std::align_val_t alignment) { return allocate(size, static_cast<std::size_t>(alignment)); }
+        
+        //! Deallocate a signal
+        static void operator delete(void* address, std::size_t size) { deallocate(address, size, alignof(std::max_align_t)); }
+        static void operator delete(void* address, std::size_t size, std::align_val_t alignment) { deallocate(address, size, static_cast<std::size_t>(alignment)); }
+        
         //! Retrieve the type info of the output
         virtual const std::type_info& getTypeInfo() const = 0;
         
@@ -56,13 +77,162 @@ namespace octo
         //! Have all signals that depend on this one disconnect
         void disconnectDependees();
         
+        //! Return the signals this signal pulls from
+        /*! Used for analysing the graph (e.g. by GraphCompiler). Signals that don't report their
+            dependencies are treated as leaves, and keep pulling them recursively themselves. */
+        virtual std::vector<SignalBase*> getDependencies() { return {}; }
+        
+        //! Return the signals this signal pulls, as seen by the thread assigning to values
+        /*! Used for analysing the graph away from the thread pulling it (e.g. by GraphCompiler). Values
+            return the signal they were last assigned, other signals equal getDependencies(). */
+        virtual std::vector<SignalBase*> getAssignedDependencies() { return getDependencies(); }
+        
+        //! Keep the signals returned by getAssignedDependencies() alive for as long as the pin is held
+        /*! Values delete their internal signal once it's replaced, but execution plans may still be
+            updating it on another thread. Plans hold on to pins until they're no longer run. */
+        virtual std::shared_ptr<void> pinAssigned() { return nullptr; }
+        
+        //! Return the signals this signal actually pulls, taking optimizations into account
+        /*! Folded signals pull nothing, and signals passing through another signal only pull that one
+            (see GraphOptimizer). Otherwise this equals getDependencies(). */
+        std::vector<SignalBase*> getActiveDependencies();
+        
+        //! Does the output only depend on the current samples of the dependencies?
+        /*! Pure signals of which all dependencies are constant are folded into constants by GraphOptimizer.
+            Signals that keep state, depend on time or don't report all of their dependencies should
+            return false (the default). */
+        virtual bool isPure() const { return false; }
+        
+        //! Optimize the signal, assuming its dependencies have been optimized already (see GraphOptimizer)
+        /*! @param constantDependencies Have all dependencies been folded into constants? */
+        virtual void optimize(bool constantDependencies) { }
+        
+        //! Undo the optimizations made by optimize()
+        virtual void deoptimize() { }
+        
+        //! Has the signal been folded into a constant by GraphOptimizer?
+        bool isFolded() const { return folded; }
+        
+        //! Return the signal whose output this signal passes through unchanged, if any (see GraphOptimizer)
+        SignalBase* getPassThrough() const { return passThrough; }
+        
+        //! Does this signal compute the same function of its dependencies as another signal?
+        /*! Used to share pure signals with identical inputs (see GraphOptimizer and SignalPool). The default
+            compares the types of both signals. Signals with parameters besides their dependencies should
+            compare those as well. */
+        virtual bool isSameOperation(const SignalBase& other) const { return typeid(*this) == typeid(other); }
+        
+        //! Return a hash that's equal for signals performing the same operation (see isSameOperation())
+        /*! The default hashes the type. Signals comparing parameters should mix those in (see combineHashes()). */
+        virtual std::size_t hashOperation() const { return typeid(*this).hash_code(); }
+        
+        //! Return the signal whose output this signal relays, as seen by the thread pulling it
+        /*! Values return the signal they refer to (see Value::pullSource()), other signals return themselves. */
+        virtual SignalBase* pullRelayed() { return this; }
+        
+        //! Are this and another signal folded into the same constant?
+        virtual bool hasSameConstant(SignalBase& other) { return false; }
+        
+        //! Return a hash that's equal for signals folded into the same constant (see hasSameConstant())
+        virtual std::size_t hashConstant() const { return 0; }
+        
+        //! Does this signal output the same as another one, as seen by the thread assigning to them?
+        /*! Values holding equal constants or referring to the same signal are the same. Other signals
+            are only the same as themselves. */
+        virtual bool isSameInput(const SignalBase& other) const { return this == &other; }
+        
+        //! Return a hash that's equal for signals that are the same input (see isSameInput())
+        virtual std::size_t hashInput() const { return std::hash<const SignalBase*>()(this); }
+        
+        //! Mix a hash into another one (e.g. the hashes of the inputs into the hash of an operation)
+        static std::size_t combineHashes(std::size_t seed, std::size_t hash) { return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2)); }
+        
+        //! Return a number that changes whenever the output of the signal may have changed
+        /*! Used for incremental evaluation (see Clock::setIncremental()). Outside of incremental mode,
+            the revision changes with every generated sample. */
+        uint64_t getRevision() const { return revision; }
+        
+        //! Return the number of bytes the signal occupies, including the memory it owns on the heap
+        /*! Other signals owned by this one (e.g. the internal signal of a Value) aren't included, they count
+            as signals of their own (see GraphFootprint). */
+        std::size_t getFootprint() const { return getSize() + getHeapSize(); }
+        
+        //! Return the size of the signal object itself
+        /*! Generated by GENERATE_MOVE, signals without it report the size of their base class. */
+        virtual std::size_t getSize() const { return sizeof(SignalBase); }
+        
+        //! Return the number of bytes the signal owns on the heap, not counting other signals
+        virtual std::size_t getHeapSize() const;
+    
     public:
         //! The signals that depend on this signal
-        std::set<SignalBase*> dependees;
+        SmallSet<SignalBase*> dependees;
         
+    protected:
+        //! Has the signal been folded into a constant?
+        bool folded = false;
+        
+    private:
+        //! Remembers whether a signal was allocated from a memory resource (see allocate())
+        /*! Set by the constructor, for the first signal constructed within the memory allocate() just handed
+            out from a resource. The destructor hands it to the deallocate() call for that memory. */
+        struct Allocation
+        {
+            Allocation();
+            
+            //! Copies are allocated separately
+            Allocation(const Allocation&) : Allocation() { }
+            
+            //! Assigning to a signal doesn't move it
+            Allocation& operator=(const Allocation&) { return *this; }
+            
+            ~Allocation();
+            
+            //! Was the signal allocated from a memory resource?
+            bool fromResource = false;
+        };
+        
+        //! How the signal was allocated
+        Allocation allocation;
+    
+    protected:
+        //! The signal whose output is passed through, if any
+        SignalBase* passThrough = nullptr;
+        
+        //! The revision of the output (see getRevision())
+        uint64_t revision = 0;
+    
+    protected:
+        //! The dependencies of a signal in incremental mode, along with their revisions as of the last update
+        struct ObservedDependencies
+        {
+            //! The dependencies and their revisions
+            std::vector<std::pair<SignalBase*, uint64_t>> dependencies;
+            
+            //! The graph epoch at which the dependencies were gathered
+            uint64_t epoch = std::numeric_limits<uint64_t>::max();
+        };
+    
+    protected:
+        //! Update the dependencies, and return whether any of their outputs changed since the last call
+        /*! Used for incremental evaluation. The dependencies are gathered again whenever the graph changes,
+            in which case they count as changed.
+            @param observed The dependencies as of the last call, stored by the caller (see Signal) */
+        bool updateDependencies(ObservedDependencies& observed);
+    
     private:
         //! Called when a dependent asks not to depend on it anymore (e.g. it is being destroyed)
         virtual void disconnectFromDependent(SignalBase& dependent) { }
+        
+        //! Pure signals of which all dependencies are memoizable have a constant output (see Sink::isMemoizable())
+        /*! Subtrees deeper than a few dozen signals, and with them feedback loops, are assumed not to be. */
+        bool hasConstantOutput() override;
+        
+        //! Allocate memory for a signal, from the current memory resource if any
+        static void* allocate(std::size_t size, std::size_t alignment);
+        
+        //! Deallocate memory of a signal allocated with allocate()
+        static void deallocate(void* address, std::size_t size, std::size_t alignment);
     };
 }
 
@@ -0,0 +1,77 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include "signal_base.hpp"
+#include "signal_pool.hpp"
+
+namespace octo
+{
+    void SignalPool::clear()
+    {
+        shareable.clear();
+        
+        // Destroy the signals in reverse order, so that signals go before the signals they depend on
+        while (!signals.empty())
+            signals.pop_back();
+    }
+    
+    SignalBase& SignalPool::share(std::unique_ptr<SignalBase> signal)
+    {
+        auto& result = *signal;
+        if (!signal->isPure())
+        {
+            signals.emplace_back(std::move(signal));
+            return result;
+        }
+        
+        // Signals are hashed by operation and inputs, so only identical signals (and rare collisions) are compared
+        auto dependencies = signal->getAssignedDependencies();
+        auto key = signal->hashOperation();
+        for (auto& dependency : dependencies)
+            key = SignalBase::combineHashes(key, dependency->hashInput());
+        
+        const auto range = shareable.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            auto& candidate = it->second;
+            if (candidate.dependencies.size() != dependencies.size() || !candidate.signal->isSameOperation(*signal))
+                continue;
+            
+            bool same = true;
+            for (std::size_t i = 0; i < dependencies.size() && same; ++i)
+                same = candidate.dependencies[i]->isSameInput(*dependencies[i]);
+            
+            if (same)
+                return *candidate.signal;
+        }
+        
+        shareable.emplace(key, Shareable{&result, std::move(dependencies)});
+        signals.emplace_back(std::move(signal));
+        return result;
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_SIGNAL_POOL_HPP
+#define OCTOPUS_SIGNAL_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "signal.hpp"
+
+namespace octo
+{
+    class SignalBase;
+    
+    //! Owns signals, handing out a shared one for every structurally identical signal interned
+    /*! Building the same subexpression more than once normally results in multiple signals, each of
+        which is computed every tick. Interning signals in a pool (also known as hash-consing) returns
+        a signal that was interned earlier if it performs the same operation on the same inputs (see
+        SignalBase::isSameOperation() and SignalBase::isSameInput()), and discards the new one.
+        
+        @code
+        SignalPool pool;
+        auto& a = pool.intern(x * y);
+        auto& b = pool.intern(x * y); // &a == &b
+        @endcode
+        
+        Inputs are compared as they were assigned, so a signal whose inputs are reassigned afterwards is
+        not interned again. Only pure signals (see SignalBase::isPure()) are shared, other signals are
+        always stored as is. Interned signals live as long as the pool, or until it is cleared. For graphs
+        that weren't built through a pool, GraphOptimizer shares identical signals as well. */
+    class SignalPool
+    {
+    public:
+        SignalPool() = default;
+        SignalPool(const SignalPool&) = delete;
+        SignalPool& operator=(const SignalPool&) = delete;
+        
+        //! Intern a signal by moving it into the pool
+        template <class T>
+        Signal<T>& intern(Signal<T>&& signal)
+        {
+            return intern(std::move(signal).moveToHeap());
+        }
+        
+        //! Intern a signal living on the heap
+        template <class T>
+        Signal<T>& intern(std::unique_ptr<Signal<T>> signal)
+        {
+            if (!signal)
+                throw std::invalid_argument("interning nullptr");
+            
+            // Signals performing the same operation have the same type, so the static cast is safe
+            return static_cast<Signal<T>&>(share(std::move(signal)));
+        }
+        
+        //! Return the number of signals in the pool
+        std::size_t size() const { return signals.size(); }
+        
+        //! Destroy all signals in the pool
+        /*! Make sure none of them are still referred to. */
+        void clear();
+    
+    private:
+        //! A pure signal that can be shared
+        struct Shareable
+        {
+            //! The signal
+            SignalBase* signal = nullptr;
+            
+            //! The dependencies of the signal, as it was interned
+            std::vector<SignalBase*> dependencies;
+        };
+    
+    private:
+        //! Return the pooled signal identical to a given signal, or store the signal if there is none
+        SignalBase& share(std::unique_ptr<SignalBase> signal);
+    
+    private:
+        //! The signals owned by the pool
+        std::vector<std::unique_ptr<SignalBase>> signals;
+        
+        //! The pure signals that can be shared, by the hash of their operation and inputs
+        std::unordered_multimap<std::size_t, Shareable> shareable;
+    };
+}
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "simd.hpp"
+
+// Vector registers are used through the vector extensions of GCC and Clang, of which the
+// width (and target) are picked per instruction set. Other compilers get plain loops.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OCTOPUS_SIMD_X86 1
+#endif
+
+namespace octo
+{
+    namespace simd
+    {
+        namespace scalar
+        {
+            #define OCTOPUS_SIMD_WIDTH 0
+            #include "simd_kernels.hpp"
+            #undef OCTOPUS_SIMD_WIDTH
+        }
+    
+    #if OCTOPUS_SIMD_X86
+        #pragma GCC push_options
+        #pragma GCC target("sse2")
+        namespace sse2
+        {
+            #define OCTOPUS_SIMD_WIDTH 16
+            #include "simd_kernels.hpp"
+            #undef OCTOPUS_SIMD_WIDTH
+        }
+        #pragma GCC pop_options
+        
+        #pragma GCC push_options
+        #pragma GCC target("avx2")
+        namespace avx2
+        {
+            #define OCTOPUS_SIMD_WIDTH 32
+            #include "simd_kernels.hpp"
+            #undef OCTOPUS_SIMD_WIDTH
+        }
+        #pragma GCC pop_options
+        
+        #pragma GCC push_options
+        #pragma GCC target("avx512f")
+        namespace avx512
+        {
+            #define OCTOPUS_SIMD_WIDTH 64
+            #include "simd_kernels.hpp"
+            #undef OCTOPUS_SIMD_WIDTH
+        }
+        #pragma GCC pop_options
+    #endif
+        
+        //! The kernels of every instruction set for a single sample type
+        template <class T>
+        struct KernelSet
+        {
+            const Kernels<T> scalar = scalar::makeKernels<T>();
+        #if OCTOPUS_SIMD_X86
+            const Kernels<T> sse2 = sse2::makeKernels<T>();
+            const Kernels<T> avx2 = avx2::makeKernels<T>();
+            const Kernels<T> avx512 = avx512::makeKernels<T>();
+        #endif
+            
+            //! Return the kernels for an instruction set
+            constexpr const Kernels<T>& get(InstructionSet instructionSet) const
+            {
+                switch (instructionSet)
+                {
+                #if OCTOPUS_SIMD_X86
+                    case InstructionSet::SSE2: return sse2;
+                    case InstructionSet::AVX2: return avx2;
+                    case InstructionSet::AVX512: return avx512;
+                #endif
+                    default: return scalar;
+                }
+            }
+        };
+        
+        //! The kernels of every instruction set for all sample types
+        /*! Constant-initialized, so they can be used before dynamic initialization has run */
+        static constexpr KernelSet<float> floatKernels{};
+        static constexpr KernelSet<double> doubleKernels{};
+        static constexpr KernelSet<std::int32_t> int32Kernels{};
+        static constexpr KernelSet<std::int64_t> int64Kernels{};
+        
+        //! The kernels currently used, per sample type
+        static std::atomic<const Kernels<float>*> currentFloatKernels{nullptr};
+        static std::atomic<const Kernels<double>*> currentDoubleKernels{nullptr};
+        static std::atomic<const Kernels<std::int32_t>*> currentInt32Kernels{nullptr};
+        static std::atomic<const Kernels<std::int64_t>*> currentInt64Kernels{nullptr};
+        
+        //! The instruction set currently used
+        static std::atomic<InstructionSet> currentInstructionSet{InstructionSet::SCALAR};
+        
+        InstructionSet getSupportedInstructionSet()
+        {
+        #if OCTOPUS_SIMD_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+                return InstructionSet::AVX512;
+            if (__builtin_cpu_supports("avx2"))
+                return InstructionSet::AVX2;
+            if (__builtin_cpu_supports("sse2"))
+                return InstructionSet::SSE2;
+        #endif
+            
+            return InstructionSet::SCALAR;
+        }
+        
+        void setInstructionSet(InstructionSet instructionSet)
+        {
+            if (instructionSet > getSupportedInstructionSet())
+                throw std::invalid_argument(std::string("instruction set ") + getName(instructionSet) + " is not supported by this cpu");
+            
+            currentInstructionSet = instructionSet;
+            currentFloatKernels = &floatKernels.get(instructionSet);
+            currentDoubleKernels = &doubleKernels.get(instructionSet);
+            currentInt32Kernels = &int32Kernels.get(instructionSet);
+            currentInt64Kernels = &int64Kernels.get(instructionSet);
+        }
+        
+        //! Return the kernels currently used for a sample type
+        template <class T>
+        static const Kernels<T>& getCurrent(const std::atomic<const Kernels<T>*>& kernels)
+        {
+            // Pick the widest supported instruction set the first time kernels are used
+            auto current = kernels.load(std::memory_order_relaxed);
+            if (!current)
+            {
+                setInstructionSet(getSupportedInstructionSet());
+                current = kernels.load(std::memory_order_relaxed);
+            }
+            
+            return *current;
+        }
+        
+        InstructionSet getInstructionSet()
+        {
+            return currentInstructionSet;
+        }
+        
+        const char* getName(InstructionSet instructionSet)
+        {
+            switch (instructionSet)
+            {
+                case InstructionSet::SCALAR: return "scalar";
+                case InstructionSet::SSE2: return "sse2";
+                case InstructionSet::AVX2: return "avx2";
+                case InstructionSet::AVX512: return "avx512";
+            }
+            
+            return "unknown";
+        }
+        
+        template <>
+        const Kernels<float>& getKernels<float>()
+        {
+            return getCurrent(currentFloatKernels);
+        }
+        
+        template <>
+        const Kernels<double>& getKernels<double>()
+        {
+            return getCurrent(currentDoubleKernels);
+        }
+        
+        template <>
+        const Kernels<std::int32_t>& getKernels<std::int32_t>()
+        {
+            return getCurrent(currentInt32Kernels);
+        }
+        
+        template <>
+        const Kernels<std::int64_t>& getKernels<std::int64_t>()
+        {
+            return getCurrent(currentInt64Kernels);
+        }
+    }
+}
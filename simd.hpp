@@ -0,0 +1,254 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_SIMD_HPP
+#define OCTOPUS_SIMD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace octo
+{
+    //! Vectorized kernels for processing blocks of samples
+    /*! The kernels are compiled for several instruction sets, of which the widest one supported by
+        the CPU is picked at runtime. Sample types without compiled kernels fall back to plain loops. */
+    namespace simd
+    {
+        //! The instruction sets kernels are compiled for
+        enum class InstructionSet
+        {
+            SCALAR,
+            SSE2,
+            AVX2,
+            AVX512
+        };
+        
+        //! Return the instruction set kernels currently run with
+        InstructionSet getInstructionSet();
+        
+        //! Return the widest instruction set supported by the CPU
+        InstructionSet getSupportedInstructionSet();
+        
+        //! Change the instruction set kernels run with (e.g. for comparing them)
+        /*! @throw std::invalid_argument if the CPU doesn't support the instruction set */
+        void setInstructionSet(InstructionSet instructionSet);
+        
+        //! Return the name of an instruction set
+        const char* getName(InstructionSet instructionSet);
+        
+        //! Does a sample type have vectorized kernels?
+        template <class T>
+        struct IsVectorizable : std::integral_constant<bool,
+            std::is_same<T, float>::value || std::is_same<T, double>::value ||
+            std::is_same<T, std::int32_t>::value || std::is_same<T, std::int64_t>::value> { };
+        
+        //! The kernels for a single sample type
+        template <class T>
+        struct Kernels
+        {
+            void (*add)(const T* lhs, const T* rhs, T* out, std::size_t size);
+            void (*addScalar)(const T* lhs, T rhs, T* out, std::size_t size);
+            void (*subtract)(const T* lhs, const T* rhs, T* out, std::size_t size);
+            void (*subtractScalar)(const T* lhs, T rhs, T* out, std::size_t size);
+            void (*subtractFromScalar)(T lhs, const T* rhs, T* out, std::size_t size);
+            void (*multiply)(const T* lhs, const T* rhs, T* out, std::size_t size);
+            void (*multiplyScalar)(const T* lhs, T rhs, T* out, std::size_t size);
+            void (*divide)(const T* lhs, const T* rhs, T* out, std::size_t size);
+            void (*divideScalar)(const T* lhs, T rhs, T* out, std::size_t size);
+            void (*divideScalarBy)(T lhs, const T* rhs, T* out, std::size_t size);
+            void (*negate)(const T* in, T* out, std::size_t size);
+            void (*sum)(const T* const* inputs, std::size_t count, T offset, T* out, std::size_t size);
+            void (*product)(const T* const* inputs, std::size_t count, T scale, T* out, std::size_t size);
+        };
+        
+        //! Return the kernels for the current instruction set
+        template <class T>
+        const Kernels<T>& getKernels();
+        
+        template <> const Kernels<float>& getKernels<float>();
+        template <> const Kernels<double>& getKernels<double>();
+        template <> const Kernels<std::int32_t>& getKernels<std::int32_t>();
+        template <> const Kernels<std::int64_t>& getKernels<std::int64_t>();
+        
+        //! out = lhs + rhs
+        template <class T>
+        void add(const T* lhs, const T* rhs, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().add(lhs, rhs, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = lhs[i] + rhs[i];
+        }
+        
+        //! out = lhs + rhs, with a scalar rhs
+        template <class T>
+        void add(const T* lhs, const T& rhs, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().addScalar(lhs, rhs, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = lhs[i] + rhs;
+        }
+        
+        //! out = lhs - rhs
+        template <class T>
+        void subtract(const T* lhs, const T* rhs, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().subtract(lhs, rhs, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = lhs[i] - rhs[i];
+        }
+        
+        //! out = lhs - rhs, with a scalar rhs
+        template <class T>
+        void subtract(const T* lhs, const T& rhs, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().subtractScalar(lhs, rhs, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = lhs[i] - rhs;
+        }
+        
+        //! out = lhs - rhs, with a scalar lhs
+        template <class T>
+        void subtract(const T& lhs, const T* rhs, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().subtractFromScalar(lhs, rhs, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = lhs - rhs[i];
+        }
+        
+        //! out = lhs * rhs
+        template <class T>
+        void multiply(const T* lhs, const T* rhs, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().multiply(lhs, rhs, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = lhs[i] * rhs[i];
+        }
+        
+        //! out = lhs * rhs, with a scalar rhs
+        template <class T>
+        void multiply(const T* lhs, const T& rhs, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().multiplyScalar(lhs, rhs, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = lhs[i] * rhs;
+        }
+        
+        //! out = lhs / rhs
+        template <class T>
+        void divide(const T* lhs, const T* rhs, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().divide(lhs, rhs, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = lhs[i] / rhs[i];
+        }
+        
+        //! out = lhs / rhs, with a scalar rhs
+        template <class T>
+        void divide(const T* lhs, const T& rhs, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().divideScalar(lhs, rhs, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = lhs[i] / rhs;
+        }
+        
+        //! out = lhs / rhs, with a scalar lhs
+        template <class T>
+        void divide(const T& lhs, const T* rhs, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().divideScalarBy(lhs, rhs, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = lhs / rhs[i];
+        }
+        
+        //! out = -in
+        template <class T>
+        void negate(const T* in, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().negate(in, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = -in[i];
+        }
+        
+        //! out = offset + inputs[0] + inputs[1] + ...
+        /*! The inputs are accumulated in registers, a few vectors at a time, so out is only written once */
+        template <class T>
+        void sum(const T* const* inputs, std::size_t count, const T& offset, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().sum(inputs, count, offset, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                out[i] = offset;
+                for (std::size_t input = 0; input < count; ++input)
+                    out[i] = out[i] + inputs[input][i];
+            }
+        }
+        
+        //! out = scale * inputs[0] * inputs[1] * ...
+        /*! The inputs are accumulated in registers, a few vectors at a time, so out is only written once */
+        template <class T>
+        void product(const T* const* inputs, std::size_t count, const T& scale, T* out, std::size_t size)
+        {
+            if constexpr (IsVectorizable<T>::value)
+                return getKernels<T>().product(inputs, count, scale, out, size);
+            
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                out[i] = scale;
+                for (std::size_t input = 0; input < count; ++input)
+                    out[i] = out[i] * inputs[input][i];
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Kernels for one instruction set. This file is included by simd.cpp once per instruction set,
+// each time in its own namespace and with OCTOPUS_SIMD_WIDTH set to the width of its vector
+// registers in bytes (0 for plain loops). It deliberately has no include guard.
+
+template <class T>
+struct Lanes
+{
+#if OCTOPUS_SIMD_WIDTH
+    //! A vector register filled with samples
+    typedef T Vector __attribute__((vector_size(OCTOPUS_SIMD_WIDTH)));
+    
+    //! The number of samples in a vector
+    static constexpr std::size_t count = OCTOPUS_SIMD_WIDTH / sizeof(T);
+    
+    //! Load a vector from unaligned memory
+    static Vector load(const T* address)
+    {
+        Vector vector;
+        std::memcpy(&vector, address, sizeof(Vector));
+        return vector;
+    }
+    
+    //! Store a vector to unaligned memory
+    static void store(T* address, const Vector& vector) { std::memcpy(address, &vector, sizeof(Vector)); }
+    
+    //! Fill a vector with a single sample
+    static Vector broadcast(T value) { return Vector{} + value; }
+#else
+    //! Without vector registers, a sample is processed at a time
+    typedef T Vector;
+    
+    //! The number of samples in a vector
+    static constexpr std::size_t count = 1;
+    
+    static Vector load(const T* address) { return *address; }
+    static void store(T* address, const Vector& vector) { *address = vector; }
+    static Vector broadcast(T value) { return value; }
+#endif
+};
+
+//! Apply an operation on every sample of one or two blocks
+template <class T, class Operation, class... Inputs>
+static void transform(T* out, std::size_t size, Operation operation, Inputs... inputs)
+{
+    using L = Lanes<T>;
+    
+    std::size_t i = 0;
+    for (; i + L::count <= size; i += L::count)
+        L::store(out + i, operation(L::load(inputs + i)...));
+    
+    for (; i < size; ++i)
+        out[i] = operation(inputs[i]...);
+}
+
+template <class T>
+static void add(const T* lhs, const T* rhs, T* out, std::size_t size)
+{
+    transform(out, size, [](auto a, auto b){ return a + b; }, lhs, rhs);
+}
+
+template <class T>
+static void addScalar(const T* lhs, T rhs, T* out, std::size_t size)
+{
+    transform(out, size, [rhs](auto a){ return a + rhs; }, lhs);
+}
+
+template <class T>
+static void subtract(const T* lhs, const T* rhs, T* out, std::size_t size)
+{
+    transform(out, size, [](auto a, auto b){ return a - b; }, lhs, rhs);
+}
+
+template <class T>
+static void subtractScalar(const T* lhs, T rhs, T* out, std::size_t size)
+{
+    transform(out, size, [rhs](auto a){ return a - rhs; }, lhs);
+}
+
+template <class T>
+static void subtractFromScalar(T lhs, const T* rhs, T* out, std::size_t size)
+{
+    transform(out, size, [lhs](auto b){ return lhs - b; }, rhs);
+}
+
+template <class T>
+static void multiply(const T* lhs, const T* rhs, T* out, std::size_t size)
+{
+    transform(out, size, [](auto a, auto b){ return a * b; }, lhs, rhs);
+}
+
+template <class T>
+static void multiplyScalar(const T* lhs, T rhs, T* out, std::size_t size)
+{
+    transform(out, size, [rhs](auto a){ return a * rhs; }, lhs);
+}
+
+template <class T>
+static void divide(const T* lhs, const T* rhs, T* out, std::size_t size)
+{
+    transform(out, size, [](auto a, auto b){ return a / b; }, lhs, rhs);
+}
+
+template <class T>
+static void divideScalar(const T* lhs, T rhs, T* out, std::size_t size)
+{
+    transform(out, size, [rhs](auto a){ return a / rhs; }, lhs);
+}
+
+template <class T>
+static void divideScalarBy(T lhs, const T* rhs, T* out, std::size_t size)
+{
+    transform(out, size, [lhs](auto b){ return lhs / b; }, rhs);
+}
+
+template <class T>
+static void negate(const T* in, T* out, std::size_t size)
+{
+    transform(out, size, [](auto a){ return -a; }, in);
+}
+
+//! Fold all inputs into the output, keeping four vectors of each frame in registers
+template <class T, class Operation>
+static void accumulate(const T* const* inputs, std::size_t count, T initial, T* out, std::size_t size, Operation operation)
+{
+    using L = Lanes<T>;
+    constexpr auto stride = L::count * 4;
+    const auto init = L::broadcast(initial);
+    
+    std::size_t i = 0;
+    for (; i + stride <= size; i += stride)
+    {
+        auto a = init, b = init, c = init, d = init;
+        for (std::size_t input = 0; input < count; ++input)
+        {
+            const auto in = inputs[input] + i;
+            a = operation(a, L::load(in));
+            b = operation(b, L::load(in + L::count));
+            c = operation(c, L::load(in + L::count * 2));
+            d = operation(d, L::load(in + L::count * 3));
+        }
+        
+        L::store(out + i, a);
+        L::store(out + i + L::count, b);
+        L::store(out + i + L::count * 2, c);
+        L::store(out + i + L::count * 3, d);
+    }
+    
+    for (; i + L::count <= size; i += L::count)
+    {
+        auto a = init;
+        for (std::size_t input = 0; input < count; ++input)
+            a = operation(a, L::load(inputs[input] + i));
+        
+        L::store(out + i, a);
+    }
+    
+    for (; i < size; ++i)
+    {
+        auto a = initial;
+        for (std::size_t input = 0; input < count; ++input)
+            a = operation(a, inputs[input][i]);
+        
+        out[i] = a;
+    }
+}
+
+template <class T>
+static void sum(const T* const* inputs, std::size_t count, T offset, T* out, std::size_t size)
+{
+    accumulate(inputs, count, offset, out, size, [](auto a, auto b){ return a + b; });
+}
+
+template <class T>
+static void product(const T* const* inputs, std::size_t count, T scale, T* out, std::size_t size)
+{
+    accumulate(inputs, count, scale, out, size, [](auto a, auto b){ return a * b; });
+}
+
+//! Return the kernels of this instruction set
+template <class T>
+constexpr Kernels<T> makeKernels()
+{
+    return {add<T>, addScalar<T>, subtract<T>, subtractScalar<T>, subtractFromScalar<T>,
+            multiply<T>, multiplyScalar<T>, divide<T>, divideScalar<T>, divideScalarBy<T>,
+            negate<T>, sum<T>, product<T>};
+}
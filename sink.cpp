@@ -27,12 +27,28 @@
  */
 
 #include <stdexcept>
+#include <thread>
 
 #include "clock.hpp"
+#include "profiler.hpp"
+#include "realtime_checker.hpp"
 #include "sink.hpp"
+#include "tracer.hpp"
 
 namespace octo
 {
+    //! The graph modification epoch
+    static std::atomic<uint64_t> graphEpoch{0};
+    
+    //! The number of parties that need the sinks this thread updates to be updated concurrently
+    static thread_local std::size_t concurrentUpdates = 0;
+    
+    //! The addresses of thread-locals identify the calling thread (see Sink::owner)
+    /*! A sink owned by its updating thread is being updated, one owned by its claiming thread was claimed
+        (see Sink::claim()) and is updated by that thread only. */
+    static thread_local const char updatingThread = 0;
+    static thread_local const char claimingThread = 0;
+    
     Sink::Sink(Clock* clock) :
         clock(clock)
     {
@@ -40,49 +56,215 @@ namespace octo
             timestamp = clock->now();
     }
     
+    Sink::Sink(const Sink& rhs) :
+        sinkListeners(rhs.sinkListeners),
+        clock(rhs.getClock()),
+        timestamp(rhs.timestamp.load(std::memory_order_relaxed)),
+        started(rhs.started.load(std::memory_order_relaxed))
+    {
+    
+    }
+    
+    Sink& Sink::operator=(const Sink& rhs)
+    {
+        sinkListeners = rhs.sinkListeners;
+        clock.store(rhs.getClock(), std::memory_order_relaxed);
+        timestamp.store(rhs.timestamp.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        started.store(rhs.started.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+    
+    Sink::~Sink()
+    {
+        // Make sure the clock doesn't hold on to us (only touch its set of persistent sinks when
+        // needed, so temporaries can be destroyed while the clock is ticking on another thread)
+        auto clock = getClock();
+        if (clock && clock->isSinkPersistent(*this))
+            clock->removePersistentSink(*this);
+        
+    #ifdef OCTOPUS_PROFILING
+        Profiler::forget(*this);
+    #endif
+    }
+    
     void Sink::update()
     {
+        if (concurrentUpdates != 0)
+            return updateConcurrently();
+        
+        // Sinks without a clock use the graph epoch instead, but only those with a constant
+        // output (see isMemoizable()) get to skip updates until it changes
+        auto clock = getClock();
+        const auto now = clock ? clock->renderTime() : getGraphEpoch();
+        
+        // Do we need updating? (Blocks rendered sample-by-sample may have
+        // moved the timestamp ahead of the clock, so look for an exact match)
+        const bool upToDate = timestamp.load(std::memory_order_relaxed) == now && started.load(std::memory_order_relaxed);
+        if (upToDate && (clock || memoized.load(std::memory_order_relaxed)))
+        {
+        #ifdef OCTOPUS_PROFILING
+            Profiler::recordHit(*this);
+        #endif
+            return;
+        }
+        
+        if (!upToDate)
+        {
+            started.store(true, std::memory_order_relaxed);
+            timestamp.store(now, std::memory_order_relaxed);
+            memoized.store(false, std::memory_order_relaxed);
+        }
+        
+        {
+        #ifdef OCTOPUS_PROFILING
+            Profiler::Scope profile(*this);
+        #endif
+        #ifdef OCTOPUS_TRACING
+            Tracer::Scope trace(*this);
+        #endif
+        #ifdef OCTOPUS_REALTIME_CHECKS
+            RealTimeChecker::UpdateScope check(*this);
+        #endif
+            onUpdate();
+        }
+        
+        // Decide after the update, when the dependencies have decided for themselves already
+        if (!clock && !upToDate)
+            memoized.store(hasConstantOutput(), std::memory_order_relaxed);
+    }
+    
+    void Sink::updateBlock(std::size_t size)
+    {
+        auto clock = getClock();
         if (!clock)
-            return onUpdate();
+            return update();
         
-        const auto now = clock->now();
+        const auto offset = clock->getRenderOffset();
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            clock->setRenderOffset(offset + i);
+            update();
+        }
         
-        // Do we need updating?
-        if (timestamp >= now && started)
+        clock->setRenderOffset(offset);
+    }
+    
+    void Sink::updateConcurrently()
+    {
+        // A feedback loop pulling the sink from within its own update gets the previous sample,
+        // just like it would in a single-threaded update
+        const auto current = owner.load(std::memory_order_relaxed);
+        if (current == &updatingThread)
             return;
         
-        started = true;
-        timestamp = now;
-        onUpdate();
+        // Blocks claimed by this thread are rendered frame by frame through here, without waiting for ourselves
+        const bool claimed = current == &claimingThread;
+        
+        auto clock = getClock();
+        const auto now = clock ? clock->renderTime() : getGraphEpoch();
+        
+        // Once another thread has finished updating the sink, its output can be read directly
+        auto isUpToDate = [&]
+        {
+            return timestamp.load(std::memory_order_acquire) == now && owner.load(std::memory_order_acquire) == nullptr &&
+                started.load(std::memory_order_relaxed) && (clock || memoized.load(std::memory_order_relaxed));
+        };
+        
+        if (!claimed && isUpToDate())
+        {
+        #ifdef OCTOPUS_PROFILING
+            Profiler::recordHit(*this);
+        #endif
+            return;
+        }
+        
+        // Claim the sink, unless another thread brings it up to date while we're waiting
+        const void* expected = claimed ? &claimingThread : nullptr;
+        while (!owner.compare_exchange_weak(expected, &updatingThread, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            if (isUpToDate())
+            {
+            #ifdef OCTOPUS_PROFILING
+                Profiler::recordHit(*this);
+            #endif
+                return;
+            }
+            
+            expected = claimed ? &claimingThread : nullptr;
+            std::this_thread::yield();
+        }
+        
+        const bool upToDate = timestamp.load(std::memory_order_relaxed) == now && started.load(std::memory_order_relaxed);
+        if (!upToDate || (!clock && !memoized.load(std::memory_order_relaxed)))
+        {
+            if (!upToDate)
+            {
+                started.store(true, std::memory_order_relaxed);
+                timestamp.store(now, std::memory_order_release);
+                memoized.store(false, std::memory_order_relaxed);
+            }
+            
+            {
+            #ifdef OCTOPUS_PROFILING
+                Profiler::Scope profile(*this);
+            #endif
+            #ifdef OCTOPUS_TRACING
+                Tracer::Scope trace(*this);
+            #endif
+            #ifdef OCTOPUS_REALTIME_CHECKS
+                RealTimeChecker::UpdateScope check(*this);
+            #endif
+                try
+                {
+                    onUpdate();
+                } catch (...) {
+                    // Let go, so other threads pulling the sink don't wait for it forever
+                    owner.store(claimed ? &claimingThread : nullptr, std::memory_order_release);
+                    throw;
+                }
+            }
+            
+            if (!clock && !upToDate)
+                memoized.store(hasConstantOutput(), std::memory_order_relaxed);
+        }
+        
+        owner.store(claimed ? &claimingThread : nullptr, std::memory_order_release);
     }
     
     void Sink::setClock(Clock* clock)
     {
-        if (clock == this->clock)
+        if (clock == getClock())
             return;
         
         // If we're persistent with the current clock, make the sink non-persistent
         bool persistent = isPersistent();
-        if (persistent && this->clock)
-            this->clock->removePersistentSink(*this);
+        if (persistent)
+            getClock()->removePersistentSink(*this);
         
         // Change the clock
-        this->clock = clock;
+        this->clock.store(clock, std::memory_order_relaxed);
+        graphChanged();
         
         const auto listeners = sinkListeners;
         
         // If we've moved to a new clock (instead of no clock at all), set some data
         if (clock)
         {
-            timestamp = clock->now();
+            timestamp.store(clock->now(), std::memory_order_relaxed);
             
             if (persistent)
-                this->clock->addPersistentSink(*this);
-        } else if (persistent) {
+                clock->addPersistentSink(*this);
+        } else {
+            // Without a clock, the timestamp holds the graph epoch of the last update instead
+            started.store(false, std::memory_order_relaxed);
+            
             // If we didn't move to a new clock, and lost persistency, let derivatives and listeners know
-            persistencyChanged(false);
-            for (auto& listener : listeners)
-                listener->persistencyChanged(false);
+            if (persistent)
+            {
+                persistencyChanged(false);
+                for (auto& listener : listeners)
+                    listener->persistencyChanged(false);
+            }
         }
     
         // Let derivatives and listeners know we moved to a new clock
@@ -93,6 +275,7 @@ namespace octo
     
     void Sink::setPersistency(bool persistent)
     {
+        auto clock = getClock();
         if (!clock)
             throw std::runtime_error("sink without clocks can't have their persistency set");
         
@@ -111,18 +294,93 @@ namespace octo
             listener->persistencyChanged(persistent);
     }
     
+    bool Sink::isMemoizable()
+    {
+        if (getClock())
+            return false;
+        
+        // Sinks that were updated in this epoch already know
+        if (started.load(std::memory_order_relaxed) && timestamp.load(std::memory_order_relaxed) == getGraphEpoch())
+            return memoized.load(std::memory_order_relaxed);
+        
+        return hasConstantOutput();
+    }
+    
     bool Sink::isPersistent() const
     {
+        auto clock = getClock();
         return clock ? clock->isSinkPersistent(*this) : false;
     }
     
     float Sink::rate() const
     {
+        auto clock = getClock();
         return clock ? clock->rate() : 0;
     }
     
     float Sink::delta() const
     {
+        auto clock = getClock();
         return clock ? clock->delta() : 0;
     }
+    
+    uint64_t Sink::getGraphEpoch()
+    {
+        return graphEpoch.load(std::memory_order_acquire);
+    }
+    
+    void Sink::bumpGraphEpoch()
+    {
+        graphEpoch.fetch_add(1, std::memory_order_acq_rel);
+    }
+    
+    void Sink::graphChanged()
+    {
+        bumpGraphEpoch();
+        Clock::rebuildPlans(plannedBy.load(std::memory_order_acquire));
+    }
+    
+    Sink::PlanScope::PlanScope(const Clock& clock) :
+        previous(planRun)
+    {
+        run.clock = &clock;
+        run.now = clock.now();
+        run.renderOffset = &clock.getRenderOffsetVariable();
+        planRun = &run;
+    }
+    
+    Sink::PlanScope::~PlanScope()
+    {
+        planRun = previous;
+    }
+    
+    void Sink::beginConcurrentUpdates()
+    {
+        ++concurrentUpdates;
+    }
+    
+    void Sink::endConcurrentUpdates()
+    {
+        --concurrentUpdates;
+    }
+    
+    bool Sink::isUpdatingConcurrently()
+    {
+        return concurrentUpdates != 0;
+    }
+    
+    bool Sink::claim()
+    {
+        const void* expected = nullptr;
+        while (!owner.compare_exchange_weak(expected, &claimingThread, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            if (expected == &updatingThread || expected == &claimingThread)
+                return false;
+            
+            expected = nullptr;
+            std::this_thread::yield();
+        }
+        
+        return true;
+    }
 }
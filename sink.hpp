@@ -29,8 +29,11 @@
 #ifndef OCTOPUS_SINK_HPP
 #define OCTOPUS_SINK_HPP
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
-#include <set>
+
+#include "small_set.hpp"
 
 namespace octo
 {
@@ -39,24 +42,39 @@ namespace octo
     //! Anything that needs updating according to a clock
     class Sink
     {
+        friend class Clock;
+        friend class Profiler;
+    
     public:
         class Listener;
+        class PlanScope;
         
     public:
         //! Construct the sink by specifying the clock to which it will listen
         Sink(Clock* clock);
         
+        //! Copy a sink
+        Sink(const Sink& rhs);
+        
+        //! Copy a sink
+        Sink& operator=(const Sink& rhs);
+        
         //! Virtual destructor, because this is a polymorphic base class
-        virtual ~Sink() = default;
+        virtual ~Sink();
         
         //! Make sure the sink is up to date with the clock it was given
         void update();
         
+        //! Update the sink for a number of consecutive frames, starting at the clock's render time
+        /*! Used by Clock::tick(std::size_t). The default implementation updates the sink frame by frame,
+            offsetting the render time of the clock. Signals override it to render a block at once. */
+        virtual void updateBlock(std::size_t size);
+        
         //! Change the clock
         void setClock(Clock* clock);
         
         //! Retrieve the clock this sink runs at
-        Clock* getClock() const { return clock; }
+        Clock* getClock() const { return clock.load(std::memory_order_relaxed); }
         
         //! Make this sink persistent
         void setPersistency(bool persistent);
@@ -64,9 +82,34 @@ namespace octo
         //! Is this sink persistent?
         bool isPersistent() const;
         
+        //! Does the output of the sink only change along with the graph, so it can be updated once per epoch?
+        /*! Only sinks without a clock qualify, and only if hasConstantOutput() says so. Other sinks without
+            a clock are updated every time they're pulled (see update()). */
+        bool isMemoizable();
+        
+        //! Return the graph modification epoch
+        /*! The epoch changes whenever the structure of any graph changes (e.g. a Value is reassigned or
+            a sink changes its clock). Sinks without a clock whose output is constant only update when it
+            changes (see isMemoizable()). Clocks keep an
+            epoch of their own for their graph (see Clock::getGraphEpoch()). */
+        static uint64_t getGraphEpoch();
+        
+        //! Let everyone know that the structure of a graph changed
+        static void bumpGraphEpoch();
+        
+        //! Make the updates of the calling thread safe for sinks being pulled from multiple threads at once
+        /*! Between a call to this function and its matching endConcurrentUpdates(), only one of the threads
+            that called it updates any given sink at a time. Other threads that called it and pull the same
+            sink wait until it is up to date. Used by the threads of a ParallelExecutor while they run a plan,
+            so threads ticking other clocks keep updating the plain way. Calls nest. */
+        static void beginConcurrentUpdates();
+        
+        //! Return to single-threaded updates on the calling thread (see beginConcurrentUpdates())
+        static void endConcurrentUpdates();
+    
     public:
         //! Listeners for changes to this sink
-        std::set<Listener*> sinkListeners;
+        SmallSet<Listener*> sinkListeners;
         
     protected:
         //! Return the current rate of the clock
@@ -75,26 +118,124 @@ namespace octo
         //! Return the current delta of the clock
         float delta() const;
         
+        //! Let everyone know that the structure of the graph changed at this sink
+        /*! Bumps the graph epoch, and has the clocks whose execution plan includes the sink rebuild it on
+            the calling thread (see Clock::getGraphEpoch()). Destructors shouldn't call this, as the plan
+            could include the object being destroyed. Whoever stops pulling it rebuilds the plan instead. */
+        void graphChanged();
+        
+        //! Can the output of the sink be read without updating it, because an execution plan did already?
+        /*! Only true while the calling thread runs a plan for the clock of the sink (see PlanScope), and
+            the sink was updated at the current render time of that clock. Matches the check update() makes,
+            but without the call, so the sinks in a plan read the ones scheduled before them directly. */
+        bool isUpdatedByPlan() const
+        {
+            auto run = planRun;
+            return run && run->clock == getClock() &&
+                timestamp.load(std::memory_order_acquire) == run->now + run->renderOffset->load(std::memory_order_relaxed) &&
+                owner.load(std::memory_order_acquire) == nullptr && started.load(std::memory_order_relaxed);
+        }
+        
+        //! Are the sinks pulled by the calling thread updated concurrently? (see beginConcurrentUpdates())
+        static bool isUpdatingConcurrently();
+        
+        //! Take over the sink during concurrent updates, waiting for the thread updating it to let go
+        /*! For updates that don't go through update() (e.g. Signal::pullBlock()).
+            @return false if the calling thread took over the sink already (a feedback loop), in which case
+                    it mustn't release() it */
+        bool claim();
+        
+        //! Let other threads take over the sink again (see claim())
+        void release() { owner.store(nullptr, std::memory_order_release); }
+    
     protected:
         //! The clock this sink runs at
-        Clock* clock = nullptr;
+        /*! Atomic because control threads may reassign the clock (e.g. through a Value) while the
+            processing thread is updating. Relaxed accesses compile to plain loads and stores. */
+        std::atomic<Clock*> clock{nullptr};
         
-        //! The timestamp of the last update
-        uint64_t timestamp = 0;
+        //! The timestamp of the last update (or the graph epoch, for sinks without a clock)
+        std::atomic<uint64_t> timestamp{0};
       
     private:
+        //! Update the sink while other threads may be pulling it as well
+        void updateConcurrently();
+        
         //! Called when the sink needs updating according to the clock
         virtual void onUpdate() = 0;
         
+        //! Does the output of the sink only depend on the structure of the graph, and not on time?
+        /*! Decides whether a sink without a clock is updated once per graph epoch (see isMemoizable()).
+            The default returns false, so the sink is updated every time it's pulled. */
+        virtual bool hasConstantOutput() { return false; }
+        
         //! The clock changed
         virtual void clockChanged(Clock* clock) { }
         
         //! The persistency changed
         virtual void persistencyChanged(bool persistent) { }
         
+    private:
+        //! The execution plan a thread is running (see PlanScope)
+        struct PlanRun
+        {
+            //! The clock the plan was compiled for
+            const Clock* clock = nullptr;
+            
+            //! The time of the clock when the plan started running
+            uint64_t now = 0;
+            
+            //! The render offset of the clock (see Clock::getRenderOffset())
+            const std::atomic<uint64_t>* renderOffset = nullptr;
+        };
+        
+        //! The execution plan the calling thread is running, if any
+        inline static thread_local const PlanRun* planRun = nullptr;
+        
     private:
         //! Has the sink done its first update yet?
-        bool started = false;
+        std::atomic<bool> started{false};
+        
+        //! Is the output of a sink without a clock kept until the graph epoch changes? (see isMemoizable())
+        std::atomic<bool> memoized{false};
+        
+        //! Is the sink persistent with its clock? (see Clock::isSinkPersistent())
+        /*! Kept by the clock, so finding out doesn't mean searching its persistent sinks */
+        std::atomic<bool> persistent{false};
+        
+        //! The slot the profiler records the sink in, or 0 if it was never profiled (see Profiler)
+        /*! Fits in the padding after the flags, so it's there whether or not profiling is compiled in */
+        mutable std::atomic<std::uint32_t> profilerSlot{0};
+        
+        //! The thread currently updating the sink during concurrent updates, if any
+        std::atomic<const void*> owner{nullptr};
+        
+        //! The clock whose execution plan includes the sink, if any (see Clock::getGraphEpoch())
+        /*! Set by the clock. Sinks included by the plans of several clocks point at a tag shared by all clocks. */
+        std::atomic<const void*> plannedBy{nullptr};
+    };
+    
+    //! Marks the calling thread as running an execution plan for a clock, for as long as it exists
+    /*! Used by ExecutionPlan and ParallelExecutor, so sinks can read the sinks scheduled before them
+        directly (see isUpdatedByPlan()). Scopes nest. */
+    class Sink::PlanScope
+    {
+    public:
+        //! Start running a plan for a clock
+        PlanScope(const Clock& clock);
+        
+        //! Stop running the plan
+        ~PlanScope();
+        
+        PlanScope(const PlanScope&) = delete;
+        PlanScope& operator=(const PlanScope&) = delete;
+        
+    private:
+        //! The plan being run
+        PlanRun run;
+        
+        //! The plan the thread was running before
+        const PlanRun* previous = nullptr;
     };
     
     //! A listener for sink events
@@ -0,0 +1,207 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_SMALL_SET_HPP
+#define OCTOPUS_SMALL_SET_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace octo
+{
+    //! A set of a few trivially copyable elements (usually pointers), stored inline until it grows
+    /*! Every node in a graph carries a couple of sets (e.g. the dependees of a signal and its listeners),
+        which hardly ever hold more than one element. A std::set costs 48 bytes even when empty, and an
+        allocation per element. This set stores up to N elements inside the object and moves to the
+        heap beyond that. Elements are kept in insertion order, and lookups are linear, which is fast
+        for the handful of elements these sets hold. */
+    template <class T, std::size_t N = 1>
+    class SmallSet
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SmallSet only holds trivially copyable elements");
+        static_assert(N > 0, "SmallSet needs room for at least one inline element");
+    
+    public:
+        using value_type = T;
+        using iterator = T*;
+        using const_iterator = const T*;
+    
+    public:
+        SmallSet() = default;
+        
+        //! Copy another set
+        SmallSet(const SmallSet& rhs)
+        {
+            reserve(rhs.length);
+            std::copy_n(rhs.data(), rhs.length, data());
+            length = rhs.length;
+        }
+        
+        //! Move from another set
+        SmallSet(SmallSet&& rhs) noexcept
+        {
+            swap(rhs);
+        }
+        
+        //! Free the elements, if they're on the heap
+        ~SmallSet()
+        {
+            if (isOnHeap())
+                delete[] storage.heap;
+        }
+        
+        //! Copy another set
+        SmallSet& operator=(const SmallSet& rhs)
+        {
+            if (&rhs != this)
+            {
+                clear();
+                reserve(rhs.length);
+                std::copy_n(rhs.data(), rhs.length, data());
+                length = rhs.length;
+            }
+            
+            return *this;
+        }
+        
+        //! Move from another set
+        SmallSet& operator=(SmallSet&& rhs) noexcept
+        {
+            SmallSet temp(std::move(rhs));
+            swap(temp);
+            return *this;
+        }
+        
+        //! Add an element, unless the set holds it already
+        /*! @return An iterator to the element, and whether it was added */
+        std::pair<iterator, bool> emplace(const T& value)
+        {
+            auto it = find(value);
+            if (it != end())
+                return {it, false};
+            
+            if (length == capacity)
+                reserve(capacity * 2);
+            
+            data()[length] = value;
+            return {data() + length++, true};
+        }
+        
+        //! Add an element, unless the set holds it already
+        std::pair<iterator, bool> insert(const T& value) { return emplace(value); }
+        
+        //! Remove an element
+        /*! @return The number of elements removed (0 or 1) */
+        std::size_t erase(const T& value)
+        {
+            auto it = find(value);
+            if (it == end())
+                return 0;
+            
+            std::copy(it + 1, end(), it);
+            --length;
+            return 1;
+        }
+        
+        //! Remove all elements, keeping the capacity
+        void clear() noexcept { length = 0; }
+        
+        //! Return an iterator to an element, or end() if the set doesn't hold it
+        iterator find(const T& value) { return std::find(begin(), end(), value); }
+        const_iterator find(const T& value) const { return std::find(begin(), end(), value); }
+        
+        //! Return the number of times the set holds an element (0 or 1)
+        std::size_t count(const T& value) const { return find(value) != end() ? 1 : 0; }
+        
+        //! Return the number of elements
+        std::size_t size() const noexcept { return length; }
+        
+        //! Does the set hold no elements?
+        bool empty() const noexcept { return length == 0; }
+        
+        //! Return the number of bytes allocated on the heap
+        std::size_t getHeapSize() const noexcept { return isOnHeap() ? capacity * sizeof(T) : 0; }
+        
+        iterator begin() noexcept { return data(); }
+        iterator end() noexcept { return data() + length; }
+        const_iterator begin() const noexcept { return data(); }
+        const_iterator end() const noexcept { return data() + length; }
+    
+    private:
+        //! Are the elements stored on the heap?
+        bool isOnHeap() const noexcept { return capacity > N; }
+        
+        //! Return the elements, wherever they're stored
+        T* data() noexcept { return isOnHeap() ? storage.heap : storage.local; }
+        const T* data() const noexcept { return isOnHeap() ? storage.heap : storage.local; }
+        
+        //! Make room for a number of elements
+        void reserve(std::size_t size)
+        {
+            if (size <= capacity)
+                return;
+            
+            auto elements = std::make_unique<T[]>(size);
+            std::copy_n(data(), length, elements.get());
+            
+            if (isOnHeap())
+                delete[] storage.heap;
+            
+            storage.heap = elements.release();
+            capacity = static_cast<std::uint32_t>(size);
+        }
+        
+        //! Swap the contents of two sets
+        void swap(SmallSet& rhs) noexcept
+        {
+            std::swap(storage, rhs.storage);
+            std::swap(length, rhs.length);
+            std::swap(capacity, rhs.capacity);
+        }
+    
+    private:
+        //! The elements, inline or on the heap
+        union Storage
+        {
+            T local[N];
+            T* heap;
+        } storage;
+        
+        //! The number of elements
+        std::uint32_t length = 0;
+        
+        //! The number of elements that fit in the storage
+        std::uint32_t capacity = N;
+    };
+}
+
+#endif
@@ -59,7 +59,8 @@ namespace octo
         
         //! Construct the split by providing size and input
         Split(Clock* clock, Value<std::vector<T>> input, std::size_t size) :
-            input(std::move(input))
+            input(std::move(input)),
+            clock(clock)
         {
             resize(size);
         }
@@ -0,0 +1,121 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_SPSC_RING_HPP
+#define OCTOPUS_SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace octo
+{
+    //! A wait-free ring buffer for a single producer and a single consumer thread
+    /*! One thread pushes, another pops. Neither ever blocks or allocates: pushing to a full ring or
+        popping from an empty one fails immediately. Used by bridges to move samples from one clock
+        domain to another (see Bridge). */
+    template <class T>
+    class SpscRing
+    {
+    public:
+        //! Construct the ring
+        /*! @param capacity The minimum number of elements the ring can hold (rounded up to a power of two) */
+        SpscRing(std::size_t capacity)
+        {
+            std::size_t size = 1;
+            while (size < capacity)
+                size *= 2;
+            
+            buffer.resize(size);
+        }
+        
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+        
+        //! Push an element (producer only)
+        /*! @return false if the ring is full */
+        bool push(const T& value)
+        {
+            const auto w = write.load(std::memory_order_relaxed);
+            if (w - read.load(std::memory_order_acquire) == buffer.size())
+                return false;
+            
+            buffer[w & (buffer.size() - 1)] = value;
+            write.store(w + 1, std::memory_order_release);
+            return true;
+        }
+        
+        //! Pop the oldest element (consumer only)
+        /*! @return false if the ring is empty */
+        bool pop(T& value)
+        {
+            auto front = this->front();
+            if (!front)
+                return false;
+            
+            value = std::move(*front);
+            pop();
+            return true;
+        }
+        
+        //! Discard the oldest element (consumer only, the ring shouldn't be empty)
+        void pop()
+        {
+            read.store(read.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+        
+        //! Return the oldest element, or nullptr if the ring is empty (consumer only)
+        T* front()
+        {
+            const auto r = read.load(std::memory_order_relaxed);
+            if (r == write.load(std::memory_order_acquire))
+                return nullptr;
+            
+            return &buffer[r & (buffer.size() - 1)];
+        }
+        
+        //! Return the number of elements in the ring
+        /*! Only a snapshot if the other thread is pushing or popping at the same time */
+        std::size_t size() const { return write.load(std::memory_order_acquire) - read.load(std::memory_order_acquire); }
+        
+        //! Return the maximum number of elements the ring can hold
+        std::size_t capacity() const { return buffer.size(); }
+    
+    private:
+        //! The elements, indexed modulo the (power of two) size
+        std::vector<T> buffer;
+        
+        //! The number of elements pushed so far (on its own cache line, to avoid false sharing)
+        alignas(64) std::atomic<std::size_t> write{0};
+        
+        //! The number of elements popped so far
+        alignas(64) std::atomic<std::size_t> read{0};
+    };
+}
+
+#endif
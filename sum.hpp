@@ -29,18 +29,43 @@
 #ifndef OCTOPUS_SUM_HPP
 #define OCTOPUS_SUM_HPP
 
+#include <cstddef>
+#include <functional>
 #include <type_traits>
 
+#include "expression.hpp"
 #include "fold.hpp"
+#include "simd.hpp"
 
 namespace octo
 {
+    //! Fold policy that adds its inputs, used by Sum
+    template <class T>
+    struct Addition
+    {
+        static constexpr bool commutative = true;
+        
+        T init() const { return 0; }
+        
+        void operator()(T& out, const T& in) const { out = out + in; }
+        
+        void operator()(T* out, const T* in, std::size_t size) const
+        {
+            simd::add(out, in, out, size);
+        }
+        
+        void operator()(const T* const* blocks, std::size_t count, const T& constant, T* out, std::size_t size) const
+        {
+            simd::sum(blocks, count, constant, out, size);
+        }
+    };
+    
     //! Sums an variadic amount of signals into one
     template <class T>
-    class Sum : public Fold<T>
+    class Sum : public Fold<T, T, Addition<T>>
     {
     public:
-        using Fold<T>::Fold;
+        using Fold<T, T, Addition<T>>::Fold;
         
         //! Add another term to the sum
         template <class U>
@@ -52,10 +77,8 @@ namespace octo
         
         GENERATE_MOVE(Sum)
         
-    private:
-        // Inherited from Fold
-        T init() const final override { return 0; }
-        T fold(const T& in, const T& out) const final override { return in + out; }
+        // Inherited from SignalBase
+        bool isPure() const final override { return true; }
     };
     
     //! Combine a scalar and a signal into a sum
@@ -127,7 +150,7 @@ namespace octo
     }
     
     //! Add another term to a sum
-    template <class T1, class T2>
+    template <class T1, class T2, class = std::enable_if_t<!IsExpression<T2>::value>>
     Sum<T1> operator+(Sum<T1>&& lhs, T2&& rhs)
     {
         lhs.emplace(std::forward<T2&&>(rhs));
@@ -135,12 +158,19 @@ namespace octo
     }
     
     //! Add another term to a sum
-    template <class T1, class T2>
+    template <class T1, class T2, class = std::enable_if_t<!IsExpression<T1>::value>>
     Sum<T2> operator+(T1&& lhs, Sum<T2>&& rhs)
     {
         rhs.emplace(std::forward<T1&&>(lhs));
         return std::move(rhs);
     }
+    
+    //! Fuse a sum into an arithmetic expression
+    template <class L, class R, class = EnableIfExpression<L, R>>
+    auto operator+(L&& lhs, R&& rhs)
+    {
+        return makeBinaryExpression<std::plus<>>(std::forward<L>(lhs), std::forward<R>(rhs));
+    }
 }
 
 #endif
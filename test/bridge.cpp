@@ -0,0 +1,192 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Bridges: samples cross clock domains through wait-free ring buffers, ticked on threads of their own
+
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(ringsRoundUpToPowersOfTwo)
+{
+    SpscRing<int> ring(5);
+    CHECK(ring.capacity() == 8);
+    
+    for (int i = 0; i < 8; ++i)
+        CHECK(ring.push(i));
+    CHECK(!ring.push(8));
+    CHECK(ring.size() == 8);
+    
+    int value = -1;
+    CHECK(ring.pop(value) && value == 0);
+    CHECK(*ring.front() == 1);
+    CHECK(ring.push(8));
+}
+
+TEST(ringsKeepTheOrderAcrossThreads)
+{
+    const int count = 100000;
+    SpscRing<int> ring(64);
+    
+    std::thread producer([&]
+    {
+        for (int i = 0; i < count; ++i)
+            while (!ring.push(i))
+                std::this_thread::yield();
+    });
+    
+    bool ordered = true;
+    for (int expected = 0; expected < count; )
+    {
+        int value;
+        if (!ring.pop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        
+        ordered &= (value == expected++);
+    }
+    
+    producer.join();
+    CHECK(ordered);
+    CHECK(ring.front() == nullptr);
+}
+
+TEST(latestBridgesSkipToTheMostRecentSample)
+{
+    InvariableClock producer(100);
+    InvariableClock consumer(10);
+    LatestBridge<float> bridge(&producer, &consumer, 4);
+    Counter counter(&producer, 1);
+    bridge.input = counter;
+    
+    for (int i = 0; i < 3; ++i)
+        producer.tick();
+    consumer.tick();
+    CHECK(bridge() == 3.0f);
+    
+    // Without new samples, the last one is held
+    consumer.tick();
+    CHECK(bridge() == 3.0f);
+    
+    // Running ahead further than the ring holds drops samples
+    for (int i = 0; i < 6; ++i)
+        producer.tick();
+    CHECK(bridge.getDropCount() == 2);
+    consumer.tick();
+    CHECK(bridge() == 7.0f);
+}
+
+TEST(fifoBridgesPassEverySampleInOrder)
+{
+    InvariableClock producer(100);
+    InvariableClock consumer(100);
+    FifoBridge<float> bridge(&producer, &consumer);
+    Counter counter(&producer, 1);
+    bridge.input = counter;
+    
+    for (int i = 0; i < 3; ++i)
+        producer.tick();
+    
+    for (int i = 1; i <= 3; ++i)
+    {
+        consumer.tick();
+        CHECK(bridge() == i);
+    }
+    
+    // Underruns repeat the previous sample
+    CHECK(bridge.getUnderrunCount() == 0);
+    consumer.tick();
+    CHECK(bridge() == 3.0f);
+    CHECK(bridge.getUnderrunCount() == 1);
+}
+
+TEST(bridgesNeedAProducer)
+{
+    InvariableClock consumer(100);
+    CHECK_THROWS(LatestBridge<float>(nullptr, &consumer), std::invalid_argument);
+}
+
+TEST(clockThreadsTickUntilStopped)
+{
+    InvariableClock clock(1000);
+    ClockThread thread(clock);
+    CHECK(!thread.isRunning());
+    
+    thread.start();
+    CHECK(thread.isRunning());
+    while (clock.now() < 10)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    
+    thread.stop();
+    CHECK(!thread.isRunning());
+    
+    const auto stopped = clock.now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    CHECK(clock.now() == stopped);
+}
+
+TEST(bridgesCarrySamplesBetweenClockThreads)
+{
+    InvariableClock producer(1000);
+    InvariableClock consumer(1000);
+    FifoBridge<float> bridge(&producer, &consumer);
+    Counter counter(&producer, 1);
+    bridge.input = counter;
+    
+    // The consumer checks every sample it receives follows the previous one
+    float previous = 0;
+    bool ordered = true;
+    auto check = map(bridge, [&](const float& sample)
+    {
+        ordered &= (sample == previous || sample == previous + 1);
+        previous = sample;
+        return sample;
+    });
+    check.setPersistency(true);
+    
+    {
+        ClockThread producerThread(producer);
+        ClockThread consumerThread(consumer);
+        producerThread.start();
+        consumerThread.start();
+        while (consumer.now() < 50)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    
+    CHECK(ordered);
+    CHECK(previous > 0);
+}
+
+int main() { return run(); }
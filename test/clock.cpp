@@ -0,0 +1,186 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Clocks: cached deltas, persistent sinks and ticking a block at a time
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+namespace
+{
+    //! A clock that doesn't call rateChanged()
+    class FixedClock : public Clock
+    {
+    public:
+        float rate() const override { return 50; }
+        uint64_t now() const override { return time; }
+        
+    private:
+        void onTick() override { ++time; }
+        
+        uint64_t time = 0;
+    };
+    
+    //! A clock with a delta of its own
+    class StretchedClock : public FixedClock
+    {
+    public:
+        float delta() const override { return 1; }
+    };
+    
+    //! A signal outputting the delta of its clock
+    class Delta : public Signal<float>
+    {
+    public:
+        using Signal<float>::Signal;
+        
+        GENERATE_MOVE(Delta)
+        
+    private:
+        void generateSample(float& out) final override { out = delta(); }
+    };
+    
+    //! A sink recording the render time of every update
+    class Recorder : public Sink
+    {
+    public:
+        using Sink::Sink;
+        
+        std::vector<uint64_t> times;
+        
+    private:
+        void onUpdate() final override { times.push_back(getClock()->renderTime()); }
+    };
+}
+
+TEST(deltaFallsBackToRate)
+{
+    FixedClock clock;
+    Delta delta(&clock);
+    CHECK(clock.delta() == 1.0f / 50);
+    CHECK(delta() == 1.0f / 50);
+    
+    InvariableClock invariable(100);
+    CHECK(invariable.delta() == 1.0f / 100);
+    invariable.setRate(200);
+    CHECK(invariable.delta() == 1.0f / 200);
+}
+
+TEST(deltaCanBeOverridden)
+{
+    StretchedClock clock;
+    Delta delta(&clock);
+    CHECK(delta() == 1);
+}
+
+TEST(persistencyFollowsTheClock)
+{
+    InvariableClock a(100);
+    InvariableClock b(100);
+    Counter counter(&a);
+    
+    counter.setPersistency(true);
+    CHECK(counter.isPersistent());
+    CHECK(a.isSinkPersistent(counter));
+    
+    counter.setClock(&b);
+    CHECK(counter.isPersistent());
+    CHECK(!a.isSinkPersistent(counter));
+    CHECK(b.isSinkPersistent(counter));
+    CHECK(a.getPersistentSinks().empty());
+    CHECK(b.getPersistentSinks().size() == 1);
+    
+    counter.setPersistency(false);
+    CHECK(!counter.isPersistent());
+    CHECK(b.getPersistentSinks().empty());
+}
+
+TEST(destroyedSinksAreNoLongerPersistent)
+{
+    InvariableClock clock(100);
+    Counter kept(&clock);
+    kept.setPersistency(true);
+    {
+        Counter temporary(&clock);
+        temporary.setPersistency(true);
+        CHECK(clock.getPersistentSinks().size() == 2);
+    }
+    
+    CHECK(clock.getPersistentSinks().size() == 1);
+    CHECK(clock.isSinkPersistent(kept));
+    clock.tick();
+}
+
+TEST(blockTicksMatchSingleTicks)
+{
+    InvariableClock single(100);
+    InvariableClock block(100);
+    Counter a(&single);
+    Counter b(&block);
+    Value<float> x = a * 2.0f + 1.0f;
+    Value<float> y = b * 2.0f + 1.0f;
+    x.setPersistency(true);
+    y.setPersistency(true);
+    
+    std::vector<float> expected;
+    for (int i = 0; i < 16; ++i)
+    {
+        single.tick();
+        expected.push_back(x());
+    }
+    
+    CHECK(block.tick(16) == single.now());
+    auto frames = y.getRenderedBlock();
+    CHECK(frames.size == expected.size());
+    for (std::size_t i = 0; i < std::min(frames.size, expected.size()); ++i)
+        CHECK(frames.frames[i] == expected[i]);
+    
+    CHECK(y() == x());
+}
+
+TEST(blockTicksUpdateOtherSinksEveryFrame)
+{
+    InvariableClock single(100);
+    InvariableClock block(100);
+    Recorder a(&single);
+    Recorder b(&block);
+    a.setPersistency(true);
+    b.setPersistency(true);
+    
+    for (int i = 0; i < 8; ++i)
+        single.tick();
+    block.tick(8);
+    
+    CHECK(b.times.size() == 8);
+    CHECK(b.times == a.times);
+    CHECK(block.renderTime() == block.now());
+}
+
+int main() { return run(); }
@@ -0,0 +1,143 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Signals without a clock: memoized per graph epoch only if their output is constant (see Sink::isMemoizable())
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+namespace
+{
+    //! A pure signal without a clock, counting how often it generated a sample
+    class Generations : public Signal<float>
+    {
+    public:
+        Generations(bool pure) : Signal<float>(nullptr), pure(pure) { }
+        
+        bool isPure() const final override { return pure; }
+        
+        GENERATE_MOVE(Generations)
+        
+        std::size_t count = 0;
+        
+    private:
+        void generateSample(float& out) final override { out = static_cast<float>(++count); }
+        
+        bool pure = true;
+    };
+}
+
+TEST(sumOfClocklessValueFollowsClockedSignal)
+{
+    InvariableClock clock(100);
+    Counter ramp(&clock, 1);
+    
+    Value<float> mod{0.0f};
+    Value<float> out = 1.0f + mod;
+    mod = ramp;
+    
+    for (int i = 0; i < 5; ++i)
+    {
+        clock.tick();
+        CHECK(out() == 1.0f + ramp());
+    }
+    
+    CHECK(ramp() == 5.0f);
+}
+
+TEST(chainOfClocklessValuesFollowsClockedSignal)
+{
+    InvariableClock clock(100);
+    Counter ramp(&clock, 1);
+    
+    Value<float> a = 3.0f;
+    Value<float> b = a;
+    Value<float> c = b;
+    CHECK(c() == 3.0f);
+    
+    b = ramp;
+    for (int i = 0; i < 5; ++i)
+    {
+        clock.tick();
+        CHECK(c() == ramp());
+        CHECK(c.pullBlock(1)[0] == ramp());
+    }
+}
+
+TEST(constantSubtreeIsMemoizedPerEpoch)
+{
+    Generations generations(true);
+    Value<float> value = generations;
+    Value<float> unrelated = 0.0f;
+    
+    // Constructing the value pulled the signal already
+    const auto before = generations.count;
+    value();
+    value();
+    generations();
+    CHECK(generations.count == before);
+    CHECK(value.isMemoizable());
+    
+    // Changing any graph starts a new epoch
+    unrelated = 1.0f;
+    value();
+    value();
+    CHECK(generations.count == before + 1);
+}
+
+TEST(impureClocklessSignalIsUpdatedOnEveryPull)
+{
+    Generations generations(false);
+    const auto before = generations.count;
+    generations();
+    generations();
+    CHECK(generations.count == before + 2);
+    CHECK(!generations.isMemoizable());
+}
+
+TEST(clocklessBlocksAreOnlyReusedWhenConstant)
+{
+    Value<float> constant = 2.0f;
+    Sum<float> sum(nullptr, constant, 3.0f);
+    CHECK(sum.pullBlock(4)[3] == 5.0f);
+    CHECK(sum.pullBlock(4) == sum.pullBlock(2));
+    
+    // Signals without a clock output the same sample throughout a block
+    Generations impure(false);
+    impure.pullBlock(2);
+    const auto count = impure.count;
+    impure.pullBlock(2);
+    CHECK(impure.count == count + 1);
+}
+
+int main()
+{
+    return run();
+}
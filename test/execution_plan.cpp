@@ -0,0 +1,182 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Execution plans: a compiled clock produces the same output as one pulling its graph recursively
+
+#include <algorithm>
+#include <vector>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+namespace
+{
+    //! A graph with a shared dependency and a value that can be reassigned
+    struct Graph
+    {
+        Graph(Clock& clock, bool compiled) :
+            ramp(&clock, 1),
+            slow(&clock, 0, 0.5f),
+            two(&clock, 2, 0),
+            three(&clock, 3, 0),
+            gain(two),
+            mix(&clock)
+        {
+            mix.emplace(ramp * gain);
+            mix.emplace(slow + ramp);
+            mix.setPersistency(true);
+            clock.setCompiled(compiled);
+        }
+        
+        Counter ramp;
+        Counter slow;
+        Counter two;
+        Counter three;
+        Value<float> gain;
+        Sum<float> mix;
+    };
+}
+
+TEST(compiledPlanMatchesRecursivePull)
+{
+    InvariableClock recursiveClock(100);
+    InvariableClock compiledClock(100);
+    Graph recursive(recursiveClock, false);
+    Graph compiled(compiledClock, true);
+    
+    for (int i = 0; i < 12; ++i)
+    {
+        if (i == 4)
+        {
+            recursive.gain = recursive.three;
+            compiled.gain = compiled.three;
+        } else if (i == 8) {
+            recursive.gain = recursive.slow;
+            compiled.gain = compiled.slow;
+        }
+        
+        recursiveClock.tick();
+        compiledClock.tick();
+        CHECK(compiled.mix() == recursive.mix());
+    }
+}
+
+TEST(sharedDependencyIsUpdatedOncePerTick)
+{
+    InvariableClock clock(100);
+    Graph graph(clock, true);
+    
+    // Constructing the graph pulled the first sample at time zero already
+    for (int i = 1; i <= 5; ++i)
+    {
+        clock.tick();
+        CHECK(graph.ramp() == i + 1.0f);
+        CHECK(graph.mix() == 3.0f * (i + 1) + 0.5f * i);
+    }
+}
+
+TEST(compiledBlocksMatchRecursiveBlocks)
+{
+    InvariableClock recursiveClock(100);
+    InvariableClock compiledClock(100);
+    Graph recursive(recursiveClock, false);
+    Graph compiled(compiledClock, true);
+    
+    recursiveClock.tick(8);
+    compiledClock.tick(8);
+    
+    auto expected = recursive.mix.getRenderedBlock();
+    auto block = compiled.mix.getRenderedBlock();
+    CHECK(block.size == 8);
+    CHECK(block.size == expected.size);
+    for (std::size_t i = 0; i < std::min(block.size, expected.size); ++i)
+        CHECK(block.frames[i] == expected.frames[i]);
+}
+
+TEST(dependenciesAreScheduledFirst)
+{
+    InvariableClock clock(100);
+    Graph graph(clock, false);
+    const auto plan = GraphCompiler::compile(clock);
+    
+    auto& sinks = plan.getSinks();
+    auto position = [&](const Sink& sink){ return std::find(sinks.begin(), sinks.end(), &sink) - sinks.begin(); };
+    CHECK(position(graph.mix) == static_cast<std::ptrdiff_t>(sinks.size()) - 1);
+    CHECK(position(graph.ramp) < position(graph.mix));
+    CHECK(position(graph.slow) < position(graph.mix));
+    CHECK(position(graph.two) < position(graph.mix));
+    
+    // The shared ramp is scheduled once, and the unused counter not at all
+    CHECK(std::count(sinks.begin(), sinks.end(), &graph.ramp) == 1);
+    CHECK(position(graph.three) == static_cast<std::ptrdiff_t>(sinks.size()));
+}
+
+TEST(tasksAreTopologicallyOrdered)
+{
+    InvariableClock clock(100);
+    Graph graph(clock, false);
+    const auto plan = GraphCompiler::compile(clock);
+    
+    auto& tasks = plan.getTasks();
+    std::vector<std::size_t> dependencies(tasks.size(), 0);
+    std::size_t sinkCount = 0;
+    for (std::size_t i = 0; i < tasks.size(); ++i)
+    {
+        sinkCount += tasks[i].sinks.size();
+        for (auto dependent : tasks[i].dependents)
+        {
+            CHECK(dependent > i);
+            ++dependencies[dependent];
+        }
+    }
+    
+    for (std::size_t i = 0; i < tasks.size(); ++i)
+        CHECK(tasks[i].dependencyCount == dependencies[i]);
+    
+    CHECK(sinkCount == plan.getSinks().size());
+}
+
+TEST(plansFollowReassignedValues)
+{
+    InvariableClock clock(100);
+    Graph graph(clock, true);
+    
+    // The unused counter joins the plan once the gain refers to it
+    graph.gain = graph.three;
+    const auto plan = GraphCompiler::compile(clock);
+    auto& sinks = plan.getSinks();
+    CHECK(std::find(sinks.begin(), sinks.end(), &graph.three) != sinks.end());
+    CHECK(std::find(sinks.begin(), sinks.end(), &graph.two) == sinks.end());
+    
+    clock.tick();
+    CHECK(graph.mix() == 3.0f * graph.ramp() + graph.slow() + graph.ramp());
+}
+
+int main() { return run(); }
@@ -0,0 +1,95 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Expressions: a fused expression outputs the same as the graph of nodes it replaces
+
+#include <stdexcept>
+#include <vector>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(fusedSamplesMatchNodes)
+{
+    InvariableClock clock(100);
+    Counter a(&clock, 1);
+    Counter b(&clock, 3, 0.5f);
+    
+    Value<float> nodes = (a * 2.0f + b) / 4.0f - -a;
+    Value<float> fused = fuse((lazy(a) * 2.0f + b) / 4.0f - -lazy(a));
+    
+    for (int i = 0; i < 8; ++i)
+    {
+        clock.tick();
+        CHECK(isClose(fused(), nodes()));
+    }
+}
+
+TEST(fusedBlocksMatchFusedSamples)
+{
+    InvariableClock blockClock(100);
+    InvariableClock sampleClock(100);
+    Counter blockCounter(&blockClock, 1);
+    Counter sampleCounter(&sampleClock, 1);
+    Value<float> blockSignal = fuse(lazy(blockCounter) * blockCounter + 1.0f);
+    Value<float> sampleSignal = fuse(lazy(sampleCounter) * sampleCounter + 1.0f);
+    
+    auto frames = blockSignal.pullBlock(8);
+    const std::vector<float> block(frames, frames + 8);
+    for (auto frame : block)
+    {
+        CHECK(frame == sampleSignal());
+        sampleClock.tick();
+    }
+}
+
+TEST(fusedSignalsDependOnTheirLeaves)
+{
+    InvariableClock clock(100);
+    Counter a(&clock);
+    Counter b(&clock);
+    auto fused = fuse(lazy(a) + b * 3.0f);
+    
+    CHECK(fused.getClock() == &clock);
+    
+    // Only the signals are pulled, constants are inlined
+    CHECK(fused.getDependencies().size() == 2);
+}
+
+TEST(fusingSignalsOfDifferentClocksThrows)
+{
+    InvariableClock audio(100);
+    InvariableClock video(10);
+    Counter a(&audio);
+    Counter b(&video);
+    CHECK_THROWS(fuse(lazy(a) + b), std::invalid_argument);
+}
+
+int main() { return run(); }
@@ -0,0 +1,165 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Graph arenas: signals built inside a scope come from the arena, and go back to it from anywhere
+
+#include <memory>
+#include <thread>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(signalsBuiltInScopeComeFromArena)
+{
+    GraphArena arena;
+    InvariableClock clock(100);
+    Counter counter(&clock, 1);
+    {
+        Value<float> value;
+        {
+            GraphArena::Scope scope(arena);
+            value = counter * 2.0f + 1.0f;
+        }
+        
+        CHECK(arena.getLiveAllocationCount() > 0);
+        clock.tick();
+        CHECK(value() == 2.0f * counter() + 1.0f);
+    }
+    
+    CHECK(arena.getLiveAllocationCount() == 0);
+}
+
+TEST(signalsBuiltOutsideScopeComeFromHeap)
+{
+    GraphArena arena;
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    
+    std::unique_ptr<Signal<float>> outside = (counter * 2.0f).moveToHeap();
+    std::unique_ptr<Signal<float>> inside;
+    {
+        GraphArena::Scope scope(arena);
+        inside = (counter * 3.0f).moveToHeap();
+    }
+    
+    const auto count = arena.getLiveAllocationCount();
+    CHECK(count > 0);
+    outside.reset();
+    CHECK(arena.getLiveAllocationCount() == count);
+    inside.reset();
+    CHECK(arena.getLiveAllocationCount() == 0);
+}
+
+TEST(arenaSignalsCanBeDeletedOnOtherThreads)
+{
+    GraphArena arena;
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    
+    std::unique_ptr<Signal<float>> signal;
+    {
+        GraphArena::Scope scope(arena);
+        signal = (counter + 1.0f).moveToHeap();
+    }
+    
+    std::thread([&]{ signal.reset(); }).join();
+    CHECK(arena.getLiveAllocationCount() == 0);
+}
+
+TEST(destroyingSignalsWhileDestroyingArenaSignal)
+{
+    // Removing a persistent signal from a compiled clock rebuilds its plan, which releases the signals the
+    // previous plan kept alive, all while the first signal is still being destroyed
+    GraphArena arena;
+    {
+        InvariableClock clock(100);
+        clock.setCompiled(true);
+        Counter counter(&clock);
+        
+        Value<float> value;
+        std::unique_ptr<Signal<float>> signal;
+        {
+            GraphArena::Scope scope(arena);
+            value = (counter * 2.0f).moveToHeap();
+            signal = (value + 1.0f).moveToHeap();
+            signal->setPersistency(true);
+        }
+        
+        clock.tick();
+        value = 0.0f;
+        signal.reset();
+        clock.tick();
+    }
+    
+    CHECK(arena.getLiveAllocationCount() == 0);
+}
+
+TEST(foldInputsComeFromArena)
+{
+    GraphArena arena;
+    InvariableClock clock(100);
+    Counter a(&clock, 1);
+    Counter b(&clock, 2);
+    {
+        Sum<float> sum(&clock);
+        {
+            GraphArena::Scope scope(arena);
+            sum.emplace(a * 2.0f);
+            sum.emplace(b * 3.0f);
+        }
+        
+        CHECK(arena.getLiveAllocationCount() >= 2);
+        clock.tick();
+        CHECK(sum() == 2.0f * a() + 3.0f * b());
+    }
+    
+    CHECK(arena.getLiveAllocationCount() == 0);
+}
+
+TEST(scopesNest)
+{
+    GraphArena outer;
+    GraphArena inner;
+    CHECK(GraphArena::getCurrentResource() == nullptr);
+    {
+        GraphArena::Scope outerScope(outer);
+        CHECK(GraphArena::getCurrentResource() == &outer);
+        {
+            GraphArena::Scope innerScope(inner);
+            CHECK(GraphArena::getCurrentResource() == &inner);
+        }
+        
+        CHECK(GraphArena::getCurrentResource() == &outer);
+    }
+    
+    CHECK(GraphArena::getCurrentResource() == nullptr);
+}
+
+int main() { return run(); }
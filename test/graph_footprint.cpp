@@ -0,0 +1,94 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Graph footprints: the signals pulled by a clock and the memory they occupy
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(clocksWithoutPersistentSinksHaveNoFootprint)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    
+    const auto footprint = GraphFootprint::measure(clock);
+    CHECK(footprint.signalCount == 0);
+    CHECK(footprint.byteCount == 0);
+    CHECK(footprint.getBytesPerSignal() == 0);
+}
+
+TEST(signalsAreMeasuredWithTheirHeapMemory)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    counter.setPersistency(true);
+    
+    auto footprint = GraphFootprint::measure(clock);
+    CHECK(footprint.signalCount == 1);
+    CHECK(footprint.byteCount == counter.getFootprint());
+    CHECK(footprint.heapByteCount == 0);
+    CHECK(footprint.getBytesPerSignal() == counter.getFootprint());
+    
+    // Block caches are allocated once blocks are pulled
+    counter.pullBlock(64);
+    footprint = GraphFootprint::measure(clock);
+    CHECK(footprint.heapByteCount >= 64 * sizeof(float));
+    CHECK(footprint.byteCount == counter.getFootprint());
+}
+
+TEST(sharedSignalsAreCountedOnce)
+{
+    InvariableClock clock(100);
+    Counter x(&clock);
+    Counter y(&clock);
+    Sum<float> shared(&clock, x, x);
+    shared.setPersistency(true);
+    
+    // The sum, the values of its inputs and the counter
+    CHECK(GraphFootprint::measure(clock).signalCount == 4);
+    
+    Sum<float> separate(&clock, x, y);
+    separate.setPersistency(true);
+    CHECK(GraphFootprint::measure(clock).signalCount == 8);
+}
+
+TEST(signalsAtOtherClocksAreIncluded)
+{
+    InvariableClock audio(100);
+    InvariableClock control(10);
+    Counter modulator(&control);
+    Sum<float> sum(&audio, modulator, 1.0f);
+    sum.setPersistency(true);
+    
+    CHECK(GraphFootprint::measure(audio).signalCount == 4);
+    CHECK(GraphFootprint::measure(control).signalCount == 0);
+}
+
+int main() { return run(); }
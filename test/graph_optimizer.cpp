@@ -0,0 +1,176 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Graph optimization: constant folding, merging constant terms, removing identities and sharing subexpressions
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(constantSubtreesAreFolded)
+{
+    InvariableClock clock(100);
+    Counter x(&clock, 1);
+    Product<float> constant(&clock, 2.0f, 3.0f);
+    Sum<float> sum(&clock, constant, x);
+    sum.setPersistency(true);
+    
+    clock.setOptimized(true);
+    CHECK(constant.isFolded());
+    CHECK(!sum.isFolded());
+    CHECK(constant.getActiveDependencies().empty());
+    
+    for (int i = 0; i < 4; ++i)
+    {
+        clock.tick();
+        CHECK(sum() == 6.0f + x());
+    }
+}
+
+TEST(constantTermsAreMerged)
+{
+    InvariableClock clock(100);
+    Counter x(&clock, 1);
+    Sum<float> sum(&clock, 1.0f, x);
+    sum.emplace(2.0f);
+    sum.emplace(x);
+    sum.emplace(3.0f);
+    sum.setPersistency(true);
+    
+    clock.setOptimized(true);
+    CHECK(sum.getPassThrough() == nullptr);
+    
+    clock.tick();
+    CHECK(sum() == 6.0f + 2 * x());
+    
+    auto frames = sum.pullBlock(4);
+    auto xs = x.pullBlock(4);
+    for (std::size_t i = 0; i < 4; ++i)
+        CHECK(frames[i] == 6.0f + 2 * xs[i]);
+}
+
+TEST(identitiesPassTheirInputThrough)
+{
+    InvariableClock clock(100);
+    Counter x(&clock, 1);
+    Product<float> once(&clock, x, 1.0f);
+    Sum<float> plusNothing(&clock, once, 2.0f);
+    plusNothing.emplace(-2.0f);
+    Negation<float> negated(&clock, plusNothing);
+    Negation<float> twice(&clock, negated);
+    twice.setPersistency(true);
+    
+    clock.setOptimized(true);
+    CHECK(once.getPassThrough() != nullptr);
+    CHECK(plusNothing.getPassThrough() != nullptr);
+    CHECK(twice.getPassThrough() != nullptr);
+    
+    // Only the counter is left to pull
+    CHECK(twice.getActiveDependencies().size() == 1);
+    
+    clock.tick();
+    CHECK(twice() == x());
+    CHECK(once() == x());
+}
+
+TEST(reassignedValuesAreReoptimized)
+{
+    InvariableClock clock(100);
+    Counter x(&clock, 1);
+    Value<float> factor = 2.0f;
+    Product<float> constant(&clock, factor, 3.0f);
+    Sum<float> sum(&clock, constant, x);
+    sum.setPersistency(true);
+    
+    clock.setOptimized(true);
+    clock.tick();
+    CHECK(constant.isFolded());
+    CHECK(sum() == 6.0f + x());
+    
+    // Switching from a constant to a signal unfolds the product at the next tick
+    factor = x;
+    clock.tick();
+    CHECK(!constant.isFolded());
+    CHECK(sum() == 4 * x());
+    
+    factor = 1.0f;
+    clock.tick();
+    CHECK(constant.isFolded());
+    CHECK(sum() == 3.0f + x());
+}
+
+TEST(optimizationsCanBeUndone)
+{
+    InvariableClock clock(100);
+    Counter x(&clock, 1);
+    Product<float> constant(&clock, 2.0f, 3.0f);
+    Product<float> once(&clock, x, 1.0f);
+    Sum<float> sum(&clock, constant, once);
+    sum.setPersistency(true);
+    
+    clock.setOptimized(true);
+    CHECK(clock.isOptimized());
+    CHECK(constant.isFolded());
+    
+    clock.setOptimized(false);
+    CHECK(!constant.isFolded());
+    CHECK(once.getPassThrough() == nullptr);
+    CHECK(sum.getActiveDependencies().size() == 2);
+    
+    clock.tick();
+    CHECK(sum() == 6.0f + x());
+}
+
+TEST(commonSubexpressionsAreShared)
+{
+    InvariableClock clock(100);
+    Counter x(&clock, 1);
+    Counter y(&clock, 2);
+    Product<float> a(&clock, x, y);
+    Product<float> b(&clock, x, y);
+    Product<float> swapped(&clock, y, x);
+    Sum<float> sum(&clock, a, b);
+    sum.emplace(swapped);
+    sum.setPersistency(true);
+    
+    clock.setOptimized(true);
+    
+    // Whichever product is scheduled first is computed, the other one passes it through
+    CHECK((a.getPassThrough() == &b) != (b.getPassThrough() == &a));
+    CHECK(swapped.getPassThrough() == nullptr);
+    
+    clock.tick();
+    CHECK(sum() == 3 * x() * y());
+    
+    clock.setOptimized(false);
+    CHECK(a.getPassThrough() == nullptr);
+    CHECK(b.getPassThrough() == nullptr);
+}
+
+int main() { return run(); }
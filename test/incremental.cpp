@@ -0,0 +1,156 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Incremental evaluation: pure signals skip generating samples while their inputs hold still
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+namespace
+{
+    //! A signal holding every step for a number of frames
+    class Steps : public Signal<float>
+    {
+    public:
+        Steps(Clock* clock, unsigned int period) : Signal<float>(clock), period(period) { }
+        
+        GENERATE_MOVE(Steps)
+        
+    private:
+        void generateSample(float& out) final override { out = static_cast<float>(frame++ / period); }
+        
+        unsigned int period = 1;
+        unsigned int frame = 0;
+    };
+}
+
+TEST(pureSignalsSkipUnchangedInputs)
+{
+    InvariableClock clock(100);
+    clock.setIncremental(true);
+    CHECK(clock.isIncremental());
+    
+    Steps steps(&clock, 4);
+    std::size_t calls = 0;
+    auto twice = map(steps, [&](const float& x) { ++calls; return x * 2; });
+    twice.pure = true;
+    
+    std::size_t changes = 0;
+    float previous = -1;
+    for (int i = 0; i < 12; ++i)
+    {
+        clock.tick();
+        CHECK(twice() == steps() * 2);
+        if (steps() != previous)
+            ++changes;
+        previous = steps();
+    }
+    
+    // Only the new steps were mapped
+    CHECK(changes < 12);
+    CHECK(calls == changes);
+}
+
+TEST(revisionsOnlyChangeWithTheOutput)
+{
+    InvariableClock clock(100);
+    clock.setIncremental(true);
+    Steps steps(&clock, 4);
+    
+    clock.tick();
+    steps();
+    const auto revision = steps.getRevision();
+    for (int i = 0; i < 3; ++i)
+    {
+        clock.tick();
+        steps();
+        CHECK(steps.getRevision() == revision);
+    }
+    
+    clock.tick();
+    steps();
+    CHECK(steps.getRevision() != revision);
+}
+
+TEST(impureSignalsAreAlwaysGenerated)
+{
+    InvariableClock clock(100);
+    clock.setIncremental(true);
+    Steps steps(&clock, 4);
+    std::size_t calls = 0;
+    auto twice = map(steps, [&](const float& x) { ++calls; return x * 2; });
+    
+    for (int i = 0; i < 8; ++i)
+    {
+        clock.tick();
+        twice();
+    }
+    
+    CHECK(calls == 8);
+}
+
+TEST(reassignedInputsAreGeneratedAgain)
+{
+    InvariableClock clock(100);
+    clock.setIncremental(true);
+    Steps slow(&clock, 100);
+    Steps fast(&clock, 1);
+    Value<float> input = slow;
+    Sum<float> sum(&clock, input, 1.0f);
+    
+    clock.tick();
+    CHECK(sum() == 1.0f);
+    
+    input = fast;
+    for (int i = 0; i < 4; ++i)
+    {
+        clock.tick();
+        CHECK(sum() == fast() + 1.0f);
+    }
+}
+
+TEST(fullEvaluationGeneratesEveryTick)
+{
+    InvariableClock clock(100);
+    Steps steps(&clock, 4);
+    std::size_t calls = 0;
+    auto twice = map(steps, [&](const float& x) { ++calls; return x * 2; });
+    twice.pure = true;
+    
+    for (int i = 0; i < 8; ++i)
+    {
+        clock.tick();
+        twice();
+    }
+    
+    CHECK(calls == 8);
+}
+
+int main() { return run(); }
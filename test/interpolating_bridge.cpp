@@ -0,0 +1,77 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Interpolating bridges: frames are rendered at the times the consumer clock assigns them
+
+#include <chrono>
+#include <thread>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(blockFramesAreSpacedByTheConsumerDelta)
+{
+    InvariableClock producer(20);
+    InvariableClock consumer(10);
+    InterpolatingBridge<float> bridge(&producer, &consumer);
+    
+    // Frames are 100ms apart, so the last one of a block of four is due 300ms after the first
+    bridge.setDelay(0.3f);
+    
+    bridge.input = 0.0f;
+    producer.tick();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bridge.input = 1.0f;
+    producer.tick();
+    
+    // The first frame still lies before both samples, the last one after them
+    auto frames = bridge.pullBlock(4);
+    CHECK(frames[0] == 0.0f);
+    CHECK(frames[3] == 1.0f);
+}
+
+TEST(lateProducersHoldTheLastSample)
+{
+    InvariableClock producer(20);
+    InvariableClock consumer(10);
+    InterpolatingBridge<float> bridge(&producer, &consumer);
+    bridge.setDelay(0);
+    
+    bridge.input = 2.0f;
+    producer.tick();
+    consumer.tick();
+    
+    // Without new samples, the bridge holds the last one
+    CHECK(bridge() == 2.0f);
+    consumer.tick();
+    CHECK(bridge() == 2.0f);
+}
+
+int main() { return run(); }
@@ -0,0 +1,90 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Joins: channels are accumulated in place, so the output keeps its memory from tick to tick
+
+#include <vector>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(joinsOutputTheirChannelsInOrder)
+{
+    InvariableClock clock(100);
+    Counter a(&clock, 1);
+    Counter b(&clock, 10);
+    auto join = a & 5.0f & b;
+    
+    for (int i = 0; i < 4; ++i)
+    {
+        clock.tick();
+        const auto& frame = join();
+        CHECK(frame.size() == 3);
+        CHECK(frame.size() == 3 && frame[0] == a() && frame[1] == 5.0f && frame[2] == b());
+    }
+}
+
+TEST(joinsReuseTheirOutput)
+{
+    InvariableClock clock(100);
+    Counter a(&clock);
+    Counter b(&clock);
+    auto join = a & b;
+    
+    clock.tick();
+    const auto data = join().data();
+    for (int i = 0; i < 4; ++i)
+    {
+        clock.tick();
+        CHECK(join().data() == data);
+    }
+}
+
+TEST(joinedBlocksMatchJoinedSamples)
+{
+    InvariableClock blockClock(100);
+    InvariableClock sampleClock(100);
+    Counter blockA(&blockClock, 1);
+    Counter blockB(&blockClock, 2, 2);
+    Counter sampleA(&sampleClock, 1);
+    Counter sampleB(&sampleClock, 2, 2);
+    auto blockJoin = blockA & blockB;
+    auto sampleJoin = sampleA & sampleB;
+    
+    auto frames = blockJoin.pullBlock(4);
+    const std::vector<std::vector<float>> block(frames, frames + 4);
+    for (auto& frame : block)
+    {
+        CHECK(frame == sampleJoin());
+        sampleClock.tick();
+    }
+}
+
+int main() { return run(); }
@@ -0,0 +1,175 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Latency histograms: tick durations counted in fixed memory, and deadline misses per clock
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+namespace
+{
+    //! A sink taking a given time to update
+    class Sleeper : public Sink
+    {
+    public:
+        Sleeper(Clock* clock, std::chrono::microseconds duration) : Sink(clock), duration(duration) { }
+        
+        std::chrono::microseconds duration;
+        
+    private:
+        void onUpdate() final override { std::this_thread::sleep_for(duration); }
+    };
+}
+
+TEST(bucketsBoundTheRelativeError)
+{
+    // Short durations are counted exactly
+    for (uint64_t nanoseconds = 0; nanoseconds < LatencyHistogram::subBucketCount; ++nanoseconds)
+    {
+        const auto index = LatencyHistogram::getBucketIndex(nanoseconds);
+        CHECK(LatencyHistogram::getBucketLowerBound(index) == nanoseconds);
+        CHECK(LatencyHistogram::getBucketUpperBound(index) == nanoseconds);
+    }
+    
+    std::size_t previous = 0;
+    for (uint64_t nanoseconds = 1; nanoseconds < (uint64_t(1) << 36); nanoseconds = nanoseconds * 3 / 2 + 1)
+    {
+        const auto index = LatencyHistogram::getBucketIndex(nanoseconds);
+        const auto lower = LatencyHistogram::getBucketLowerBound(index);
+        const auto upper = LatencyHistogram::getBucketUpperBound(index);
+        CHECK(index >= previous);
+        CHECK(lower <= nanoseconds && nanoseconds <= upper);
+        CHECK(upper - lower <= nanoseconds / 16);
+        previous = index;
+    }
+    
+    // Durations that are too long end up in the last bucket
+    CHECK(LatencyHistogram::getBucketIndex(uint64_t(1) << 40) == LatencyHistogram::bucketCount - 1);
+}
+
+TEST(snapshotsSummarizeTheDurations)
+{
+    LatencyHistogram histogram;
+    for (uint64_t i = 1; i <= 1000; ++i)
+        histogram.record(i * 1000);
+    
+    const auto snapshot = histogram.getSnapshot();
+    CHECK(snapshot.getCount() == 1000);
+    CHECK(snapshot.getMaximum() == 1'000'000);
+    CHECK(isClose(snapshot.getMean(), 500'500.0));
+    CHECK(isClose(snapshot.getQuantile(0.5), 500'000.0, 1.0 / 16));
+    CHECK(isClose(snapshot.getQuantile(0.99), 990'000.0, 1.0 / 16));
+    CHECK(snapshot.getQuantile(1) >= 1'000'000);
+    
+    histogram.reset();
+    CHECK(histogram.getSnapshot().getCount() == 0);
+    CHECK(histogram.getSnapshot().getQuantile(0.5) == 0);
+}
+
+TEST(monitoredClocksTimeTheirTicks)
+{
+    InvariableClock clock(1000);
+    Sleeper sleeper(&clock, std::chrono::microseconds(100));
+    sleeper.setPersistency(true);
+    
+    // Ticks aren't timed until the clock is monitored
+    clock.tick();
+    CHECK(clock.getTickStatistics().latency.getCount() == 0);
+    
+    clock.setMonitored(true);
+    CHECK(clock.isMonitored());
+    for (int i = 0; i < 5; ++i)
+        clock.tick();
+    
+    // Blocks count as a single tick
+    clock.tick(4);
+    
+    const auto statistics = clock.getTickStatistics();
+    CHECK(statistics.latency.getCount() == 6);
+    CHECK(statistics.latency.getQuantile(0) >= 100'000 * 31 / 32);
+    
+    clock.resetTickStatistics();
+    CHECK(clock.getTickStatistics().latency.getCount() == 0);
+}
+
+TEST(slowTicksMissTheirDeadline)
+{
+    InvariableClock clock(1000);
+    Sleeper sleeper(&clock, std::chrono::microseconds(0));
+    sleeper.setPersistency(true);
+    clock.setMonitored(true);
+    
+    clock.setDeadline(std::chrono::seconds(1));
+    CHECK(clock.getDeadline() == std::chrono::seconds(1));
+    clock.tick();
+    CHECK(clock.getTickStatistics().deadlineMisses == 0);
+    
+    // The default deadline is the period of the clock
+    sleeper.duration = std::chrono::microseconds(2000);
+    clock.setDeadline(std::chrono::nanoseconds(0));
+    clock.tick();
+    clock.tick();
+    CHECK(clock.getTickStatistics().deadlineMisses == 2);
+}
+
+TEST(statisticsCanBeReadWhileTicking)
+{
+    InvariableClock clock(1000);
+    Counter counter(&clock);
+    counter.setPersistency(true);
+    clock.setMonitored(true);
+    
+    std::atomic<bool> done{false};
+    std::thread ticker([&]
+    {
+        for (int i = 0; i < 10000; ++i)
+            clock.tick();
+        done = true;
+    });
+    
+    uint64_t previous = 0;
+    bool increasing = true;
+    while (!done)
+    {
+        const auto count = clock.getTickStatistics().latency.getCount();
+        increasing &= (count >= previous);
+        previous = count;
+    }
+    
+    ticker.join();
+    CHECK(increasing);
+    CHECK(clock.getTickStatistics().latency.getCount() == 10000);
+}
+
+int main() { return run(); }
@@ -0,0 +1,142 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Maps, zips and folds with an operation policy: callables inlined into the sample and block loops
+
+#include <algorithm>
+#include <limits>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+namespace
+{
+    //! Fold policy taking the maximum of the inputs
+    struct Maximum
+    {
+        static constexpr bool commutative = true;
+        float init() const { return -std::numeric_limits<float>::infinity(); }
+        void operator()(float& out, float in) const { out = std::max(out, in); }
+    };
+    
+    //! Fold policy appending inputs as digits, in order
+    struct Digits
+    {
+        static constexpr bool commutative = false;
+        int init() const { return 0; }
+        void operator()(int& out, int in) const { out = out * base + in; }
+        
+        int base = 10;
+    };
+}
+
+TEST(mapsApplyTheirFunctionPerSampleAndPerBlock)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock, 1);
+    auto squared = map(counter, [](float x) { return x * x; });
+    auto rounded = map(counter * 0.5f, [](float x) { return static_cast<int>(x); });
+    
+    for (int i = 0; i < 3; ++i)
+    {
+        clock.tick();
+        CHECK(squared() == counter() * counter());
+        CHECK(rounded() == static_cast<int>(counter() * 0.5f));
+    }
+    
+    auto frames = squared.pullBlock(8);
+    auto inputs = counter.pullBlock(8);
+    for (std::size_t i = 0; i < 8; ++i)
+        CHECK(frames[i] == inputs[i] * inputs[i]);
+}
+
+TEST(zipsCombineTwoSignals)
+{
+    InvariableClock clock(100);
+    Counter a(&clock, 1);
+    Counter b(&clock, 10, 2);
+    auto product = zip(a, b, [](float x, float y) { return x * y; });
+    
+    clock.tick();
+    CHECK(product() == a() * b());
+    
+    auto frames = product.pullBlock(8);
+    auto lhs = a.pullBlock(8);
+    auto rhs = b.pullBlock(8);
+    for (std::size_t i = 0; i < 8; ++i)
+        CHECK(frames[i] == lhs[i] * rhs[i]);
+}
+
+TEST(foldsCallTheirPolicy)
+{
+    InvariableClock clock(100);
+    Counter rising(&clock, 0);
+    Counter falling(&clock, 5, -1);
+    Fold<float, float, Maximum> maximum(&clock, rising, falling);
+    
+    for (int i = 0; i < 6; ++i)
+    {
+        clock.tick();
+        CHECK(maximum() == std::max(rising(), falling()));
+    }
+    
+    auto frames = maximum.pullBlock(8);
+    auto lhs = rising.pullBlock(8);
+    auto rhs = falling.pullBlock(8);
+    for (std::size_t i = 0; i < 8; ++i)
+        CHECK(frames[i] == std::max(lhs[i], rhs[i]));
+}
+
+TEST(foldsKeepTheOrderOfNonCommutativePolicies)
+{
+    Fold<int, int, Digits> digits(nullptr, 1, 2);
+    digits.emplace(3);
+    CHECK(digits() == 123);
+    
+    // Policies with state can be changed through the fold
+    digits.getOperation().base = 2;
+    digits.emplace(0);
+    CHECK(digits() == (((1 * 2) + 2) * 2 + 3) * 2 + 0);
+}
+
+TEST(foldsWithAPolicyCanBeHeldByValues)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock, 1);
+    Value<float> value = Fold<float, float, Maximum>(&clock, counter, 3.0f);
+    
+    for (int i = 0; i < 5; ++i)
+    {
+        clock.tick();
+        CHECK(value() == std::max(counter(), 3.0f));
+    }
+}
+
+int main() { return run(); }
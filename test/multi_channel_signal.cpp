@@ -0,0 +1,104 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Multi-channel signals: fixed-channel frames, pulled interleaved or planar, and split into channels
+
+#include <vector>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(joinedFramesHoldTheirChannels)
+{
+    InvariableClock clock(100);
+    Counter left(&clock, 1);
+    Counter right(&clock, 10);
+    FrameJoin<float, 2> join(&clock, left, right);
+    
+    clock.tick();
+    const auto frame = join();
+    CHECK(frame[0] == left());
+    CHECK(frame[1] == right());
+}
+
+TEST(planarBlocksMatchInterleavedBlocks)
+{
+    InvariableClock clock(100);
+    Counter left(&clock, 1);
+    Counter right(&clock, 10, 2);
+    FrameJoin<float, 2> join(&clock, left, right);
+    
+    auto frames = join.pullBlock(8);
+    const std::vector<Frame<float, 2>> interleaved(frames, frames + 8);
+    const auto& planar = join.pullPlanar(8);
+    for (std::size_t i = 0; i < interleaved.size(); ++i)
+    {
+        CHECK(planar[0][i] == interleaved[i][0]);
+        CHECK(planar[1][i] == interleaved[i][1]);
+    }
+}
+
+TEST(splitsSiftOutEveryChannel)
+{
+    InvariableClock clock(100);
+    Counter a(&clock, 1);
+    Counter b(&clock, 2);
+    Counter c(&clock, 3);
+    FrameJoin<float, 3> join(&clock, a, b, c);
+    FrameSplit<float, 3> split(&clock, join);
+    
+    for (int i = 0; i < 4; ++i)
+    {
+        clock.tick();
+        CHECK(split[0]() == a());
+        CHECK(split[1]() == b());
+        CHECK(split[2]() == c());
+    }
+}
+
+TEST(framesConvertToVectorsAndBack)
+{
+    InvariableClock clock(100);
+    Counter a(&clock, 1);
+    Counter b(&clock, 2);
+    FrameJoin<float, 2> join(&clock, a, b);
+    FrameToVector<float, 2> vector(&clock, join);
+    VectorToFrame<float, 3> frame(&clock, vector);
+    
+    clock.tick();
+    CHECK(vector() == std::vector<float>({a(), b()}));
+    
+    // Missing channels are filled in
+    CHECK(frame()[0] == a());
+    CHECK(frame()[1] == b());
+    CHECK(frame()[2] == 0.0f);
+}
+
+int main() { return run(); }
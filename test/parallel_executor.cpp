@@ -0,0 +1,187 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Parallel execution: an executor produces the same output as a single thread, frame by frame and in blocks
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+namespace
+{
+    //! Independent voices mixed together, so the plan splits into several tasks
+    struct Voices
+    {
+        Voices(Clock& clock) :
+            mix(&clock)
+        {
+            for (int i = 0; i < 6; ++i)
+            {
+                ramps.emplace_back(std::make_unique<Counter>(&clock, i, i + 1.0f));
+                mix.emplace(*ramps.back() * static_cast<float>(i + 1) + 1.0f);
+            }
+            
+            mix.setPersistency(true);
+        }
+        
+        std::vector<std::unique_ptr<Counter>> ramps;
+        Sum<float> mix;
+    };
+    
+    //! A signal that throws while it's told to
+    class Thrower : public Signal<float>
+    {
+    public:
+        Thrower(Clock* clock) :
+            Signal<float>(clock)
+        {
+        
+        }
+        
+        GENERATE_MOVE(Thrower)
+        
+        bool throwing = false;
+    
+    private:
+        void generateSample(float& out) final override
+        {
+            if (throwing)
+                throw std::runtime_error("thrower");
+            
+            out = 1;
+        }
+    };
+}
+
+TEST(parallelTicksMatchSingleThreadedTicks)
+{
+    InvariableClock singleClock(100);
+    InvariableClock parallelClock(100);
+    Voices single(singleClock);
+    Voices parallel(parallelClock);
+    
+    ParallelExecutor executor(3);
+    parallelClock.setExecutor(&executor);
+    
+    for (int i = 0; i < 16; ++i)
+    {
+        singleClock.tick();
+        parallelClock.tick();
+        CHECK(parallel.mix() == single.mix());
+    }
+    
+    parallelClock.setExecutor(nullptr);
+}
+
+TEST(parallelBlocksMatchSingleThreadedBlocks)
+{
+    InvariableClock singleClock(100);
+    InvariableClock parallelClock(100);
+    Voices single(singleClock);
+    Voices parallel(parallelClock);
+    
+    ParallelExecutor executor(3);
+    parallelClock.setExecutor(&executor);
+    
+    for (int i = 0; i < 4; ++i)
+    {
+        singleClock.tick(16);
+        parallelClock.tick(16);
+        
+        auto expected = single.mix.getRenderedBlock();
+        auto block = parallel.mix.getRenderedBlock();
+        CHECK(block.size == 16);
+        CHECK(block.size == expected.size);
+        for (std::size_t j = 0; j < std::min(block.size, expected.size); ++j)
+            CHECK(block.frames[j] == expected.frames[j]);
+    }
+    
+    // Ticking frame by frame afterwards picks up where the blocks left off
+    singleClock.tick();
+    parallelClock.tick();
+    CHECK(parallel.mix() == single.mix());
+    
+    parallelClock.setExecutor(nullptr);
+}
+
+TEST(parallelBlocksRenderEveryVoiceOnce)
+{
+    InvariableClock clock(100);
+    Voices voices(clock);
+    
+    ParallelExecutor executor(3);
+    clock.setExecutor(&executor);
+    clock.tick(16);
+    clock.setExecutor(nullptr);
+    
+    // The first ramp starts at 0 and counts up by 1, and was pulled once at construction
+    auto block = voices.ramps.front()->getRenderedBlock();
+    CHECK(block.size == 16);
+    for (std::size_t i = 0; i < block.size; ++i)
+        CHECK(block.frames[i] == i + 1.0f);
+}
+
+TEST(exceptionsAreRethrownByTheTickingThread)
+{
+    InvariableClock clock(100);
+    Voices voices(clock);
+    Thrower thrower(&clock);
+    voices.mix.emplace(thrower * 2.0f);
+    
+    ParallelExecutor executor(3);
+    clock.setExecutor(&executor);
+    
+    thrower.throwing = true;
+    CHECK_THROWS(clock.tick(), std::runtime_error);
+    CHECK_THROWS(clock.tick(4), std::runtime_error);
+    
+    // The executor and the sinks recover once the signal stops throwing
+    thrower.throwing = false;
+    for (int i = 0; i < 2; ++i)
+    {
+        if (i == 0)
+            clock.tick();
+        else
+            clock.tick(4);
+        
+        float expected = 2;
+        for (std::size_t j = 0; j < voices.ramps.size(); ++j)
+            expected += (*voices.ramps[j])() * (j + 1) + 1;
+        
+        CHECK(voices.mix() == expected);
+    }
+    
+    clock.setExecutor(nullptr);
+}
+
+int main() { return run(); }
@@ -0,0 +1,147 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Profiling: every profiled sink shows up in snapshots with its pulls, until it's destructed
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+#ifdef OCTOPUS_PROFILING
+//! Return the entry of a sink in a snapshot, or nullptr if it's not in there
+static const Profiler::Entry* findEntry(const std::vector<Profiler::Entry>& snapshot, const Sink& sink)
+{
+    auto entry = std::find_if(snapshot.begin(), snapshot.end(), [&](auto& entry){ return entry.sink == &sink; });
+    return entry != snapshot.end() ? &*entry : nullptr;
+}
+
+TEST(pullsAndHitsAreCounted)
+{
+    Profiler::reset();
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    
+    Profiler::setEnabled(true);
+    for (auto i = 0; i < 4; ++i)
+    {
+        clock.tick();
+        counter();
+        counter();
+    }
+    Profiler::setEnabled(false);
+    
+    const auto snapshot = Profiler::getSnapshot();
+    auto entry = findEntry(snapshot, counter);
+    CHECK(entry != nullptr);
+    CHECK(entry && entry->calls == 8);
+    CHECK(entry && entry->hits == 4);
+    CHECK(entry && entry->type == typeid(Counter));
+}
+
+TEST(threadsAreSummed)
+{
+    Profiler::reset();
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    
+    Profiler::setEnabled(true);
+    counter.pullBlock(4);
+    const auto first = findEntry(Profiler::getSnapshot(), counter)->calls;
+    std::thread([&]{ counter.pullBlock(4); }).join();
+    Profiler::setEnabled(false);
+    
+    // The block pulled on the other thread was cached already
+    const auto snapshot = Profiler::getSnapshot();
+    auto entry = findEntry(snapshot, counter);
+    CHECK(entry && entry->calls == first + 1);
+    CHECK(entry && entry->hits == 1);
+}
+
+TEST(labelsAreKept)
+{
+    Profiler::reset();
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    Profiler::setLabel(counter, "ramp");
+    CHECK(Profiler::getLabel(counter) == "ramp");
+    
+    Profiler::setEnabled(true);
+    counter();
+    Profiler::setEnabled(false);
+    
+    const auto snapshot = Profiler::getSnapshot();
+    auto entry = findEntry(snapshot, counter);
+    CHECK(entry && entry->label == "ramp");
+}
+
+TEST(destructedSinksAreForgotten)
+{
+    Profiler::reset();
+    InvariableClock clock(100);
+    auto counter = std::make_unique<Counter>(&clock);
+    Profiler::setLabel(*counter, "ramp");
+    
+    Profiler::setEnabled(true);
+    (*counter)();
+    Profiler::setEnabled(false);
+    
+    const Sink* address = counter.get();
+    counter.reset();
+    const auto snapshot = Profiler::getSnapshot();
+    CHECK(std::none_of(snapshot.begin(), snapshot.end(), [&](auto& entry){ return entry.sink == address; }));
+    
+    // A sink constructed at the same address starts afresh
+    counter = std::make_unique<Counter>(&clock);
+    CHECK(Profiler::getLabel(*counter).empty());
+}
+
+TEST(resetForgetsRecords)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    
+    Profiler::setEnabled(true);
+    counter();
+    Profiler::setEnabled(false);
+    
+    Profiler::reset();
+    CHECK(findEntry(Profiler::getSnapshot(), counter) == nullptr);
+}
+#else
+TEST(profilingNeedsToBeCompiledIn)
+{
+    CHECK_THROWS(Profiler::setEnabled(true), std::runtime_error);
+}
+#endif
+
+int main() { return run(); }
@@ -0,0 +1,98 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Real-time checks: allocations while rendering are attributed to the signal being rendered
+
+#include <algorithm>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+#ifdef OCTOPUS_REALTIME_CHECKS
+//! Was an allocation attributed to the sink?
+static bool isAllocationAttributedTo(const Sink& sink)
+{
+    const auto violations = RealTimeChecker::getViolations();
+    return std::any_of(violations.begin(), violations.end(), [&](auto& violation)
+    {
+        return violation.kind == RealTimeChecker::Violation::Kind::ALLOCATION && violation.sink == &sink;
+    });
+}
+
+TEST(growingBlocksIsAttributedToTheSignal)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    counter.pullBlock(4);
+    
+    // The violation is expected, so don't report it
+    RealTimeChecker::reset();
+    RealTimeChecker::setHandler([](auto&) { });
+    RealTimeChecker::setEnabled(true);
+    {
+        RealTimeChecker::TickScope tick;
+        counter.pullBlock(64);
+    }
+    RealTimeChecker::setEnabled(false);
+    RealTimeChecker::setHandler({});
+    
+    CHECK(isAllocationAttributedTo(counter));
+}
+
+TEST(renderingWarmBlocksDoesntAllocate)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    auto signal = counter * 2.0f + 1.0f;
+    signal.pullBlock(64);
+    
+    RealTimeChecker::reset();
+    for (auto i = 0; i < 16; ++i)
+    {
+        clock.tick(64);
+        
+        RealTimeChecker::setEnabled(true);
+        {
+            RealTimeChecker::TickScope tick;
+            signal.pullBlock(64);
+        }
+        RealTimeChecker::setEnabled(false);
+    }
+    
+    CHECK(RealTimeChecker::getViolationCount() == 0);
+}
+#else
+TEST(checksNeedToBeCompiledIn)
+{
+    CHECK_THROWS(RealTimeChecker::setEnabled(true), std::runtime_error);
+}
+#endif
+
+int main() { return run(); }
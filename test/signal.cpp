@@ -0,0 +1,111 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Blocks: pulling many frames at once matches pulling them one by one, and no frame is generated twice
+
+#include <vector>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+//! Copy the frames of a block, which may change with the next pull
+static std::vector<float> copyBlock(Signal<float>& signal, std::size_t size)
+{
+    auto frames = signal.pullBlock(size);
+    return {frames, frames + size};
+}
+
+TEST(blocksStartAtTheRenderTime)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    
+    const auto frames = copyBlock(counter, 4);
+    for (std::size_t i = 0; i < frames.size(); ++i)
+        CHECK(frames[i] == i);
+}
+
+TEST(walkingThroughABlockReadsItsFrames)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    counter.pullBlock(4);
+    
+    // The counter would count on if it generated these frames again
+    for (int i = 1; i < 4; ++i)
+    {
+        clock.tick();
+        CHECK(counter() == i);
+    }
+    
+    clock.tick();
+    CHECK(counter() == 4.0f);
+}
+
+TEST(overlappingBlocksOnlyRenderNewFrames)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    copyBlock(counter, 4);
+    
+    clock.tick();
+    const auto frames = copyBlock(counter, 4);
+    for (std::size_t i = 0; i < frames.size(); ++i)
+        CHECK(frames[i] == i + 1.0f);
+}
+
+TEST(derivedBlocksMatchDerivedSamples)
+{
+    InvariableClock blockClock(100);
+    InvariableClock sampleClock(100);
+    Counter blockCounter(&blockClock, 1);
+    Counter sampleCounter(&sampleClock, 1);
+    Value<float> blockSignal = blockCounter * 2.0f - 1.0f;
+    Value<float> sampleSignal = sampleCounter * 2.0f - 1.0f;
+    
+    const auto frames = copyBlock(blockSignal, 8);
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+        CHECK(frames[i] == sampleSignal());
+        sampleClock.tick();
+    }
+}
+
+TEST(clocklessBlocksRepeatTheirSample)
+{
+    Value<float> constant = 3.0f;
+    Value<float> sum = constant + 1.0f;
+    
+    const auto frames = copyBlock(sum, 4);
+    for (auto frame : frames)
+        CHECK(frame == 4.0f);
+}
+
+int main() { return run(); }
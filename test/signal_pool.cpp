@@ -0,0 +1,97 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Signal pools: structurally identical pure signals are interned once
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(identicalSignalsAreShared)
+{
+    InvariableClock clock(100);
+    Counter x(&clock, 1);
+    Counter y(&clock, 2);
+    SignalPool pool;
+    
+    auto& a = pool.intern(x * y);
+    auto& b = pool.intern(x * y);
+    CHECK(&a == &b);
+    CHECK(pool.size() == 1);
+    
+    // Different inputs or operations aren't shared
+    auto& c = pool.intern(y * x);
+    auto& d = pool.intern(x + y);
+    CHECK(&c != &a);
+    CHECK(&d != &a);
+    CHECK(pool.size() == 3);
+    
+    clock.tick();
+    CHECK(a() == x() * y());
+}
+
+TEST(constantInputsAreCompared)
+{
+    InvariableClock clock(100);
+    Counter x(&clock, 1);
+    SignalPool pool;
+    
+    auto& twice = pool.intern(x * 2.0f);
+    CHECK(&pool.intern(x * 2.0f) == &twice);
+    CHECK(&pool.intern(x * 3.0f) != &twice);
+}
+
+TEST(sharedSignalsComposeIntoSharedExpressions)
+{
+    InvariableClock clock(100);
+    Counter x(&clock, 1);
+    Counter y(&clock, 2);
+    SignalPool pool;
+    
+    auto& a = pool.intern(pool.intern(x * y) + 1.0f);
+    auto& b = pool.intern(pool.intern(x * y) + 1.0f);
+    CHECK(&a == &b);
+    CHECK(pool.size() == 2);
+}
+
+TEST(impureSignalsAreNeverShared)
+{
+    InvariableClock clock(100);
+    SignalPool pool;
+    
+    auto& a = pool.intern(Counter(&clock));
+    auto& b = pool.intern(Counter(&clock));
+    CHECK(&a != &b);
+    CHECK(pool.size() == 2);
+    
+    pool.clear();
+    CHECK(pool.size() == 0);
+}
+
+int main() { return run(); }
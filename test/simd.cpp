@@ -0,0 +1,143 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Vectorized kernels: every supported instruction set matches the scalar loops, tails included
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "../simd.hpp"
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+//! Run a function with every instruction set the cpu supports
+template <class Function>
+static void forEachInstructionSet(Function function)
+{
+    const auto previous = simd::getInstructionSet();
+    for (auto set = simd::InstructionSet::SCALAR; set <= simd::getSupportedInstructionSet();
+         set = static_cast<simd::InstructionSet>(static_cast<int>(set) + 1))
+    {
+        simd::setInstructionSet(set);
+        CHECK(simd::getInstructionSet() == set);
+        function();
+    }
+    
+    simd::setInstructionSet(previous);
+}
+
+//! Check the arithmetic kernels of a sample type on a size that leaves a tail for every vector width
+template <class T>
+static void checkArithmetic()
+{
+    const std::size_t size = 37;
+    std::vector<T> lhs(size), rhs(size), out(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        lhs[i] = static_cast<T>(i * 3 + 1);
+        rhs[i] = static_cast<T>(i % 5 + 1);
+    }
+    
+    forEachInstructionSet([&]
+    {
+        simd::add(lhs.data(), rhs.data(), out.data(), size);
+        for (std::size_t i = 0; i < size; ++i)
+            CHECK(out[i] == lhs[i] + rhs[i]);
+        
+        simd::subtract(lhs.data(), T(2), out.data(), size);
+        for (std::size_t i = 0; i < size; ++i)
+            CHECK(out[i] == lhs[i] - T(2));
+        
+        simd::subtract(T(2), rhs.data(), out.data(), size);
+        for (std::size_t i = 0; i < size; ++i)
+            CHECK(out[i] == T(2) - rhs[i]);
+        
+        simd::multiply(lhs.data(), rhs.data(), out.data(), size);
+        for (std::size_t i = 0; i < size; ++i)
+            CHECK(out[i] == lhs[i] * rhs[i]);
+        
+        simd::divide(lhs.data(), rhs.data(), out.data(), size);
+        for (std::size_t i = 0; i < size; ++i)
+            CHECK(out[i] == lhs[i] / rhs[i]);
+        
+        simd::negate(lhs.data(), out.data(), size);
+        for (std::size_t i = 0; i < size; ++i)
+            CHECK(out[i] == -lhs[i]);
+        
+        const T* inputs[] = { lhs.data(), rhs.data(), lhs.data() };
+        simd::sum(inputs, 3, T(1), out.data(), size);
+        for (std::size_t i = 0; i < size; ++i)
+            CHECK(out[i] == T(1) + lhs[i] + rhs[i] + lhs[i]);
+        
+        simd::product(inputs, 2, T(2), out.data(), size);
+        for (std::size_t i = 0; i < size; ++i)
+            CHECK(out[i] == T(2) * lhs[i] * rhs[i]);
+    });
+}
+
+TEST(floatKernelsMatchScalarLoops) { checkArithmetic<float>(); }
+TEST(doubleKernelsMatchScalarLoops) { checkArithmetic<double>(); }
+TEST(int32KernelsMatchScalarLoops) { checkArithmetic<std::int32_t>(); }
+TEST(int64KernelsMatchScalarLoops) { checkArithmetic<std::int64_t>(); }
+
+TEST(kernelsWriteInPlace)
+{
+    std::vector<float> block(19, 2.0f);
+    forEachInstructionSet([&]
+    {
+        std::fill(block.begin(), block.end(), 2.0f);
+        simd::multiply(block.data(), block.data(), block.data(), block.size());
+        for (auto& sample : block)
+            CHECK(sample == 4.0f);
+    });
+}
+
+TEST(operationsUseTheKernels)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock, 1);
+    Product<float> twice = counter * 2.0f;
+    
+    const float* block = twice.pullBlock(13);
+    for (std::size_t i = 0; i < 13; ++i)
+        CHECK(block[i] == 2.0f * (i + 1));
+}
+
+TEST(unsupportedInstructionSetsAreRejected)
+{
+    if (simd::getSupportedInstructionSet() == simd::InstructionSet::AVX512)
+        return;
+    
+    CHECK_THROWS(simd::setInstructionSet(simd::InstructionSet::AVX512), std::invalid_argument);
+}
+
+int main() { return run(); }
@@ -0,0 +1,88 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Small sets: inline storage for the few dependees and listeners most signals have
+
+#include <utility>
+
+#include "../small_set.hpp"
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(fewElementsStayInline)
+{
+    SmallSet<int*, 2> set;
+    int a, b;
+    CHECK(set.empty());
+    CHECK(set.insert(&a).second);
+    CHECK(!set.insert(&a).second);
+    CHECK(set.insert(&b).second);
+    CHECK(set.size() == 2);
+    CHECK(set.getHeapSize() == 0);
+    CHECK(set.count(&a) == 1);
+}
+
+TEST(growingSetsMoveToTheHeap)
+{
+    SmallSet<int, 1> set;
+    for (int i = 0; i < 10; ++i)
+        set.insert(i);
+    
+    CHECK(set.size() == 10);
+    CHECK(set.getHeapSize() >= 10 * sizeof(int));
+    for (int i = 0; i < 10; ++i)
+        CHECK(set.count(i) == 1);
+    
+    CHECK(set.erase(4) == 1);
+    CHECK(set.erase(4) == 0);
+    CHECK(set.size() == 9);
+    CHECK(set.find(4) == set.end());
+}
+
+TEST(setsCanBeCopiedAndMoved)
+{
+    SmallSet<int, 2> set;
+    for (int i = 0; i < 5; ++i)
+        set.insert(i);
+    
+    SmallSet<int, 2> copy = set;
+    CHECK(copy.size() == 5 && copy.count(3) == 1);
+    
+    SmallSet<int, 2> moved = std::move(set);
+    CHECK(moved.size() == 5 && moved.count(4) == 1);
+    CHECK(set.empty());
+    
+    copy = moved;
+    copy.clear();
+    CHECK(copy.empty());
+    CHECK(moved.size() == 5);
+}
+
+int main() { return run(); }
@@ -0,0 +1,82 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Splits: sieves read their channel from the frame of the input, which values pass on without copying
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(sievesOutputTheirChannel)
+{
+    InvariableClock clock(100);
+    Counter a(&clock, 1);
+    Counter b(&clock, 10);
+    Split<float> split(&clock, a & b, 2);
+    CHECK(split[0].getClock() == &clock);
+    CHECK(split[1].getClock() == &clock);
+    
+    for (int i = 0; i < 4; ++i)
+    {
+        clock.tick();
+        CHECK(split[0]() == a());
+        CHECK(split[1]() == b());
+    }
+}
+
+TEST(valuesPassSamplesThroughWithoutCopying)
+{
+    InvariableClock clock(100);
+    Counter a(&clock);
+    Counter b(&clock);
+    auto join = a & b;
+    
+    Value<std::vector<float>> reference = join;
+    Value<std::vector<float>> chained = reference;
+    clock.tick();
+    CHECK(&reference() == &join());
+    CHECK(&chained() == &join());
+}
+
+TEST(resizedSplitsKeepTheirInput)
+{
+    InvariableClock clock(100);
+    Counter a(&clock, 1);
+    Counter b(&clock, 2);
+    Counter c(&clock, 3);
+    Split<float> split(&clock, 1);
+    split.input = a & b & c;
+    split.resize(3);
+    
+    clock.tick();
+    CHECK(split[0]() == a());
+    CHECK(split[2]() == c());
+}
+
+int main() { return run(); }
@@ -0,0 +1,150 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_TEST_HPP
+#define OCTOPUS_TEST_HPP
+
+// A minimal harness for the behavioural tests, so they don't depend on a test framework
+/* Every test file is an executable registered with CTest. Tests are functions registered with TEST(),
+   and run in order of declaration. CHECK() reports a failed condition and keeps going, the executable
+   returns a non-zero exit code if any check failed. */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <vector>
+
+#include "../octopus.hpp"
+
+namespace octo::test
+{
+    //! A test case
+    struct Case
+    {
+        const char* name;
+        std::function<void()> function;
+    };
+    
+    //! Return the test cases of the executable
+    inline std::vector<Case>& getCases()
+    {
+        static std::vector<Case> cases;
+        return cases;
+    }
+    
+    //! Return the number of failed checks
+    inline std::size_t& getFailureCount()
+    {
+        static std::size_t failures = 0;
+        return failures;
+    }
+    
+    //! Registers a test case when constructed
+    struct Registration
+    {
+        Registration(const char* name, std::function<void()> function) { getCases().push_back({name, std::move(function)}); }
+    };
+    
+    //! Report a failed check
+    inline void fail(const char* expression, const char* file, int line)
+    {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        ++getFailureCount();
+    }
+    
+    //! Are two samples equal, allowing for rounding errors?
+    inline bool isClose(double lhs, double rhs, double tolerance = 1e-5)
+    {
+        return std::abs(lhs - rhs) <= tolerance * std::max(1.0, std::abs(rhs));
+    }
+    
+    //! Run all test cases, returning the exit code of the executable
+    inline int run()
+    {
+        for (auto& test : getCases())
+        {
+            const auto failures = getFailureCount();
+            try
+            {
+                test.function();
+            } catch (std::exception& exception) {
+                std::fprintf(stderr, "%s: unexpected exception: %s\n", test.name, exception.what());
+                ++getFailureCount();
+            }
+            
+            std::printf("%s %s\n", getFailureCount() == failures ? "passed" : "FAILED", test.name);
+        }
+        
+        return getFailureCount() ? 1 : 0;
+    }
+    
+    //! A signal counting up from a start value, one step per generated sample
+    class Counter : public Signal<float>
+    {
+    public:
+        Counter(Clock* clock, float start = 0, float step = 1) :
+            Signal<float>(clock),
+            next(start),
+            step(step)
+        {
+        
+        }
+        
+        GENERATE_MOVE(Counter)
+    
+    private:
+        void generateSample(float& out) final override
+        {
+            out = next;
+            next += step;
+        }
+        
+        float next = 0;
+        float step = 1;
+    };
+}
+
+#define OCTOPUS_TEST_CONCATENATE_(a, b) a##b
+#define OCTOPUS_TEST_CONCATENATE(a, b) OCTOPUS_TEST_CONCATENATE_(a, b)
+
+//! Declare a test case
+#define TEST(name) \
+    static void name(); \
+    static octo::test::Registration OCTOPUS_TEST_CONCATENATE(registration_, name)(#name, name); \
+    static void name()
+
+//! Check a condition, reporting it if it doesn't hold
+#define CHECK(condition) ((condition) ? (void)0 : octo::test::fail(#condition, __FILE__, __LINE__))
+
+//! Check that a statement throws an exception of a given type
+#define CHECK_THROWS(statement, exception) \
+    do { try { statement; octo::test::fail(#statement " throws " #exception, __FILE__, __LINE__); } catch (exception&) { } } while (false)
+
+#endif
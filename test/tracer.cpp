@@ -0,0 +1,147 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Tracing: ticks, updates and reassignments recorded per thread and written as Chrome trace JSON
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+#ifdef OCTOPUS_TRACING
+//! Return the number of times a string occurs in another one
+static std::size_t count(const std::string& haystack, const std::string& needle)
+{
+    std::size_t count = 0;
+    for (auto i = haystack.find(needle); i != std::string::npos; i = haystack.find(needle, i + 1))
+        ++count;
+    return count;
+}
+
+//! Return the thread of the event at a position in the JSON
+static std::string getThread(const std::string& json, std::size_t position)
+{
+    const auto begin = json.find("\"tid\":", position);
+    return json.substr(begin, json.find(',', begin) - begin);
+}
+
+//! Write the recorded events as a string
+static std::string write()
+{
+    std::ostringstream stream;
+    Tracer::write(stream);
+    return stream.str();
+}
+
+TEST(ticksAndUpdatesAreRecorded)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    counter.setPersistency(true);
+    
+    Tracer::reset();
+    Tracer::setEnabled(true);
+    CHECK(Tracer::isEnabled());
+    for (int i = 0; i < 3; ++i)
+        clock.tick();
+    clock.tick(4);
+    Tracer::setEnabled(false);
+    
+    const auto json = write();
+    CHECK(json.rfind("{\"traceEvents\":[", 0) == 0);
+    CHECK(json.find("\n]}\n") == json.size() - 4);
+    CHECK(count(json, "\"name\":\"tick\"") == 3);
+    CHECK(count(json, "\"name\":\"tick block\"") == 1);
+    CHECK(count(json, "\"name\":\"octo::test::Counter\"") >= 4);
+    CHECK(count(json, "\"ph\":\"X\"") == count(json, "\"dur\":"));
+}
+
+TEST(instantsHaveNoDuration)
+{
+    Value<float> value = 1.0f;
+    
+    Tracer::reset();
+    Tracer::setEnabled(true);
+    value = 2.0f;
+    Tracer::recordInstant("marker", &value);
+    Tracer::setEnabled(false);
+    
+    const auto json = write();
+    CHECK(count(json, "\"name\":\"value assigned\"") == 1);
+    CHECK(count(json, "\"name\":\"marker\"") == 1);
+    CHECK(count(json, "\"ph\":\"i\"") == 2);
+    CHECK(count(json, "\"dur\":") == 0);
+}
+
+TEST(threadsRecordSeparately)
+{
+    InvariableClock a(100);
+    InvariableClock b(100);
+    Counter x(&a);
+    Counter y(&b);
+    x.setPersistency(true);
+    y.setPersistency(true);
+    
+    Tracer::reset();
+    Tracer::setEnabled(true);
+    a.tick();
+    std::thread([&]{ b.tick(); }).join();
+    Tracer::setEnabled(false);
+    
+    const auto json = write();
+    CHECK(count(json, "\"name\":\"tick\"") == 2);
+    
+    // Both ticks are attributed to a thread of their own
+    const auto first = json.find("\"name\":\"tick\"");
+    const auto second = json.find("\"name\":\"tick\"", first + 1);
+    CHECK(getThread(json, first) != getThread(json, second));
+}
+
+TEST(disabledTracersRecordNothing)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock);
+    counter.setPersistency(true);
+    
+    Tracer::reset();
+    clock.tick();
+    CHECK(count(write(), "\"name\":") == 0);
+}
+#else
+TEST(tracingNeedsToBeCompiledIn)
+{
+    CHECK(!Tracer::isEnabled());
+    CHECK_THROWS(Tracer::setEnabled(true), std::runtime_error);
+}
+#endif
+
+int main() { return run(); }
@@ -0,0 +1,263 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+// Values: constants without a state, inline internal signals, reassignment from other threads and chains of values
+
+#include <atomic>
+#include <thread>
+#include <utility>
+
+#include "test.hpp"
+
+using namespace octo;
+using namespace octo::test;
+
+TEST(constantValuesDontAllocate)
+{
+    GraphArena arena;
+    {
+        GraphArena::Scope scope(arena);
+        Value<float> value = 3.0f;
+        CHECK(arena.getLiveAllocationCount() == 0);
+        CHECK(value.isConstant());
+        CHECK(value.getConstant() == 3.0f);
+        CHECK(value() == 3.0f);
+        CHECK(*value.pullConstant() == 3.0f);
+        
+        value = 4.0f;
+        CHECK(arena.getLiveAllocationCount() == 1);
+        CHECK(value() == 4.0f);
+    }
+    
+    CHECK(arena.getLiveAllocationCount() == 0);
+}
+
+TEST(constantValuesCanBeMoved)
+{
+    Value<float> value = 3.0f;
+    Value<float> moved = std::move(value);
+    CHECK(moved.getConstant() == 3.0f);
+    CHECK(moved() == 3.0f);
+    CHECK(value.getConstant() == 0.0f);
+    
+    Value<float> assigned = 1.0f;
+    assigned = std::move(moved);
+    CHECK(assigned() == 3.0f);
+}
+
+namespace
+{
+    //! A counter that can only be moved to the heap
+    class HeapOnly : public Counter
+    {
+    public:
+        using Counter::Counter;
+        
+        std::unique_ptr<Signal<float>> moveToHeap() && override { return std::make_unique<HeapOnly>(std::move(*this)); }
+        std::size_t getStorageSize() const override { return 0; }
+    };
+}
+
+TEST(internalSignalsAreStoredInline)
+{
+    InvariableClock clock(100);
+    GraphArena arena;
+    {
+        GraphArena::Scope scope(arena);
+        
+        // The state and the signal share a single allocation
+        Value<float> value = Counter(&clock, 1);
+        CHECK(arena.getLiveAllocationCount() == 1);
+        CHECK(value.isInternal());
+        
+        // Signals that can't be moved into storage go to the heap
+        Value<float> heap = HeapOnly(&clock, 1);
+        CHECK(arena.getLiveAllocationCount() == 3);
+        
+        // Moving the value keeps the signal where it is
+        Value<float> moved = std::move(value);
+        CHECK(arena.getLiveAllocationCount() == 3);
+        for (int i = 0; i < 3; ++i)
+        {
+            clock.tick();
+            CHECK(moved() == heap());
+        }
+    }
+    
+    CHECK(arena.getLiveAllocationCount() == 0);
+}
+
+TEST(valuesFollowReassignment)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock, 1);
+    
+    Value<float> value = 2.0f;
+    value = counter;
+    CHECK(value.isReference());
+    CHECK(value.getClock() == &clock);
+    
+    clock.tick();
+    CHECK(value() == counter());
+    
+    value = 5.0f;
+    CHECK(value.getClock() == nullptr);
+    CHECK(value() == 5.0f);
+}
+
+TEST(chainsOfValuesEndInTheirSource)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock, 1);
+    
+    Value<float> a = 1.0f;
+    Value<float> b = a;
+    Value<float> c = b;
+    CHECK(c() == 1.0f);
+    CHECK(c.pullSource() == nullptr);
+    
+    a = counter;
+    CHECK(c.pullSource() == &counter);
+    
+    clock.tick();
+    CHECK(c() == counter());
+    
+    b = 7.0f;
+    CHECK(c() == 7.0f);
+}
+
+TEST(chainsOfValuesForwardTheirSource)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock, 1);
+    Value<float> a = counter;
+    Value<float> b = a;
+    Value<float> c = b;
+    
+    // Blocks and samples are read from the source, not copied along the chain
+    CHECK(c.pullBlock(4) == counter.pullBlock(4));
+    clock.tick();
+    CHECK(&c() == &counter());
+}
+
+TEST(optimizedChainsOfValuesAreSkipped)
+{
+    InvariableClock clock(100);
+    Counter counter(&clock, 1);
+    Counter other(&clock, 10);
+    Value<float> a = counter;
+    Value<float> b = a;
+    Value<float> c = b;
+    c.setPersistency(true);
+    
+    clock.setOptimized(true);
+    CHECK(c.getPassThrough() == &counter);
+    CHECK(c.getActiveDependencies() == std::vector<SignalBase*>{&counter});
+    
+    // Reassigning a value in the middle of the chain collapses it anew
+    b = other;
+    clock.tick();
+    CHECK(c.getPassThrough() == &other);
+    CHECK(c() == other());
+}
+
+TEST(loopsOfValuesDontEndInASource)
+{
+    Value<float> a = 1.0f;
+    Value<float> b = a;
+    a = b;
+    CHECK(a.pullSource() == nullptr);
+    CHECK(b.pullSource() == nullptr);
+}
+
+namespace
+{
+    //! A counter letting the test know when it's destructed, unless it was moved from
+    class Tracked : public Counter
+    {
+    public:
+        Tracked(Clock* clock, bool& destructed) : Counter(clock), destructed(&destructed) { }
+        Tracked(Tracked&& rhs) : Counter(std::move(rhs)), destructed(std::exchange(rhs.destructed, nullptr)) { }
+        ~Tracked() { if (destructed) *destructed = true; }
+        
+        GENERATE_MOVE(Tracked)
+    
+    private:
+        bool* destructed = nullptr;
+    };
+}
+
+TEST(assignmentsFromAnotherThreadArePublished)
+{
+    InvariableClock clock(100);
+    Value<float> value = 0.0f;
+    Value<float> sum = value + 0.0f;
+    
+    // Constants are assigned in increasing order, so the pulling thread never sees them go back
+    std::atomic<bool> done{false};
+    std::thread assigner([&]
+    {
+        for (int i = 1; i <= 1000; ++i)
+            value = static_cast<float>(i);
+        
+        done = true;
+    });
+    
+    float previous = 0;
+    while (!done)
+    {
+        clock.tick();
+        const auto sample = sum();
+        CHECK(sample >= previous && sample <= 1000.0f);
+        previous = sample;
+    }
+    
+    assigner.join();
+    clock.tick();
+    CHECK(sum() == 1000.0f);
+}
+
+TEST(replacedSignalsAreDestructedByTheAssigningThread)
+{
+    InvariableClock clock(100);
+    bool destructed = false;
+    Value<float> value = Tracked(&clock, destructed);
+    clock.tick();
+    value();
+    
+    // The pulling thread hands the old state back once it adopted the new one
+    value = 1.0f;
+    CHECK(!destructed);
+    CHECK(value() == 1.0f);
+    
+    value = 2.0f;
+    CHECK(destructed);
+    CHECK(value() == 2.0f);
+}
+
+int main() { return run(); }
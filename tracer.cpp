@@ -0,0 +1,222 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+#include "sink.hpp"
+#include "tracer.hpp"
+
+namespace octo
+{
+    namespace
+    {
+        //! A single recorded event
+        struct Event
+        {
+            //! The name of the event, if it isn't named after a sink type
+            const char* name = nullptr;
+            
+            //! The type of the sink updated during the event, if any
+            const std::type_info* type = nullptr;
+            
+            //! The object the event is about
+            const void* object = nullptr;
+            
+            //! The time at which the event started
+            uint64_t start = 0;
+            
+            //! The duration of the event, or zero for instant events
+            uint64_t duration = 0;
+        };
+        
+        //! The events recorded by a single thread
+        struct Buffer
+        {
+            //! The events, of which the one at written % capacity is the oldest once the buffer is full
+            std::unique_ptr<Event[]> events = std::make_unique<Event[]>(Tracer::capacity);
+            
+            //! The number of events recorded so far
+            std::atomic<uint64_t> written{0};
+            
+            //! The number identifying the thread in the trace
+            std::size_t thread = 0;
+        };
+        
+        //! Guards the list of buffers
+        std::mutex mutex;
+        
+        //! The buffers of every thread that recorded something
+        std::vector<std::shared_ptr<Buffer>> buffers;
+        
+        //! The steady time and timestamp at which recording was enabled, to convert timestamps to time
+        std::chrono::steady_clock::time_point originTime;
+        uint64_t originTimestamp = 0;
+        
+        //! Return the buffer of this thread, creating it on first use
+        Buffer& getBuffer()
+        {
+            thread_local std::shared_ptr<Buffer> buffer;
+            if (!buffer)
+            {
+                buffer = std::make_shared<Buffer>();
+                std::lock_guard<std::mutex> lock(mutex);
+                buffer->thread = buffers.size();
+                buffers.emplace_back(buffer);
+            }
+            
+            return *buffer;
+        }
+        
+        //! Return the readable name of a type
+        std::string getTypeName(const std::type_info& type)
+        {
+        #if defined(__GNUC__)
+            int status = 0;
+            std::unique_ptr<char, void(*)(void*)> name(abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), std::free);
+            if (status == 0 && name)
+                return name.get();
+        #endif
+            
+            return type.name();
+        }
+        
+        //! Write a string as a JSON string literal
+        void writeString(std::ostream& stream, const std::string& string)
+        {
+            stream << '"';
+            for (auto character : string)
+            {
+                if (character == '"' || character == '\\')
+                    stream << '\\';
+                
+                stream << character;
+            }
+            
+            stream << '"';
+        }
+    }
+    
+    std::atomic<bool> Tracer::enabled{false};
+    
+    void Tracer::setEnabled(bool enabled)
+    {
+    #ifndef OCTOPUS_TRACING
+        if (enabled)
+            throw std::runtime_error("octopus was built without tracing, define OCTOPUS_TRACING to enable it");
+    #endif
+        
+        if (enabled && !isEnabled())
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (originTimestamp == 0)
+            {
+                originTime = std::chrono::steady_clock::now();
+                originTimestamp = now();
+            }
+        }
+        
+        Tracer::enabled.store(enabled, std::memory_order_relaxed);
+    }
+    
+    void Tracer::write(std::ostream& stream)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        
+        // Measure the rate of the timestamps against the steady clock, over the time since recording started
+        double nanosecondsPerTimestamp = 1;
+    #if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - originTime).count();
+        const auto elapsedTimestamps = now() - originTimestamp;
+        if (originTimestamp != 0 && elapsedTimestamps > 0)
+            nanosecondsPerTimestamp = elapsed / elapsedTimestamps;
+    #endif
+        
+        auto toMicroseconds = [&](uint64_t timestamp){ return static_cast<int64_t>(timestamp - originTimestamp) * nanosecondsPerTimestamp / 1000.0; };
+        
+        stream << "{\"traceEvents\":[";
+        bool first = true;
+        for (auto& buffer : buffers)
+        {
+            const auto written = buffer->written.load(std::memory_order_acquire);
+            const auto begin = written > capacity ? written - capacity : 0;
+            for (auto i = begin; i < written; ++i)
+            {
+                const auto& event = buffer->events[i % capacity];
+                stream << (first ? "\n" : ",\n");
+                first = false;
+                
+                stream << "{\"name\":";
+                writeString(stream, event.type ? getTypeName(*event.type) : event.name);
+                stream << ",\"cat\":\"" << (event.type ? "update" : "octopus") << "\"";
+                stream << ",\"ph\":\"" << (event.duration ? "X" : "i") << "\"";
+                stream << ",\"ts\":" << toMicroseconds(event.start);
+                if (event.duration)
+                    stream << ",\"dur\":" << event.duration * nanosecondsPerTimestamp / 1000.0;
+                else
+                    stream << ",\"s\":\"t\"";
+                
+                stream << ",\"pid\":1,\"tid\":" << buffer->thread;
+                stream << ",\"args\":{\"object\":\"" << event.object << "\"}}";
+            }
+        }
+        
+        stream << "\n]}\n";
+    }
+    
+    void Tracer::reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& buffer : buffers)
+            buffer->written.store(0, std::memory_order_relaxed);
+    }
+    
+    void Tracer::record(const char* name, const Sink* sink, const void* object, uint64_t start, uint64_t duration)
+    {
+        auto& buffer = getBuffer();
+        const auto index = buffer.written.load(std::memory_order_relaxed);
+        
+        auto& event = buffer.events[index % capacity];
+        event.name = name;
+        event.type = sink ? &typeid(*sink) : nullptr;
+        event.object = object;
+        event.start = start;
+        event.duration = duration;
+        
+        buffer.written.store(index + 1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,165 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_TRACER_HPP
+#define OCTOPUS_TRACER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace octo
+{
+    class Sink;
+    
+    //! Records a timeline of what happens during ticks, viewable in Chrome or Perfetto
+    /*! The tracer records clock ticks, sink updates, tasks run by a ParallelExecutor and Value reassignments.
+        Every thread records into its own ring buffer, without locks, keeping the most recent events once
+        it's full. The recording can be written as Chrome trace JSON and opened in chrome://tracing or
+        https://ui.perfetto.dev to see how a tick unfolds across the graph and threads:
+        @code{cpp}
+        Tracer::setEnabled(true);
+        for (auto i = 0; i < 64; ++i)
+            audio.tick();
+        
+        Tracer::setEnabled(false);
+        std::ofstream file("trace.json");
+        Tracer::write(file);
+        @endcode
+        
+        Tracing is compiled in by defining OCTOPUS_TRACING (see the CMake option of the same name), for the
+        library and everything including its headers. Without it, the hooks compile to nothing. With it,
+        they cost a single branch until the tracer is enabled, and a few nanoseconds per event after that
+        (timestamps are read from the CPU's time stamp counter where available). A thread allocates its
+        ring buffer when it records its first event. */
+    class Tracer
+    {
+    public:
+        class Scope;
+        
+        //! The number of events each thread keeps
+        static constexpr std::size_t capacity = std::size_t(1) << 16;
+    
+    public:
+        //! Start or stop recording
+        /*! @throw std::runtime_error if the library was built without OCTOPUS_TRACING */
+        static void setEnabled(bool enabled);
+        
+        //! Is the tracer recording?
+        static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+        
+        //! Write the recorded events as Chrome trace JSON
+        /*! Only call this while no thread is recording (e.g. after disabling the tracer and finishing the tick). */
+        static void write(std::ostream& stream);
+        
+        //! Forget the recorded events
+        /*! Only call this while no thread is recording. */
+        static void reset();
+        
+        //! Record something happening at a single point in time
+        /*! @param name A string literal (or another string that outlives the recording) */
+        static void recordInstant(const char* name, const void* object)
+        {
+            if (isEnabled())
+                record(name, nullptr, object, now(), 0);
+        }
+    
+    private:
+        //! Return the current time, in ticks of the time stamp counter (or nanoseconds)
+        static uint64_t now();
+        
+        //! Record an event on this thread
+        /*! @param sink The sink the event is about, whose type names the event instead of name */
+        static void record(const char* name, const Sink* sink, const void* object, uint64_t start, uint64_t duration);
+    
+    private:
+        //! Is the tracer recording?
+        static std::atomic<bool> enabled;
+    };
+    
+    //! Records an event spanning the lifetime of the scope
+    class Tracer::Scope
+    {
+    public:
+        //! Start the event, if the tracer is enabled
+        /*! @param name A string literal (or another string that outlives the recording) */
+        Scope(const char* name, const void* object) :
+            name(name),
+            object(object)
+        {
+            if (isEnabled())
+                start = now();
+        }
+        
+        //! Start an update of a sink, if the tracer is enabled
+        Scope(const Sink& sink) :
+            sink(&sink),
+            object(&sink)
+        {
+            if (isEnabled())
+                start = now();
+        }
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        
+        //! Finish the event
+        ~Scope()
+        {
+            if (start)
+                record(name, sink, object, start, std::max<uint64_t>(now() - start, 1));
+        }
+    
+    private:
+        //! The name of the event
+        const char* name = nullptr;
+        
+        //! The sink updated during the event, if any
+        const Sink* sink = nullptr;
+        
+        //! The object the event is about
+        const void* object = nullptr;
+        
+        //! The time the event started, or zero if the tracer was disabled
+        uint64_t start = 0;
+    };
+    
+    inline uint64_t Tracer::now()
+    {
+    #if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        return __builtin_ia32_rdtsc();
+    #else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    #endif
+    }
+}
+
+#endif
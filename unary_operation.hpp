@@ -29,6 +29,9 @@
 #ifndef OCTOPUS_UNARY_OPERATION_HPP
 #define OCTOPUS_UNARY_OPERATION_HPP
 
+#include <cstddef>
+#include <vector>
+
 #include "signal.hpp"
 #include "value.hpp"
 
@@ -54,6 +57,9 @@ namespace octo
             
         }
         
+        // Inherited from SignalBase
+        std::vector<SignalBase*> getDependencies() final override { return {&input}; }
+    
     public:
         //! The input to the operation
         Value<In> input;
@@ -62,11 +68,25 @@ namespace octo
         //! Convert the sample
         virtual void convertSample(const In& in, Out& out) = 0;
         
+        //! Convert a block of samples
+        /*! The default implementation calls convertSample() for each frame. Override it for a faster path. */
+        virtual void convertBlock(const In* in, Out* out, std::size_t size)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                convertSample(in[i], out[i]);
+        }
+        
         //! Generate a new sample by transforming it from input to output
         void generateSample(Out& out) final override
         {
             convertSample(input(), out);
         }
+        
+        //! Generate a new block of samples by transforming them from input to output
+        void generateBlock(Out* out, std::size_t size) final override
+        {
+            convertBlock(input.pullBlock(size), out, size);
+        }
     };
 }
 
@@ -29,13 +29,19 @@
 #ifndef OCTOPUS_VALUE_HPP
 #define OCTOPUS_VALUE_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <memory>
-#include <mutex>
-#include <set>
+#include <memory_resource>
+#include <new>
 #include <stdexcept>
 
+#include "graph_arena.hpp"
 #include "signal.hpp"
+#include "small_set.hpp"
+#include "tracer.hpp"
 
 namespace octo
 {
@@ -77,21 +83,31 @@ namespace octo
         
     public:
         //! Construct a value with constant value
+        /*! The constant is stored in the value itself, a state is only allocated once the value is reassigned */
         Value(const T& constant = T{}) :
             Signal<T>(nullptr, constant),
-            mode(ValueMode::CONSTANT),
-            constant(constant)
+            initial(constant)
         {
             
         }
         
         //! Construct a value referencing another signal
+        /*! The signal is pulled right away, so the value starts out with its current sample. Construct
+            values on the thread ticking the signal, or while it isn't ticking. Control threads reassign
+            values instead, which doesn't pull. */
         Value(Signal<T>& reference) :
             Signal<T>(reference.getClock(), reference()),
-            mode(ValueMode::REFERENCE),
-            reference(&reference)
+            current(makeReference(reference).release()),
+            latest(current)
         {
             reference.dependees.emplace(this);
+            
+            // Nothing refers to a new value yet, so the chain of a value it refers to can't lead back here
+            auto value = dynamic_cast<Value*>(&reference);
+            if (value && value->isReference())
+                share(*current, *value->latest);
+            else
+                resolve(*current);
         }
         
         //! Reference another Value
@@ -99,16 +115,24 @@ namespace octo
         Value(Value& reference) : Value(dynamic_cast<Signal<T>&>(reference)) { }
         
         //! Construct a value owning an internal signal
-        Value(Signal<T>&& internal) : Value(std::move(internal).moveToHeap()) { }
+        /*! Small signals are stored inline, sharing an allocation with the state of the value. The signal
+            is pulled right away, so the value starts out with its current sample. */
+        Value(Signal<T>&& internal) :
+            Signal<T>(internal.getClock(), internal.pull()),
+            current(makeInternal(std::move(internal)).release()),
+            latest(current)
+        {
+        
+        }
         
         //! Construct a value owning an internal signal
         Value(std::unique_ptr<Signal<T>> internal) :
-            Signal<T>(internal->getClock(), internal->pull()),
-            mode(ValueMode::INTERNAL),
-            internal(std::move(internal))
+            Signal<T>(internal ? internal->getClock() : nullptr, internal ? internal->pull() : T{})
         {
-            if (!this->internal)
+            if (!internal)
                 throw std::invalid_argument("value cannot contain a nullptr internal signal");
+            
+            current = latest = makeInternal(std::move(internal)).release();
         }
         
         //! Copying a Value is forbidden
@@ -116,44 +140,48 @@ namespace octo
         
         //! Moving from a value
         Value(Value&& rhs) :
-            Signal<T>(nullptr, rhs())
+            Signal<T>(rhs.getClock())
         {
-            if (&rhs == this)
-                return;
+            // Take over the states of rhs and have it start over with a fresh one
+            rhs.reclaim();
+            current = rhs.current;
+            latest = rhs.latest;
+            initial = rhs.initial;
+            pending.store(rhs.pending.exchange(nullptr, std::memory_order_acquire), std::memory_order_release);
+            rhs.current = rhs.latest = nullptr;
+            rhs.initial = T{};
             
-            switch (mode = rhs.mode)
+            if (isReference())
             {
-                case ValueMode::CONSTANT:
-                    new (&constant) T(rhs.constant);
-                    break;
-                case ValueMode::REFERENCE:
-                    reference = rhs.reference;
-                    setClock(reference->getClock());
-                    break;
-                case ValueMode::INTERNAL:
-                    new (&internal) std::unique_ptr<Signal<T>>(std::move(rhs.internal));
-                    setClock(internal->getClock());
-                    break;
+                latest->signal->dependees.erase(&rhs);
+                latest->signal->dependees.emplace(this);
+                republish(nullptr);
             }
-                        
-            rhs.reset();
+            
+            rhs.follow();
+            rhs.republishDependees();
+            rhs.notifyConstantSet();
         }
         
         //! Destruct the value and release any contained data
-        ~Value() { reset(); assert(listeners.empty()); }
+        /*! The value isn't reset, because rebuilding the execution plans that include it could walk the
+            signal it is a member of, which is being destroyed (see Sink::graphChanged()). */
+        ~Value()
+        {
+            if (isReference())
+                latest->signal->dependees.erase(this);
+            
+            assert(listeners.empty());
+            
+            State::release(pending.exchange(nullptr, std::memory_order_acquire));
+            State::release(current);
+            reclaim();
+        }
         
         //! Assign a new constant to the value
         Value& operator=(const T& constant)
         {
-            {
-                std::unique_lock<std::mutex> lock(mutex);
-                deconstruct();
-                
-                mode = ValueMode::CONSTANT;
-                new (&this->constant) T(constant);
-                setClock(nullptr);
-            }
-            
+            assign(makeConstant(constant));
             notifyConstantSet();
             
             return *this;
@@ -162,20 +190,10 @@ namespace octo
         //! Have the value reference another signal
         Value& operator=(Signal<T>& reference)
         {
-            if (isReference() && this->reference == &reference)
+            if (isReference() && latest->signal == &reference)
                 return *this;
             
-            {
-                std::unique_lock<std::mutex> lock(mutex);
-                deconstruct();
-                
-                mode = ValueMode::REFERENCE;
-                new (&this->reference) Signal<T>*(&reference);
-                
-                reference.dependees.emplace(this);
-                setClock(reference.getClock());
-            }
-            
+            assign(makeReference(reference));
             notifySignalSet();
             
             return *this;
@@ -184,7 +202,10 @@ namespace octo
         //! Have the value contain another signal
         Value& operator=(Signal<T>&& internal)
         {
-            return *this = std::move(internal).moveToHeap();
+            assign(makeInternal(std::move(internal)));
+            notifySignalSet();
+            
+            return *this;
         }
         
         //! Have the value contain another signal
@@ -193,15 +214,7 @@ namespace octo
             if (!internal)
                 throw std::invalid_argument("nullptr given to Value");
             
-            {
-                std::unique_lock<std::mutex> lock(mutex);
-                deconstruct();
-                
-                mode = ValueMode::INTERNAL;
-                new (&this->internal) std::unique_ptr<Signal<T>>(std::move(internal));
-                setClock(internal->getClock());
-            }
-            
+            assign(makeInternal(std::move(internal)));
             notifySignalSet();
             
             return *this;
@@ -216,26 +229,25 @@ namespace octo
             if (&rhs == this)
                 return *this;
             
-            if (mode != rhs.mode ||
-                (isConstant() && constant != rhs.constant) ||
-                (isReference() && reference != rhs.reference))
+            switch (getMode(rhs.latest))
             {
-                std::unique_lock<std::mutex> lock(mutex);
-                deconstruct();
-                switch ((mode = rhs.mode))
-                {
-                    case ValueMode::CONSTANT: new (&constant) T(rhs.constant); setClock(nullptr); break;
-                    case ValueMode::REFERENCE: reference = rhs.reference; setClock(rhs.reference); break;
-                    case ValueMode::INTERNAL: new (&internal) std::unique_ptr<Signal<T>>(std::move(rhs.internal)); setClock(internal->getClock()); break;
-                }
-            }
-            
-            // We're notifying in a different switch, so that we can unlock the mutex earlier
-            switch (mode)
-            {
-                case ValueMode::CONSTANT: notifyConstantSet(); break;
-                case ValueMode::REFERENCE: notifyConstantSet(); break;
-                case ValueMode::INTERNAL: notifyConstantSet(); break;
+                case ValueMode::CONSTANT:
+                    *this = rhs.getConstant();
+                    break;
+                case ValueMode::REFERENCE:
+                    *this = *rhs.latest->signal;
+                    break;
+                case ValueMode::INTERNAL:
+                    // Nobody should be pulling a Value that is being moved from, so steal its signal
+                    // (signals stored inline can't be stolen, so those are moved instead)
+                    if (rhs.latest->internal)
+                    {
+                        *this = std::move(rhs.latest->internal);
+                        rhs.latest->signal = nullptr;
+                    } else {
+                        *this = std::move(*rhs.latest->signal);
+                    }
+                    break;
             }
             
             rhs.reset();
@@ -254,13 +266,13 @@ namespace octo
         }
         
         //! Is this value a constant?
-        bool isConstant() const noexcept { return mode == ValueMode::CONSTANT; }
+        bool isConstant() const noexcept { return getMode(latest) == ValueMode::CONSTANT; }
         
         //! Is this value a reference?
-        bool isReference() const noexcept { return mode == ValueMode::REFERENCE; }
+        bool isReference() const noexcept { return getMode(latest) == ValueMode::REFERENCE; }
         
         //! Is this value an internal signal?
-        bool isInternal() const noexcept { return mode == ValueMode::INTERNAL; }
+        bool isInternal() const noexcept { return getMode(latest) == ValueMode::INTERNAL; }
         
         //! Return the constant value this object will output
         /*! @throw std::runtime_error if the value is not a constant */
@@ -269,65 +281,531 @@ namespace octo
             if (!isConstant())
                 throw std::runtime_error("value is not constant");
             
-            return constant;
+            return latest ? latest->constant : initial;
+        }
+        
+        //! Return the constant the value outputs right now, or nullptr if it outputs a signal
+        /*! Unlike isConstant() and getConstant(), this reflects what the thread pulling the value sees,
+            so it's meant to be called from there (e.g. to broadcast constants in block processing). */
+        const T* pullConstant()
+        {
+            // Signals folded into constants (see GraphOptimizer) are treated as constants too
+            if (this->folded)
+                return &(*this)();
+            
+            auto state = acquire();
+            if (!state)
+                return &initial;
+            
+            if (!state->source)
+                return &state->constant;
+            
+            return state->signal->isFolded() ? &(*state->signal)() : nullptr;
+        }
+        
+        //! Return the signal at the end of a chain of Values, or nullptr if the chain ends in a constant
+        /*! Like pullConstant(), this reflects what the thread pulling the value sees. Chains that end in
+            a constant or loop back onto themselves don't end in a signal either. */
+        Signal<T>* pullSource()
+        {
+            auto state = acquire();
+            if (!state || !state->source || dynamic_cast<Value*>(state->source))
+                return nullptr;
+            
+            return state->source;
         }
         
         //! Return a reference to the contained/referenced signal
         /*! @throw std::runtime_error if the value is a constant */
         Signal<T>& getReference() const
         {
-            switch (mode)
-            {
-                case ValueMode::CONSTANT: throw std::runtime_error("value is constant");
-                case ValueMode::REFERENCE: return *reference;
-                case ValueMode::INTERNAL: return *internal;
-            }
+            if (isConstant())
+                throw std::runtime_error("value is constant");
+            
+            return *latest->signal;
+        }
+        
+        // Inherited from SignalBase
+        std::vector<SignalBase*> getDependencies() final override
+        {
+            auto state = acquire();
+            if (getMode(state) == ValueMode::CONSTANT)
+                return {};
+            
+            return {state->signal};
+        }
+        
+        std::vector<SignalBase*> getAssignedDependencies() final override
+        {
+            if (isConstant())
+                return {};
+            
+            return {latest->signal};
+        }
+        
+        //! Keep the latest state, and with it an internal signal, alive for as long as the pin is held
+        std::shared_ptr<void> pinAssigned() final override
+        {
+            if (!isInternal())
+                return nullptr;
+            
+            latest->references.fetch_add(1, std::memory_order_relaxed);
+            return std::shared_ptr<void>(latest, [](void* state){ State::release(static_cast<State*>(state)); });
         }
         
         GENERATE_MOVE(Value)
         
+        //! Return the memory owned by the value, including its states (an inline internal signal counts as a signal of its own)
+        std::size_t getHeapSize() const final override
+        {
+            const std::size_t states = (current ? 1 : 0) + (latest && latest != current ? 1 : 0);
+            return Signal<T>::getHeapSize() + listeners.getHeapSize() + states * sizeof(State);
+        }
+        
+        // Inherited from SignalBase
+        bool isPure() const final override { return true; }
+        
+        //! Values relay other signals, so there is nothing to share
+        bool isSameOperation(const SignalBase& other) const final override { return false; }
+        
+        SignalBase* pullRelayed() final override
+        {
+            auto source = pullSource();
+            return source ? source : this;
+        }
+        
+        bool isSameInput(const SignalBase& other) const final override
+        {
+            auto value = dynamic_cast<const Value*>(&other);
+            if (!value)
+                return false;
+            
+            auto& lhs = getOrigin();
+            auto& rhs = value->getOrigin();
+            if constexpr (IsEqualityComparable<T>::value)
+                return lhs == rhs;
+            else
+                return !lhs.isConstant() && !rhs.isConstant() && &lhs.getReference() == &rhs.getReference();
+        }
+        
+        std::size_t hashInput() const final override
+        {
+            auto& origin = getOrigin();
+            if (!origin.isConstant())
+                return std::hash<const void*>()(&origin.getReference());
+            
+            if constexpr (IsHashable<T>::value)
+                return std::hash<T>()(origin.getConstant());
+            else
+                return 0;
+        }
+    
+    private:
+        //! Return the value at the end of a chain of values referring to each other
+        /*! Unlike pullSource(), this reflects what the thread assigning to the values sees. */
+        const Value& getOrigin() const
+        {
+            auto origin = this;
+            while (!origin->isConstant())
+            {
+                auto next = dynamic_cast<const Value*>(&origin->getReference());
+                if (!next || next == this)
+                    break;
+                
+                origin = next;
+            }
+            
+            return *origin;
+        }
+    
     public:
         //! A collection of listeners for Value events
-        std::set<Listener*> listeners;
+        SmallSet<Listener*> listeners;
         
+    private:
+        //! An immutable snapshot of what the value outputs
+        /*! Assigning to a Value publishes a new state, which the thread pulling the Value adopts the
+            next time it generates a sample. Old states are handed back and deleted by the assigning
+            thread, so the pulling thread never blocks, allocates or deallocates. Execution plans compiled
+            by the assigning thread share ownership of the states they include (see pinAssigned()).
+            
+            Internal signals that support it (see Signal::moveTo()) are stored inline, right behind the
+            state in the same allocation. That saves an allocation and an indirection per internal signal.
+            Inside a GraphArena::Scope, states are allocated from the memory resource of the scope. Values
+            constructed with a constant have no state at all (nullptr) until they're reassigned. */
+        struct alignas(std::max_align_t) State
+        {
+            State() = default;
+            State(const State&) = delete;
+            State& operator=(const State&) = delete;
+            
+            //! Destruct the state, and the internal signal if it's stored inline
+            ~State()
+            {
+                if (isInline())
+                    signal->~Signal();
+                
+                release(pinned);
+            }
+            
+            //! Create a state, from the memory resource of the current GraphArena::Scope if there is one
+            /*! @param storageSize The size of the storage for an inline signal behind the state */
+            static State* create(std::size_t storageSize = 0)
+            {
+                auto resource = GraphArena::getCurrentResource();
+                const auto size = sizeof(State) + storageSize;
+                auto state = new (resource ? resource->allocate(size, alignof(State)) : ::operator new(size)) State;
+                state->resource = resource;
+                return state;
+            }
+            
+            //! Give up ownership of a state, destructing it and returning its memory if it was the last owner
+            static void release(State* state)
+            {
+                if (!state || state->references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                    return;
+                
+                const auto resource = state->resource;
+                const auto size = sizeof(State) + (state->isInline() ? state->signal->getStorageSize() : 0);
+                state->~State();
+                
+                if (resource)
+                    resource->deallocate(state, size, alignof(State));
+                else
+                    ::operator delete(state);
+            }
+            
+            //! Is the internal signal stored inline, behind the state?
+            bool isInline() const { return mode == ValueMode::INTERNAL && !internal && signal; }
+            
+            //! Return the storage behind the state, if it was allocated with any
+            void* getStorage() { return this + 1; }
+            
+            //! The mode the value is in
+            ValueMode mode = ValueMode::CONSTANT;
+            
+            //! The constant value, if mode == ValueMode::CONSTANT, or the constant a chain of values ends in
+            T constant = T{};
+            
+            //! The referenced or internal signal, if mode != ValueMode::CONSTANT
+            Signal<T>* signal = nullptr;
+            
+            //! Owns the internal signal, if mode == ValueMode::INTERNAL and it isn't stored inline
+            std::unique_ptr<Signal<T>> internal;
+            
+            //! The signal at the end of the chain of values starting at signal (see resolve())
+            /*! nullptr if the value outputs the constant, because it's constant or the chain ends in one */
+            Signal<T>* source = nullptr;
+            
+            //! The state of another value that owns source, kept alive for as long as this state is
+            State* pinned = nullptr;
+            
+            //! The next state in the list of retired states
+            State* next = nullptr;
+            
+            //! The memory resource the state was allocated from, if any
+            std::pmr::memory_resource* resource = nullptr;
+            
+            //! The number of owners of the state (the value, execution plans and states of other values pinning it)
+            std::atomic<std::size_t> references{1};
+        };
+        
+        //! Destroys states owned by a std::unique_ptr
+        struct StateDeleter
+        {
+            void operator()(State* state) const { State::release(state); }
+        };
+        
+        //! A state that hasn't been published yet
+        using StatePointer = std::unique_ptr<State, StateDeleter>;
+    
     private:
         using Sink::setClock;
-                              
-        //! Deconstructs what's in the union
-        /*! Internal use only. A new construction should take place immediately afterwards */
-        void deconstruct()
+        
+        //! Return the mode of a state (nullptr stands for the constant the value was constructed with)
+        static ValueMode getMode(const State* state) { return state ? state->mode : ValueMode::CONSTANT; }
+        
+        //! Create a state holding a constant
+        static StatePointer makeConstant(const T& constant)
+        {
+            StatePointer state(State::create());
+            state->constant = constant;
+            return state;
+        }
+        
+        //! Create a state referencing another signal
+        static StatePointer makeReference(Signal<T>& reference)
+        {
+            StatePointer state(State::create());
+            state->mode = ValueMode::REFERENCE;
+            state->signal = &reference;
+            state->source = &reference;
+            return state;
+        }
+        
+        //! Create a state owning an internal signal, stored inline if possible
+        static StatePointer makeInternal(Signal<T>&& internal)
         {
-            switch (mode)
+            const auto size = internal.getStorageSize();
+            if (size == 0)
+                return makeInternal(std::move(internal).moveToHeap());
+            
+            StatePointer state(State::create(size));
+            state->mode = ValueMode::INTERNAL;
+            state->signal = std::move(internal).moveTo(state->getStorage());
+            state->source = state->signal;
+            return state;
+        }
+        
+        //! Create a state owning an internal signal on the heap
+        static StatePointer makeInternal(std::unique_ptr<Signal<T>> internal)
+        {
+            StatePointer state(State::create());
+            state->mode = ValueMode::INTERNAL;
+            state->signal = internal.get();
+            state->source = state->signal;
+            state->internal = std::move(internal);
+            return state;
+        }
+        
+        //! Replace the state of the value (called by the assigning thread)
+        void assign(StatePointer state)
+        {
+            if (isReference())
+                latest->signal->dependees.erase(this);
+            
+            if (state->mode == ValueMode::REFERENCE)
+                state->signal->dependees.emplace(this);
+            
+            const bool resolved = state->mode == ValueMode::REFERENCE && resolve(*state);
+            publish(std::move(state));
+            follow();
+            republishDependees(resolved);
+        
+        #ifdef OCTOPUS_TRACING
+            Tracer::recordInstant("value assigned", this);
+        #endif
+        }
+        
+        //! Make a state the latest one (called by the assigning thread)
+        void publish(StatePointer state)
+        {
+            reclaim();
+            
+            // A state that was never adopted can be released right away
+            latest = state.get();
+            State::release(pending.exchange(state.release(), std::memory_order_acq_rel));
+        }
+        
+        //! Publish the latest state again, because the chain of values it refers to changed
+        /*! @param target The latest state of the referenced value, if it was resolved without running into a loop */
+        void republish(const State* target)
+        {
+            auto state = makeReference(*latest->signal);
+            
+            // The referenced value can't lead back here, so its chain ends where this one does
+            bool resolved = true;
+            if (target)
+                share(*state, *target);
+            else
+                resolved = resolve(*state);
+            
+            // If the chain still ends in the same place, neither this value nor the ones referring to it change
+            if (isSameEnd(*state, *latest))
+                return;
+            
+            publish(std::move(state));
+            republishDependees(resolved);
+        }
+        
+        //! Have the values referring to this one resolve the chain they refer to again
+        /*! @param resolved Was the latest state resolved without running into a loop? */
+        void republishDependees(bool resolved = false)
+        {
+            // Loops of values would republish each other forever
+            if (republishing)
+                return;
+            
+            republishing = true;
+            for (auto& dependee : this->dependees)
             {
-                case ValueMode::CONSTANT:
-                    constant.~T();
-                    break;
-                case ValueMode::REFERENCE:
-                    reference->dependees.erase(this);
-                    reference = nullptr;
-                    break;
-                case ValueMode::INTERNAL:
-                    internal.~unique_ptr();
-                    break;
+                auto value = dynamic_cast<Value*>(dependee);
+                if (value && value->isReference() && value->latest->signal == this)
+                    value->republish(resolved ? latest : nullptr);
+            }
+            
+            republishing = false;
+        }
+        
+        //! Have a state end where the resolved state of the value it refers to ends
+        static void share(State& state, const State& target)
+        {
+            state.source = target.source;
+            if (!state.source)
+                state.constant = target.constant;
+            
+            state.pinned = target.pinned;
+            if (state.pinned)
+                state.pinned->references.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        //! Find the signal at the end of the chain of values a state refers to (called by the assigning thread)
+        /*! Parameters are often routed through several values referring to each other. Pulling the end of the
+            chain directly costs a single update instead of one per value. The chain is followed as the
+            assigning thread sees it, and stored in the state, so the pulling thread never touches the values
+            in between. The state pins the state that owns the end of the chain, so it can't be deleted while
+            it's being pulled. Chains ending in a constant store a copy of it instead. Whenever a value in the
+            chain is reassigned, the values referring to it publish their state again (see republishDependees()).
+            @return false if the chain runs into a loop */
+        bool resolve(State& state)
+        {
+            // Follow the chain until it ends in a signal or a constant. Loops of values are detected by
+            // having a second pointer follow at half the speed, and aren't collapsed.
+            Signal<T>* fast = state.signal;
+            Signal<T>* slow = state.signal;
+            Value* owner = nullptr;
+            bool step = false;
+            while (auto value = dynamic_cast<Value*>(fast))
+            {
+                // Chains ending in a constant output a copy of it
+                if (value->isConstant())
+                {
+                    state.source = nullptr;
+                    state.constant = value->getConstant();
+                    return true;
+                }
+                
+                owner = value;
+                fast = value->latest->signal;
+                if (step)
+                    slow = static_cast<Value*>(slow)->latest->signal;
+                
+                step = !step;
+                if (fast == slow || fast == this)
+                {
+                    state.source = state.signal;
+                    return false;
+                }
             }
+            
+            state.source = fast;
+            if (owner && owner->isInternal() && owner->latest->signal == fast)
+            {
+                owner->latest->references.fetch_add(1, std::memory_order_relaxed);
+                state.pinned = owner->latest;
+            }
+            
+            return true;
+        }
+        
+        //! Do two states referring to the same signal pull the same end of the chain?
+        static bool isSameEnd(const State& lhs, const State& rhs)
+        {
+            if (lhs.source != rhs.source || lhs.pinned != rhs.pinned)
+                return false;
+            
+            if (lhs.source)
+                return true;
+            
+            if constexpr (IsEqualityComparable<T>::value)
+                return lhs.constant == rhs.constant;
+            else
+                return false;
+        }
+        
+        //! Move to the clock of the latest state, and have the plans including the value rebuilt
+        void follow()
+        {
+            auto clock = isConstant() ? nullptr : latest->signal->getClock();
+            if (clock != this->getClock())
+                setClock(clock);
+            else
+                this->graphChanged();
+        }
+        
+        //! Delete the states handed back by the pulling thread (called by the assigning thread)
+        void reclaim()
+        {
+            auto state = retired.exchange(nullptr, std::memory_order_acquire);
+            while (state)
+            {
+                auto next = state->next;
+                State::release(state);
+                state = next;
+            }
+        }
+        
+        //! Return the current state, adopting the latest published one (called by the pulling thread)
+        /*! This costs a single atomic load, unless a new state was published.
+            @return nullptr if the value still outputs the constant it was constructed with */
+        State* acquire()
+        {
+            if (pending.load(std::memory_order_relaxed))
+            {
+                if (auto state = pending.exchange(nullptr, std::memory_order_acquire))
+                {
+                    // Hand the old state back to the assigning thread
+                    if (current)
+                    {
+                        current->next = retired.load(std::memory_order_relaxed);
+                        while (!retired.compare_exchange_weak(current->next, current, std::memory_order_release, std::memory_order_relaxed));
+                    }
+                    
+                    current = state;
+                }
+            }
+            
+            return current;
         }
         
         //! Generate a new sample
         void generateSample(T& out) final override
         {
-            std::unique_lock<std::mutex> lock(mutex);
-            switch (mode)
+            // Pass samples of signals through, without copying them
+            auto state = acquire();
+            if (!state || !state->source)
             {
-                case ValueMode::CONSTANT: out = constant; break;
-                case ValueMode::REFERENCE: out = (*reference)(); break;
-                case ValueMode::INTERNAL: out = (*internal)(); break;
+                out = state ? state->constant : initial;
+                this->forward(nullptr);
+            } else {
+                this->forward(&(*state->source)());
             }
         }
         
+        //! Generate a new block of samples
+        void generateBlock(T* out, std::size_t size) final override
+        {
+            auto state = acquire();
+            if (!state || !state->source)
+                std::fill_n(out, size, state ? state->constant : initial);
+            else
+                this->forwardBlock(state->source->pullBlock(size));
+        }
+        
+        //! Pass the signal at the end of a chain of values through, so compiled graphs skip the values in between
+        Signal<T>* simplify() final override
+        {
+            return pullSource();
+        }
+        
+        //! Values only have a constant output if the end of their chain does
+        bool hasConstantOutput() final override
+        {
+            auto state = acquire();
+            if (!state || !state->source)
+                return true;
+            
+            // Loops of values never end in a constant
+            if (dynamic_cast<Value*>(state->source))
+                return false;
+            
+            return state->source->isMemoizable();
+        }
+        
         //! Reset the value, because the referenced signal will be destructed
         void disconnectFromDependent(SignalBase& dependent) final override
         {
-            assert(reference == &dependent);
+            assert(!isConstant() && latest->signal == &dependent);
             reset();
         }
         
@@ -335,35 +813,34 @@ namespace octo
         {
             const auto temp = listeners;
             for (auto& listener : temp)
-                listener->setToConstant(*this, constant);
+                listener->setToConstant(*this, getConstant());
         }
         
         void notifySignalSet()
         {
             const auto temp = listeners;
             for (auto& listener : temp)
-                listener->setToSignal(*this, isReference() ? *reference : *internal);
+                listener->setToSignal(*this, *latest->signal);
         }
         
     private:
-        //! The mode state which the value is in
-        ValueMode mode = ValueMode::CONSTANT;
+        //! The state used by the pulling thread
+        State* current = nullptr;
         
-        //! The union that stores the value data
-        union
-        {
-            //! Holds static value if mode == ValueMode::VALUE
-            T constant;
-            
-            //! Holds non-owned signal pointer if mode == ValueMode::NON_OWNED
-            Signal<T>* reference;
-            
-            //! Holds owned signal unique_ptr if mode == ValueMode::OWNED
-            std::unique_ptr<Signal<T>> internal;
-        };
+        //! The most recently assigned state, used by the assigning thread
+        State* latest = nullptr;
+        
+        //! A state that has been published, but not yet adopted by the pulling thread
+        std::atomic<State*> pending{nullptr};
+        
+        //! States handed back by the pulling thread, waiting to be deleted
+        std::atomic<State*> retired{nullptr};
+        
+        //! Are the values referring to this one being republished? (see republishDependees())
+        bool republishing = false;
         
-        //! A mutex for updating the value reference
-        std::mutex mutex;
+        //! The constant the value was constructed with, output for as long as it has no state
+        T initial = T{};
     };
     
     //! Listener for events that happen to a Value
@@ -388,10 +865,10 @@ namespace octo
     template <class T>
     bool operator==(const Value<T>& lhs, const Value<T>& rhs)
     {
-        if (lhs.isConstant() && rhs.isConstant())
-            return lhs.getConstant() == rhs.getConstant();
+        if (lhs.isConstant() || rhs.isConstant())
+            return lhs.isConstant() && rhs.isConstant() && lhs.getConstant() == rhs.getConstant();
         
-        return &lhs.getReference() == rhs.getReference();
+        return &lhs.getReference() == &rhs.getReference();
     }
     
     //! Compare two values for inequality
@@ -0,0 +1,174 @@
+/*
+ 
+ This file is a part of Octopus, a modern C++ library for embedding digital
+ signal processing as a language inside your software. It transcends a single
+ domain (audio, video, math, etc.), combining multiple clocks in one graph.
+ 
+ Copyright (C) 2017 Dsperados <info@dsperados.com>
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>
+ 
+ --------------------------------------------------------------------
+ 
+ If you would like to use Octopus for commercial or closed-source
+ purposes, please contact us for a commercial license.
+ 
+ */
+
+#ifndef OCTOPUS_ZIP_HPP
+#define OCTOPUS_ZIP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "signal.hpp"
+#include "value.hpp"
+
+namespace octo
+{
+    //! Combines the samples of two input signals with a function
+    /*! Unlike subclasses of BinaryOperation, the function isn't called through a virtual function, so the
+        compiler can inline it into the per-sample and per-block loops. Zips are easiest created using zip()
+        @code{cpp}
+        auto ring = zip(sine, saw, [](float x, float y){ return x * y; });
+        @endcode */
+    template <class F, class Left, class Right = Left, class Out = std::decay_t<std::invoke_result_t<F&, const Left&, const Right&>>>
+    class Zip : public Signal<Out>
+    {
+    public:
+        //! Construct the zip with its two inputs and the function to combine them with
+        Zip(Clock* clock, Value<Left> left, Value<Right> right, F function) :
+            Signal<Out>(clock),
+            left(std::move(left)),
+            right(std::move(right)),
+            function(std::move(function))
+        {
+        
+        }
+        
+        GENERATE_MOVE(Zip)
+        
+        // Inherited from SignalBase
+        std::vector<SignalBase*> getDependencies() final override { return {&left, &right}; }
+        bool isPure() const final override { return pure; }
+        
+        //! Zips with state in their function (e.g. lambda captures) are never shared
+        bool isSameOperation(const SignalBase& other) const final override
+        {
+            return std::is_empty<F>::value && SignalBase::isSameOperation(other);
+        }
+    
+    public:
+        //! The left-hand side of the zip
+        Value<Left> left;
+        
+        //! The right-hand side of the zip
+        Value<Right> right;
+        
+        //! Does the function only depend on its inputs?
+        /*! Pure zips are folded, shared and skipped like the built-in operations (see SignalBase::isPure()) */
+        bool pure = false;
+    
+    private:
+        //! Generate a new sample
+        void generateSample(Out& out) final override
+        {
+            out = function(left(), right());
+        }
+        
+        //! Generate a new block of samples
+        void generateBlock(Out* out, std::size_t size) final override
+        {
+            if (size == 0)
+                return;
+            
+            // Constants are combined as a whole, instead of being broadcast into blocks first (two constants
+            // are combined once by pure functions, impure functions may return something else each call)
+            const auto leftConstant = left.pullConstant();
+            const auto rightConstant = right.pullConstant();
+            
+            if (leftConstant && rightConstant && pure)
+            {
+                out[0] = function(*leftConstant, *rightConstant);
+                std::fill_n(out + 1, size - 1, out[0]);
+            } else if (leftConstant && rightConstant) {
+                for (std::size_t i = 0; i < size; ++i)
+                    out[i] = function(*leftConstant, *rightConstant);
+            } else if (rightConstant) {
+                const auto in = left.pullBlock(size);
+                for (std::size_t i = 0; i < size; ++i)
+                    out[i] = function(in[i], *rightConstant);
+            } else if (leftConstant) {
+                const auto in = right.pullBlock(size);
+                for (std::size_t i = 0; i < size; ++i)
+                    out[i] = function(*leftConstant, in[i]);
+            } else {
+                const auto lhs = left.pullBlock(size);
+                const auto rhs = right.pullBlock(size);
+                for (std::size_t i = 0; i < size; ++i)
+                    out[i] = function(lhs[i], rhs[i]);
+            }
+        }
+    
+    private:
+        //! The function combining the samples
+        F function;
+    };
+    
+    //! Combine the samples of two signals with a function
+    template <class Left, class Right, class F>
+    Zip<std::decay_t<F>, Left, Right> zip(Signal<Left>& left, Signal<Right>& right, F&& function)
+    {
+        if (left.getClock() != right.getClock())
+            throw std::invalid_argument("cannot zip two signals that do not use the same clock");
+        
+        return {left.getClock(), left, right, std::forward<F>(function)};
+    }
+    
+    //! Combine the samples of two signals with a function
+    template <class Left, class Right, class F>
+    Zip<std::decay_t<F>, Left, Right> zip(Signal<Left>& left, Signal<Right>&& right, F&& function)
+    {
+        if (left.getClock() != right.getClock())
+            throw std::invalid_argument("cannot zip two signals that do not use the same clock");
+        
+        return {left.getClock(), left, std::move(right), std::forward<F>(function)};
+    }
+    
+    //! Combine the samples of two signals with a function
+    template <class Left, class Right, class F>
+    Zip<std::decay_t<F>, Left, Right> zip(Signal<Left>&& left, Signal<Right>& right, F&& function)
+    {
+        if (left.getClock() != right.getClock())
+            throw std::invalid_argument("cannot zip two signals that do not use the same clock");
+        
+        return {left.getClock(), std::move(left), right, std::forward<F>(function)};
+    }
+    
+    //! Combine the samples of two signals with a function
+    template <class Left, class Right, class F>
+    Zip<std::decay_t<F>, Left, Right> zip(Signal<Left>&& left, Signal<Right>&& right, F&& function)
+    {
+        if (left.getClock() != right.getClock())
+            throw std::invalid_argument("cannot zip two signals that do not use the same clock");
+        
+        return {left.getClock(), std::move(left), std::move(right), std::forward<F>(function)};
+    }
+}
+
+#endif